@@ -0,0 +1,63 @@
+//
+//  Archetype.cpp
+//  TestComponentSystem
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "Archetype.hpp"
+#include "GameObject.hpp"
+
+using namespace Pocket;
+
+Archetype::Archetype(const Bitset& bitset) : bitset(bitset) {
+    columnIndicies.resize(bitset.Size(), -1);
+    for(int i=0; i<bitset.Size(); ++i) {
+        if (bitset[i]) {
+            columnIndicies[i] = (int)componentIds.size();
+            componentIds.push_back(i);
+        }
+    }
+    columns.resize(componentIds.size());
+}
+
+int Archetype::Add(GameObject* object) {
+    int row = (int)objects.size();
+    objects.push_back(object);
+    for(size_t i=0; i<componentIds.size(); ++i) {
+        columns[i].push_back(object->GetComponent(componentIds[i]));
+    }
+    return row;
+}
+
+GameObject* Archetype::Remove(int row) {
+    int last = (int)objects.size() - 1;
+    GameObject* moved = 0;
+    if (row!=last) {
+        moved = objects[last];
+        objects[row] = moved;
+        for(auto& column : columns) {
+            column[row] = column[last];
+        }
+    }
+    objects.pop_back();
+    for(auto& column : columns) {
+        column.pop_back();
+    }
+    return moved;
+}
+
+void Archetype::Resize(int componentTypesCount) {
+    if (bitset.Size()>=componentTypesCount) return;
+    bitset.Resize(componentTypesCount);
+    columnIndicies.resize(componentTypesCount, -1);
+}
+
+int Archetype::Count() const { return (int)objects.size(); }
+
+const Bitset& Archetype::GetBitset() const { return bitset; }
+
+const std::vector<ComponentId>& Archetype::ComponentIds() const { return componentIds; }
+
+GameObject* const* Archetype::Objects() const { return objects.data(); }
@@ -0,0 +1,49 @@
+//
+//  Archetype.hpp
+//  TestComponentSystem
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include <vector>
+#include "GameIDHelper.hpp"
+
+namespace Pocket {
+    class GameObject;
+
+    // All objects within a scene sharing the exact same set of enabled components.
+    // Each component type has a contiguous column of pointers to the components of the objects,
+    // so systems can iterate a whole archetype without per object lookups. The components themselves
+    // stay in their Container, since GetComponent pointers and shared components need stable addresses.
+    class Archetype {
+    public:
+        Archetype(const Bitset& bitset);
+
+        int Add(GameObject* object);
+        GameObject* Remove(int row);
+        void Resize(int componentTypesCount);
+
+        int Count() const;
+
+        const Bitset& GetBitset() const;
+        const std::vector<ComponentId>& ComponentIds() const;
+        GameObject* const* Objects() const;
+
+        template<typename T>
+        T* const* Column() const {
+            return (T* const*)columns[columnIndicies[GameIdHelper::GetComponentID<T>()]].data();
+        }
+
+    private:
+        Bitset bitset;
+        std::vector<ComponentId> componentIds;
+        std::vector<int> columnIndicies;
+
+        std::vector<GameObject*> objects;
+
+        using ComponentColumn = std::vector<void*>;
+        std::vector<ComponentColumn> columns;
+    };
+}
@@ -0,0 +1,25 @@
+//
+//  CommandBuffer.cpp
+//  TestComponentSystem
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "CommandBuffer.hpp"
+
+using namespace Pocket;
+
+void CommandBuffer::Add(Command::Kind kind, GameObject* object, ComponentId id, GameObject* other, bool enable) {
+    commands.push_back({ kind, enable, id, object, other });
+}
+
+void CommandBuffer::Append(const CommandBuffer& other) {
+    commands.insert(commands.end(), other.commands.begin(), other.commands.end());
+}
+
+int CommandBuffer::Count() const { return (int)commands.size(); }
+
+const Command& CommandBuffer::operator[](int index) const { return commands[index]; }
+
+void CommandBuffer::Clear() { commands.clear(); }
@@ -0,0 +1,52 @@
+//
+//  CommandBuffer.hpp
+//  TestComponentSystem
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include <vector>
+#include "GameIDHelper.hpp"
+
+namespace Pocket {
+    class GameObject;
+    
+    // Deferred structural change, replayed by GameWorld::UpdateActions.
+    struct Command {
+        enum class Kind : unsigned char {
+            ComponentCreated,
+            RemoveComponent,
+            EnableComponent,
+            ReplaceComponent,
+            AddReferenceComponent,
+            UpdateWorldEnabled,
+            RemoveObject,
+            RemoveRoot,
+            SortSystems,
+        };
+        Kind kind;
+        bool enable;
+        ComponentId id;
+        GameObject* object;
+        GameObject* other;
+    };
+    
+    // Plain records in one linear buffer, the storage is kept between frames
+    // so recording a command never allocates once the buffer has grown.
+    class CommandBuffer {
+    public:
+        void Add(Command::Kind kind, GameObject* object, ComponentId id = 0, GameObject* other = 0, bool enable = false);
+        
+        // Appends the commands of other after the commands of this buffer.
+        void Append(const CommandBuffer& other);
+        
+        int Count() const;
+        const Command& operator[](int index) const;
+        void Clear();
+        
+    private:
+        std::vector<Command> commands;
+    };
+}
@@ -11,6 +11,9 @@
 #include <vector>
 #include <assert.h>
 #include <functional>
+#include <memory>
+#include <new>
+#include <utility>
 
 namespace Pocket {
 
@@ -33,6 +36,31 @@ namespace Pocket {
     template<typename T>
     class Handle;
     
+    // Allocator used for the entries of a Container, types with private constructors
+    // and destructor can befriend ContainerAllocator<T> to be stored in a Container.
+    template<typename T>
+    struct ContainerAllocator {
+        using value_type = T;
+        
+        ContainerAllocator() { }
+        template<typename U>
+        ContainerAllocator(const ContainerAllocator<U>&) { }
+        
+        T* allocate(std::size_t n) { return static_cast<T*>(::operator new(n * sizeof(T))); }
+        void deallocate(T* p, std::size_t) { ::operator delete(p); }
+        
+        template<typename U, typename... Args>
+        void construct(U* p, Args&&... args) { ::new((void*)p) U(std::forward<Args>(args)...); }
+        
+        template<typename U>
+        void destroy(U* p) { p->~U(); }
+        
+        template<typename U>
+        bool operator==(const ContainerAllocator<U>&) const { return true; }
+        template<typename U>
+        bool operator!=(const ContainerAllocator<U>&) const { return false; }
+    };
+    
     template<typename T>
     using HandleCollection = std::vector<Handle<T>>;
     
@@ -48,7 +76,7 @@ namespace Pocket {
                 freeIndex = (int)references.size();
                 references.emplace_back(1);
                 versions.emplace_back(maxVersion);
-                entries.resize(freeIndex + 1);
+                entries.emplace_back();
                 owners.emplace_back(owner);
             } else {
                 freeIndex = freeIndicies.back();
@@ -68,7 +96,7 @@ namespace Pocket {
                 freeIndex = (int)references.size();
                 references.emplace_back(1);
                 versions.emplace_back(maxVersion);
-                entries.resize(freeIndex + 1, defaultObject);
+                entries.push_back(defaultObject);
                 owners.emplace_back(owner);
             } else {
                 freeIndex = freeIndicies.back();
@@ -160,7 +188,7 @@ namespace Pocket {
             return collection;
         }
     
-        using Entries = std::deque<T>;
+        using Entries = std::deque<T, ContainerAllocator<T>>;
         Entries entries;
         
         using References = std::vector<int>;
@@ -9,6 +9,7 @@
 #include "GameObject.hpp"
 #include "GameWorld.hpp"
 #include "GameObjectHandle.hpp"
+#include <algorithm>
 
 using namespace Pocket;
 
@@ -22,6 +23,8 @@ GameObject::GameObject(const GameObject& other) {
     activeComponents.Resize(other.activeComponents.Size());
     enabledComponents.Resize(other.activeComponents.Size());
     componentIndicies.resize(other.activeComponents.Size());
+    archetypeIndex = -1;
+    archetypeRow = -1;
     
     Parent = 0;
     
@@ -66,6 +69,8 @@ void GameObject::ParentChanged() {
 void GameObject::Reset() {
     Enabled.Changed.Clear();
     removed = false;
+    archetypeIndex = -1;
+    archetypeRow = -1;
     forceSetNextParent = true;
     Parent = 0;
     forceSetNextParent = false;
@@ -92,22 +97,19 @@ void* GameObject::GetComponent(ComponentId id) const {
 
 void GameObject::AddComponent(ComponentId id) {
     assert(id<activeComponents.Size());
+    std::unique_lock<std::recursive_mutex> lock = scene->world->LockStructure();
     if (removed) return;
     if (activeComponents[id]) return;
 
     componentIndicies[id] = scene->world->components[id].container->Create(index);
     activeComponents.Set(id, true);
-    scene->world->delayedActions.emplace_back([this, id]() {
-        if (scene->ComponentCreated) {
-            scene->ComponentCreated(this, id);
-        }
-        TrySetComponentEnabled(id, true);
-    });
+    scene->world->Commands().Add(Command::Kind::ComponentCreated, this, id);
 }
 
 void GameObject::AddComponent(ComponentId id, GameObject* referenceObject) {
     assert(id<activeComponents.Size());
     assert(scene->world == referenceObject->scene->world);
+    std::unique_lock<std::recursive_mutex> lock = scene->world->LockStructure();
     if (removed) return;
     if (activeComponents[id]) return;
     if (!referenceObject->activeComponents[id]) return;
@@ -115,54 +117,55 @@ void GameObject::AddComponent(ComponentId id, GameObject* referenceObject) {
     componentIndicies[id] = referenceObject->componentIndicies[id];
     scene->world->components[id].container->Reference(referenceObject->componentIndicies[id]);
     activeComponents.Set(id, true);
-    scene->world->delayedActions.emplace_back([this, id]() {
-        if (scene->ComponentCreated) {
-            scene->ComponentCreated(this, id);
-        }
-        TrySetComponentEnabled(id, true);
-    });
+    scene->world->Commands().Add(Command::Kind::ComponentCreated, this, id);
 }
 
 void GameObject::RemoveComponent(ComponentId id) {
     assert(id<activeComponents.Size());
+    std::unique_lock<std::recursive_mutex> lock = scene->world->LockStructure();
     if (removed) return;
     if (!activeComponents[id]) return;
-    scene->world->delayedActions.emplace_back([this, id]() {
-        if (!activeComponents[id]) {
-           return; // might have been removed by earlier remove action, eg if two consecutive RemoveComponent<> was called
-        }
-        if (scene->ComponentRemoved) {
-            scene->ComponentRemoved(this, id);
-        }
-        TrySetComponentEnabled(id, false);
-        scene->world->components[id].container->Delete(componentIndicies[id], index);
-        activeComponents.Set(id, false);
-    });
+    scene->world->Commands().Add(Command::Kind::RemoveComponent, this, id);
+}
+
+void GameObject::ApplyComponentCreated(ComponentId id) {
+    if (scene->ComponentCreated) {
+        scene->ComponentCreated(this, id);
+    }
+    TrySetComponentEnabled(id, true);
+}
+
+void GameObject::ApplyRemoveComponent(ComponentId id) {
+    if (!activeComponents[id]) {
+       return; // might have been removed by earlier remove action, eg if two consecutive RemoveComponent<> was called
+    }
+    if (scene->ComponentRemoved) {
+        scene->ComponentRemoved(this, id);
+    }
+    TrySetComponentEnabled(id, false);
+    scene->world->components[id].container->Delete(componentIndicies[id], index);
+    activeComponents.Set(id, false);
 }
 
 void GameObject::CloneComponent(ComponentId id, GameObject* object) {
     assert(id<activeComponents.Size());
+    std::unique_lock<std::recursive_mutex> lock = scene->world->LockStructure();
     if (removed) return;
     if (activeComponents[id]) return;
     if (!object->activeComponents[id]) return;
     componentIndicies[id] = scene->world->components[id].container->Clone(object->componentIndicies[id], index);
     activeComponents.Set(id, true);
-    scene->world->delayedActions.emplace_back([this, id]() {
-        if (scene->ComponentCreated) {
-            scene->ComponentCreated(this, id);
-        }
-        TrySetComponentEnabled(id, true);
-    });
+    scene->world->Commands().Add(Command::Kind::ComponentCreated, this, id);
 }
 
 void GameObject::ReplaceComponent(ComponentId id, GameObject *referenceObject) {
     if (removed) return;
-    scene->world->delayedActions.emplace_back([this, id, referenceObject]() {
-        RemoveComponent(id);
-        scene->world->delayedActions.emplace_back([this, id, referenceObject]() {
-            AddComponent(id, referenceObject);
-        });
-    });
+    scene->world->Commands().Add(Command::Kind::ReplaceComponent, this, id, referenceObject);
+}
+
+void GameObject::ApplyReplaceComponent(ComponentId id, GameObject* referenceObject) {
+    RemoveComponent(id);
+    scene->world->Commands().Add(Command::Kind::AddReferenceComponent, this, id, referenceObject);
 }
 
 GameObject* GameObject::GetComponentOwner(ComponentId componentId) const {
@@ -172,9 +175,7 @@ GameObject* GameObject::GetComponentOwner(ComponentId componentId) const {
 
 void GameObject::SetWorldEnableDirty() {
     WorldEnabled.MakeDirty();
-    scene->world->delayedActions.emplace_back([this](){
-        SetEnabled(WorldEnabled);
-    });
+    scene->world->Commands().Add(Command::Kind::UpdateWorldEnabled, this);
 }
 
 void GameObject::SetEnabled(bool enabled) {
@@ -186,9 +187,7 @@ void GameObject::SetEnabled(bool enabled) {
 }
 
 void GameObject::EnableComponent(ComponentId id, bool enable) {
-    scene->world->delayedActions.emplace_back([id, enable, this](){
-        TrySetComponentEnabled(id, enable);
-    });
+    scene->world->Commands().Add(Command::Kind::EnableComponent, this, id, 0, enable);
 }
 
 void GameObject::TryAddToSystem(int systemId) {
@@ -236,6 +235,9 @@ void GameObject::TrySetComponentEnabled(ComponentId id, bool enable) {
     
     if (enable) {
         enabledComponents.Set(id, true);
+        if (scene->world->archetypeStorage) {
+            scene->world->UpdateArchetype(this);
+        }
         for(auto systemId : componentInfo.systemsUsingComponent) {
             TryAddToSystem(systemId);
         }
@@ -244,38 +246,49 @@ void GameObject::TrySetComponentEnabled(ComponentId id, bool enable) {
             TryRemoveFromSystem(systemId);
         }
         enabledComponents.Set(id, false);
+        if (scene->world->archetypeStorage) {
+            scene->world->UpdateArchetype(this);
+        }
     }
 }
 
 void GameObject::Remove() {
+    std::unique_lock<std::recursive_mutex> lock = scene->world->LockStructure();
     if (removed) return;
-    int localIndex = index;
-    scene->world->delayedActions.emplace_back([this, localIndex]() {
-        forceSetNextParent = true;
-        if (IsRoot()) {
-            scene->world->RemoveRoot(this);
-        } else {
-            Parent = 0;
-        }
-        forceSetNextParent = false;
-        SetEnabled(false);
-        for(int i=0; i<activeComponents.Size(); ++i) {
-            if (activeComponents[i]) {
-                scene->world->components[i].container->Delete(componentIndicies[i], index);
-                activeComponents.Set(i, false);
-            }
-        }
-        scene->world->objects.Delete(index, 0);
-        if (scene->ObjectRemoved) {
-            scene->ObjectRemoved(this);
-        }
-    });
+    scene->world->Commands().Add(Command::Kind::RemoveObject, this);
     removed = true;
     for(auto child : children) {
         child->Remove();
     }
 }
 
+void GameObject::Detach() {
+    forceSetNextParent = true;
+    if (IsRoot()) {
+        scene->world->RemoveRoot(this);
+    } else {
+        Parent = 0;
+    }
+    forceSetNextParent = false;
+    SetEnabled(false);
+}
+
+void GameObject::DeleteComponents() {
+    for(int i=0; i<activeComponents.Size(); ++i) {
+        if (activeComponents[i]) {
+            scene->world->components[i].container->Delete(componentIndicies[i], index);
+            activeComponents.Set(i, false);
+        }
+    }
+}
+
+void GameObject::DeleteObject() {
+    scene->world->objects.Delete(index, 0);
+    if (scene->ObjectRemoved) {
+        scene->ObjectRemoved(this);
+    }
+}
+
 bool GameObject::IsRemoved() const {
     return removed;
 }
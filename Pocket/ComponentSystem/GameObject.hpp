@@ -35,9 +35,10 @@ namespace Pocket {
         friend class GameScene;
         friend class Handle<GameObject>;
         friend class Container<GameObject>;
-        friend class std::allocator<GameObject>;
+        friend struct ContainerAllocator<GameObject>;
         friend class ScriptWorld;
         friend class GameObjectHandle;
+        friend class GameSystemBase;
         
         using ComponentIndicies = std::vector<int>;
         
@@ -55,6 +56,11 @@ namespace Pocket {
         bool removed;
         int index;
         int rootId;
+        int archetypeIndex;
+        int archetypeRow;
+        
+        using SystemIndicies = std::vector<int>;
+        SystemIndicies systemIndicies;
         
     public:
         Property<bool> Enabled;
@@ -94,6 +100,12 @@ namespace Pocket {
         void SetEnabled(bool enabled);
         void TryAddToSystem(int systemId);
         void TryRemoveFromSystem(int systemId);
+        void ApplyComponentCreated(ComponentId id);
+        void ApplyRemoveComponent(ComponentId id);
+        void ApplyReplaceComponent(ComponentId id, GameObject* referenceObject);
+        void Detach();
+        void DeleteComponents();
+        void DeleteObject();
         void WriteJson(minijson::object_writer& writer, const SerializePredicate& predicate) const;
         void WriteJsonComponents(minijson::object_writer& writer, const SerializePredicate& predicate) const;
         void RemoveComponents(const SerializePredicate& predicate);
@@ -138,11 +150,7 @@ namespace Pocket {
         }
         
         template<typename T>
-        T* CloneComponent(GameObject* source) {
-            ComponentId componentId = GameIdHelper::GetComponentID<T>();
-            CloneComponent(componentId, source);
-            return static_cast<T*>(GetComponent(componentId));
-        }
+        T* CloneComponent(GameObject* source);
         
         template<typename T>
         T* ReplaceComponent(GameObject* source);
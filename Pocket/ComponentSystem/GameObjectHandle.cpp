@@ -7,6 +7,7 @@
 //
 
 #include "GameObjectHandle.hpp"
+#include <algorithm>
 
 using namespace Pocket;
 
@@ -12,7 +12,7 @@
 
 using namespace Pocket;
 
-GameScene::GameScene() : idCounter(0),
+GameScene::GameScene() : archetypesVersion(0), idCounter(0),
 	ObjectCreated(0), ObjectRemoved(0), ComponentCreated(0), ComponentRemoved(0) {
     updateEnabled = true;
     renderEnabled = true;
@@ -32,6 +32,9 @@ GameScene::~GameScene() {
 
 GameScene::GameScene(const GameScene& other) {
     systemsIndexed.clear();
+    archetypes.clear();
+    archetypeIndicies.clear();
+    archetypesVersion = 0;
     updateEnabled = true;
     renderEnabled = true;
     timeScale = 1.0f;
@@ -86,7 +89,7 @@ IGameSystem* GameScene::CreateSystem(int systemId) {
         system->SetIndex(systemId);
         system->Initialize();
         //system->Order.Changed.Bind([this] () {
-            world->delayedActions.emplace_back([this] () { world->SortActiveSystems(); });
+            world->Commands().Add(Command::Kind::SortSystems, 0);
         //});
         
         IterateObjects([systemId](GameObject* object) {
@@ -9,7 +9,10 @@
 #pragma once
 #include <vector>
 #include <functional>
+#include <deque>
+#include <unordered_map>
 #include "GameObject.hpp"
+#include "Archetype.hpp"
 #include "Property.hpp"
 
 namespace Pocket {
@@ -21,14 +24,20 @@ namespace Pocket {
     private:
         friend class GameWorld;
         friend class GameObject;
-        friend class std::allocator<GameScene>;
+        friend struct ContainerAllocator<GameScene>;
         friend class ScriptWorld;
         friend class GameObjectHandle;
+        friend class GameSystemBase;
         
         GameWorld* world;
         GameObject* root;
         int index;
         std::vector<IGameSystem*> systemsIndexed;
+        std::deque<Archetype> archetypes;
+        // Indices into archetypes by Bitset::Hash of their components.
+        std::unordered_multimap<std::size_t, int> archetypeIndicies;
+        // Incremented whenever archetypes are cleared, see GameSystemBase::GetArchetypes.
+        int archetypesVersion;
         int idCounter;
         std::string guid;
         Property<float> timeScale;
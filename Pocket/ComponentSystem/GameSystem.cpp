@@ -11,7 +11,7 @@
 
 using namespace Pocket;
 
-GameSystemBase::GameSystemBase() : root(0) {}
+GameSystemBase::GameSystemBase() : root(0), archetypesScanned(0), archetypesVersion(0), index(0) { Order = 0; }
 GameSystemBase::~GameSystemBase() {}
 
 void GameSystemBase::Initialize() {}
@@ -25,23 +25,71 @@ const ObjectCollection& GameSystemBase::Objects() const { return objects; }
 int GameSystemBase::AddObject(Pocket::GameObject *object) {
     int count = (int)objects.size();
     objects.push_back(object);
+    metaData.push_back(0);
+    for(auto id : componentIds) {
+        componentPointers.push_back(object->GetComponent(id));
+    }
+    if (index>=(int)object->systemIndicies.size()) {
+        object->systemIndicies.resize(index + 1, -1);
+    }
+    object->systemIndicies[index] = count;
     return count;
 }
 
+// Swap and pop, the last object takes the place of the removed one.
 void GameSystemBase::RemoveObject(Pocket::GameObject *object) {
-    objects.erase(std::find(objects.begin(), objects.end(), object));
-    auto it = metaData.find(object);
-    if (it!=metaData.end()) {
-        metaData.erase(it);
+    int row = object->systemIndicies[index];
+    int last = (int)objects.size() - 1;
+    if (row!=last) {
+        GameObject* moved = objects[last];
+        objects[row] = moved;
+        metaData[row] = metaData[last];
+        moved->systemIndicies[index] = row;
+        size_t stride = componentIds.size();
+        std::copy(componentPointers.begin() + last * stride,
+                  componentPointers.begin() + (last + 1) * stride,
+                  componentPointers.begin() + row * stride);
     }
+    objects.pop_back();
+    metaData.pop_back();
+    componentPointers.resize(componentPointers.size() - componentIds.size());
+    object->systemIndicies[index] = -1;
 }
 
 int GameSystemBase::ObjectCount() { return (int)objects.size(); }
 
+int GameSystemBase::IndexOf(Pocket::GameObject *object) const {
+    if (index>=(int)object->systemIndicies.size()) return -1;
+    int row = object->systemIndicies[index];
+    if (row<0 || row>=(int)objects.size() || objects[row]!=object) return -1;
+    return row;
+}
+
 void GameSystemBase::SetMetaData(Pocket::GameObject *object, void *data) {
-    metaData[object] = data;
+    int row = IndexOf(object);
+    if (row<0) return;
+    metaData[row] = data;
 }
 
 void* GameSystemBase::GetMetaData(Pocket::GameObject *object) {
-    return metaData[object];
+    int row = IndexOf(object);
+    return row<0 ? 0 : metaData[row];
+}
+
+// Archetypes are only appended until the scene clears them all, so only new ones need to be checked.
+const GameSystemBase::ArchetypeCollection& GameSystemBase::GetArchetypes() {
+    GameScene* scene = root->scene;
+    if (archetypesVersion!=scene->archetypesVersion) {
+        archetypes.clear();
+        archetypesScanned = 0;
+        archetypesVersion = scene->archetypesVersion;
+    }
+    const Bitset& systemBitset = scene->world->systems[index].bitset;
+    for(; archetypesScanned<scene->archetypes.size(); ++archetypesScanned) {
+        const Archetype& archetype = scene->archetypes[archetypesScanned];
+        if (systemBitset.Contains(archetype.GetBitset())) {
+            archetypes.push_back(&archetype);
+        }
+    }
+    return archetypes;
 }
\ No newline at end of file
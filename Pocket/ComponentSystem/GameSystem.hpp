@@ -8,7 +8,7 @@
 
 #pragma once
 #include <vector>
-#include <map>
+#include <utility>
 #include "GameWorld.hpp"
 
 namespace Pocket {
@@ -32,6 +32,15 @@ namespace Pocket {
         void SetMetaData(GameObject* object, void* data);
         void* GetMetaData(GameObject* object);
         
+        using ArchetypeCollection = std::vector<const Archetype*>;
+        const ArchetypeCollection& GetArchetypes();
+        
+        using ComponentIds = std::vector<ComponentId>;
+        ComponentIds componentIds;
+        
+        using ComponentPointers = std::vector<void*>;
+        ComponentPointers componentPointers;
+        
         int GetOrder() override { return Order(); }
         void SetOrder(int order) override { Order = order; }
         int GetIndex() override { return index; }
@@ -41,9 +50,17 @@ namespace Pocket {
         int ObjectCount() override;
         
     private:
-        using MetaData = std::map<GameObject*, void*>;
+        int IndexOf(GameObject* object) const;
+        
+        // Parallel to objects, indexed by the row stored in GameObject::systemIndicies.
+        using MetaData = std::vector<void*>;
         MetaData metaData;
         
+        // Matching archetypes of the scene, the first archetypesScanned have been checked.
+        ArchetypeCollection archetypes;
+        size_t archetypesScanned;
+        int archetypesVersion;
+        
         int index;
     
         ObjectCollection objects;
@@ -53,13 +70,113 @@ namespace Pocket {
         const ObjectCollection& Objects() const;
     };
     
+    // Component access declarations, eg GameSystem<Read<Transform>, Write<Mesh>>.
+    // A system declaring access for all of its components may be updated concurrently
+    // with other systems of the same Order that it does not conflict with.
+    // Such systems must only touch the components they declare during Update.
+    // Writes can still notify listeners shared between systems, like the octree of moved objects,
+    // so listeners must be thread safe while SystemScheduler::CurrentTask() is set.
+    // Adding components and removing objects is recorded per system and applied in order by the next update.
+    template<typename T>
+    struct Read {};
+    
+    template<typename T>
+    struct Write {};
+    
+    template<typename T>
+    struct ComponentAccess {
+        using Type = T;
+        using Pointer = T*;
+        static const bool Declared = false;
+        static const bool IsWrite = true;
+    };
+    
+    template<typename T>
+    struct ComponentAccess<Read<T>> {
+        using Type = T;
+        using Pointer = const T*;
+        static const bool Declared = true;
+        static const bool IsWrite = false;
+    };
+    
+    template<typename T>
+    struct ComponentAccess<Write<T>> {
+        using Type = T;
+        using Pointer = T*;
+        static const bool Declared = true;
+        static const bool IsWrite = true;
+    };
+    
     template<typename ...T>
     class GameSystem : public GameSystemBase {
+    protected:
+        GameSystem() {
+            componentIds = { GameIdHelper::GetComponentID<typename ComponentAccess<T>::Type>()... };
+        }
+    
+        // Invokes func(T&...) for every object in the system, in the same order as Objects().
+        // Component pointers are resolved once in AddObject, so no lookups happen while iterating.
+        // Components declared as Read<T> are passed as const T&.
+        template<typename Func>
+        void ForEach(Func&& func) {
+            IterateComponents(func, std::index_sequence_for<T...>());
+        }
+        
+        // Same as ForEach, but func also receives the object: func(GameObject*, T&...)
+        template<typename Func>
+        void ForEachObject(Func&& func) {
+            IterateObjectComponents(func, std::index_sequence_for<T...>());
+        }
+        
+        // Invokes func(int count, GameObject* const* objects, T* const* components...) once per chunk of
+        // objects sharing the same components. With archetype storage enabled on the world each call
+        // covers a whole archetype, otherwise it falls back to one call per object.
+        template<typename Func>
+        void ForEachChunk(Func&& func) {
+            if (root->World()->ArchetypeStorage()) {
+                for(const Archetype* archetype : GetArchetypes()) {
+                    if (archetype->Count() == 0) continue;
+                    func(archetype->Count(), archetype->Objects(), archetype->template Column<typename ComponentAccess<T>::Type>()...);
+                }
+            } else {
+                IterateChunks(func, std::index_sequence_for<T...>());
+            }
+        }
     private:
+        template<typename Func, std::size_t ...I>
+        void IterateComponents(Func& func, std::index_sequence<I...>) {
+            void* const* pointers = componentPointers.data();
+            const int count = (int)Objects().size();
+            for(int i=0; i<count; ++i, pointers += sizeof...(T)) {
+                func(*static_cast<typename ComponentAccess<T>::Pointer>(pointers[I])...);
+            }
+        }
+        
+        template<typename Func, std::size_t ...I>
+        void IterateObjectComponents(Func& func, std::index_sequence<I...>) {
+            void* const* pointers = componentPointers.data();
+            const ObjectCollection& objects = Objects();
+            const int count = (int)objects.size();
+            for(int i=0; i<count; ++i, pointers += sizeof...(T)) {
+                func(objects[i], *static_cast<typename ComponentAccess<T>::Pointer>(pointers[I])...);
+            }
+        }
+        
+        template<typename Func, std::size_t ...I>
+        void IterateChunks(Func& func, std::index_sequence<I...>) {
+            void* const* pointers = componentPointers.data();
+            const ObjectCollection& objects = Objects();
+            const int count = (int)objects.size();
+            for(int i=0; i<count; ++i, pointers += sizeof...(T)) {
+                func(1, &objects[i], (typename ComponentAccess<T>::Type* const*)&pointers[I]...);
+            }
+        }
+    
         template<typename Last>
         static void ExtractComponents(GameWorld& world, std::vector<ComponentId>& components) {
-            world.AddComponentType<Last>();
-            ComponentId id = GameIdHelper::GetComponentID<Last>();
+            using Component = typename ComponentAccess<Last>::Type;
+            world.AddComponentType<Component>();
+            ComponentId id = GameIdHelper::GetComponentID<Component>();
             components.push_back(id);
         }
         
@@ -73,6 +190,21 @@ namespace Pocket {
             ExtractComponents<T...>(world, components);
         }
         
+        static bool ExtractComponentAccess(std::vector<ComponentId>& reads, std::vector<ComponentId>& writes) {
+            const bool declared[] = { ComponentAccess<T>::Declared... };
+            const bool isWrite[] = { ComponentAccess<T>::IsWrite... };
+            const ComponentId ids[] = { GameIdHelper::GetComponentID<typename ComponentAccess<T>::Type>()... };
+            for(size_t i=0; i<sizeof...(T); ++i) {
+                if (!declared[i]) return false;
+                if (isWrite[i]) {
+                    writes.push_back(ids[i]);
+                } else {
+                    reads.push_back(ids[i]);
+                }
+            }
+            return true;
+        }
+        
         friend class GameWorld;
     };
     
@@ -80,6 +212,9 @@ namespace Pocket {
     private:
         static void ExtractAllComponents(GameWorld& world, std::vector<int>& components) {
         }
+        static bool ExtractComponentAccess(std::vector<ComponentId>&, std::vector<ComponentId>&) {
+            return false;
+        }
         friend class GameWorld;
     };
 }
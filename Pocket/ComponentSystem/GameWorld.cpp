@@ -9,10 +9,11 @@
 #include "GameWorld.hpp"
 #include "StringHelper.hpp"
 #include "GameObjectHandle.hpp"
+#include <algorithm>
 
 using namespace Pocket;
 
-GameWorld::GameWorld() : componentTypesCount(0) {
+GameWorld::GameWorld() : componentTypesCount(0), archetypeStorage(false) {
     scenes.defaultObject.world = this;
     objects.count = 0;
 }
@@ -30,6 +31,11 @@ void GameWorld::AddComponentType(ComponentId componentId, const ComponentTypeFun
                 o.enabledComponents.Resize(componentTypesCount);
                 o.componentIndicies.resize(componentTypesCount);
             }
+            scenes.Iterate([this] (GameScene* scene) {
+                for(auto& archetype : scene->archetypes) {
+                    archetype.Resize(componentTypesCount);
+                }
+            });
         }
     }
     
@@ -99,8 +105,8 @@ void GameWorld::RemoveSystemType(SystemId systemId) {
         IGameSystem* system = scene->systemsIndexed[systemId];
         if (!system) return;
         if (system->ObjectCount()>0) {
-            objects.Iterate([&systemInfo, system] (GameObject* object) {
-                if (systemInfo.bitset.Contains(object->enabledComponents)) {
+            objects.Iterate([&systemInfo, system, scene] (GameObject* object) {
+                if (object->scene == scene && systemInfo.bitset.Contains(object->enabledComponents)) {
                     system->ObjectRemoved(object);
                     system->RemoveObject(object);
                 }
@@ -120,13 +126,66 @@ void GameWorld::RemoveSystemType(SystemId systemId) {
     systemInfo.createFunction = 0;
     systemInfo.deleteFunction = 0;
     systemInfo.bitset.Reset();
-}
-
-void GameWorld::DoActions(Actions &actions) {
-    for(int i=0; i<actions.size();++i) {
-        actions[i]();
+    systemInfo.concurrent = false;
+    systemInfo.readComponents.clear();
+    systemInfo.writeComponents.clear();
+}
+
+// Commands are replayed in the order they were recorded, commands recorded while replaying
+// are appended and run in the same pass. Object removals are collected from the whole buffer and
+// applied in phases once the other commands ran, first all objects are detached and leave their systems,
+// then components and objects are freed. Sorting of active systems is done once at the end.
+void GameWorld::DoCommands() {
+    bool sortSystems = false;
+    for(int i=0; i<commands.Count(); ++i) {
+        Command command = commands[i];
+        switch (command.kind) {
+            case Command::Kind::ComponentCreated:
+                command.object->ApplyComponentCreated(command.id);
+                break;
+            case Command::Kind::RemoveComponent:
+                command.object->ApplyRemoveComponent(command.id);
+                break;
+            case Command::Kind::EnableComponent:
+                command.object->TrySetComponentEnabled(command.id, command.enable);
+                break;
+            case Command::Kind::ReplaceComponent:
+                command.object->ApplyReplaceComponent(command.id, command.other);
+                break;
+            case Command::Kind::AddReferenceComponent:
+                command.object->AddComponent(command.id, command.other);
+                break;
+            case Command::Kind::UpdateWorldEnabled:
+                command.object->SetEnabled(command.object->WorldEnabled);
+                break;
+            case Command::Kind::RemoveObject:
+                removedObjects.push_back(command.object);
+                break;
+            case Command::Kind::RemoveRoot:
+                RemoveRootNow(command.object);
+                break;
+            case Command::Kind::SortSystems:
+                sortSystems = true;
+                break;
+        }
+        // detaching can record more commands, the loop picks them up
+        if (i + 1 == commands.Count() && !removedObjects.empty()) {
+            for(auto object : removedObjects) {
+                object->Detach();
+            }
+            for(auto object : removedObjects) {
+                object->DeleteComponents();
+            }
+            for(auto object : removedObjects) {
+                object->DeleteObject();
+            }
+            removedObjects.clear();
+        }
+    }
+    commands.Clear();
+    if (sortSystems) {
+        SortActiveSystems();
     }
-    actions.clear();
 }
 
 const ObjectCollection& GameWorld::Roots() { return roots; }
@@ -158,35 +217,72 @@ GameObject* GameWorld::CreateRootFromJson(std::istream &jsonStream,
 }
 
 void GameWorld::RemoveRoot(Pocket::GameObject *root) {
+    Commands().Add(Command::Kind::RemoveRoot, root);
+}
+
+void GameWorld::RemoveRootNow(GameObject* root) {
     GameScene* scene = root->scene;
-    delayedActions.emplace_back([this, scene, root] {
-        roots.erase(std::find(roots.begin(), roots.end(), root));
-        scene->DestroySystems();
-        scenes.Delete(scene->index, 0);
-        activeScenes.erase(std::find(activeScenes.begin(), activeScenes.end(), scene));
-        RootRemoved(root);
-    });
+    roots.erase(std::find(roots.begin(), roots.end(), root));
+    scene->DestroySystems();
+    scenes.Delete(scene->index, 0);
+    activeScenes.erase(std::find(activeScenes.begin(), activeScenes.end(), scene));
+    RootRemoved(root);
 }
 
 void GameWorld::Update(float dt) {
     UpdateActions();
-    for(auto& s : activeSystems) {
-        if (!s.scene->updateEnabled()) continue;
-        s.system->Update(s.scene->timeScale() * dt);
-    }
+    UpdateSystems(dt, 0);
 }
 
 void GameWorld::UpdateRoot(float dt, GameObject* root) {
     UpdateActions();
+    UpdateSystems(dt, root->scene);
+}
+
+void GameWorld::UpdateSystems(float dt, GameScene* onlyScene) {
+    scheduledTasks.clear();
+    int scheduledOrder = 0;
     for(auto& s : activeSystems) {
-        if (s.scene==root->scene) {
-            s.system->Update(s.scene->timeScale() * dt);
+        if (onlyScene) {
+            if (s.scene!=onlyScene) continue;
+        } else if (!s.scene->updateEnabled()) {
+            continue;
         }
+        float systemDt = s.scene->timeScale() * dt;
+        SystemInfo& systemInfo = systems[s.system->GetIndex()];
+        if (!systemInfo.concurrent) {
+            scheduler.Run(scheduledTasks, commands);
+            scheduledTasks.clear();
+            s.system->Update(systemDt);
+            continue;
+        }
+        int order = s.system->GetOrder();
+        if (!scheduledTasks.empty() && order!=scheduledOrder) {
+            scheduler.Run(scheduledTasks, commands);
+            scheduledTasks.clear();
+        }
+        scheduledOrder = order;
+        scheduledTasks.push_back({ s.system, systemDt, &systemInfo.readComponents, &systemInfo.writeComponents });
+    }
+    scheduler.Run(scheduledTasks, commands);
+    scheduledTasks.clear();
+}
+
+CommandBuffer& GameWorld::Commands() {
+    CommandBuffer* taskCommands = SystemScheduler::CurrentCommands();
+    return taskCommands ? *taskCommands : commands;
+}
+
+std::unique_lock<std::recursive_mutex> GameWorld::LockStructure() {
+    std::unique_lock<std::recursive_mutex> lock(structureMutex, std::defer_lock);
+    if (SystemScheduler::CurrentTask()) {
+        lock.lock();
     }
+    return lock;
 }
 
 void GameWorld::UpdateActions() {
-    DoActions(delayedActions);
+    DoCommands();
 }
 
 void GameWorld::DebugSystems() {
@@ -211,11 +307,75 @@ void GameWorld::Clear() {
     for(auto root : roots) {
         root->Remove();
     }
-    DoActions(delayedActions);
+    DoCommands();
 }
 
 int GameWorld::ObjectCount() { return objects.count; }
 
+void GameWorld::SetArchetypeStorage(bool enabled) {
+    if (archetypeStorage == enabled) return;
+    archetypeStorage = enabled;
+    RebuildArchetypes();
+}
+
+bool GameWorld::ArchetypeStorage() const { return archetypeStorage; }
+
+void GameWorld::SetJobSystem(JobSystem* jobSystem) { scheduler.SetJobSystem(jobSystem); }
+
+JobSystem* GameWorld::GetJobSystem() const { return scheduler.GetJobSystem(); }
+
+void GameWorld::UpdateArchetype(GameObject* object) {
+    GameScene* scene = object->scene;
+    if (object->archetypeIndex>=0) {
+        Archetype& current = scene->archetypes[object->archetypeIndex];
+        if (current.GetBitset() == object->enabledComponents) return;
+        GameObject* moved = current.Remove(object->archetypeRow);
+        if (moved) {
+            moved->archetypeRow = object->archetypeRow;
+        }
+        object->archetypeIndex = -1;
+        object->archetypeRow = -1;
+    }
+    
+    bool hasComponents = false;
+    for(int i=0; i<object->enabledComponents.Size() && !hasComponents; ++i) {
+        hasComponents = object->enabledComponents[i];
+    }
+    if (!hasComponents) return;
+    
+    int archetypeIndex = -1;
+    const std::size_t hash = object->enabledComponents.Hash();
+    auto range = scene->archetypeIndicies.equal_range(hash);
+    for(auto it = range.first; it!=range.second; ++it) {
+        if (scene->archetypes[it->second].GetBitset() == object->enabledComponents) {
+            archetypeIndex = it->second;
+            break;
+        }
+    }
+    if (archetypeIndex<0) {
+        archetypeIndex = (int)scene->archetypes.size();
+        scene->archetypes.emplace_back(object->enabledComponents);
+        scene->archetypeIndicies.emplace(hash, archetypeIndex);
+    }
+    object->archetypeIndex = archetypeIndex;
+    object->archetypeRow = scene->archetypes[archetypeIndex].Add(object);
+}
+
+void GameWorld::RebuildArchetypes() {
+    scenes.Iterate([] (GameScene* scene) {
+        scene->archetypes.clear();
+        scene->archetypeIndicies.clear();
+        ++scene->archetypesVersion;
+    });
+    objects.Iterate([this] (GameObject* object) {
+        object->archetypeIndex = -1;
+        object->archetypeRow = -1;
+        if (archetypeStorage) {
+            UpdateArchetype(object);
+        }
+    });
+}
+
 InputManager& GameWorld::Input() { return input; }
 
 GameObject* GameWorld::CreateEmptyObject(GameObject *parent, GameScene* scene, bool assignId) {
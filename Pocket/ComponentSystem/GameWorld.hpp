@@ -10,14 +10,17 @@
 #include <vector>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include "MetaLibrary.hpp"
 #include "Container.hpp"
 #include "TypeInfo.hpp"
-#include "GameIdHelper.hpp"
+#include "GameIDHelper.hpp"
 #include "GameObject.hpp"
 #include "IGameSystem.hpp"
 #include "GameScene.hpp"
 #include "InputManager.hpp"
+#include "SystemScheduler.hpp"
+#include "CommandBuffer.hpp"
 
 namespace Pocket {
 
@@ -47,8 +50,11 @@ namespace Pocket {
         Components components;
         
         struct SystemInfo {
-            SystemInfo() : createFunction(0), deleteFunction(0) {}
+            SystemInfo() : concurrent(false), createFunction(0), deleteFunction(0) {}
             Bitset bitset;
+            bool concurrent;
+            std::vector<ComponentId> readComponents;
+            std::vector<ComponentId> writeComponents;
             std::function<IGameSystem*(GameObject*)> createFunction;
             std::function<void(IGameSystem*)> deleteFunction;
             std::string name;
@@ -59,6 +65,7 @@ namespace Pocket {
         
         Container<GameObject> objects;
         int componentTypesCount;
+        bool archetypeStorage;
         
         Container<GameScene> scenes;
         std::vector<GameScene*> activeScenes;
@@ -75,8 +82,14 @@ namespace Pocket {
         
         std::vector<ActiveSystem> activeSystems;
         
-        using Actions = std::deque<std::function<void()>>;
-        Actions delayedActions;
+        SystemScheduler scheduler;
+        SystemScheduler::Tasks scheduledTasks;
+        
+        CommandBuffer commands;
+        // Serializes component creation and removal of objects by systems updating concurrently.
+        std::recursive_mutex structureMutex;
+        // Objects removed during one DoCommands, kept to reuse the storage
+        std::vector<GameObject*> removedObjects;
         
         InputManager input;
         
@@ -94,8 +107,13 @@ namespace Pocket {
         void AddSystemType(SystemId systemId, const SystemTypeFunction& function);
         void RemoveSystemType(SystemId systemId);
 
-        void DoActions(Actions &actions);
+        void DoCommands();
+        // Commands of the system running as a job on the calling thread, otherwise the world's commands.
+        CommandBuffer& Commands();
+        // Locks structureMutex while a system runs as a job on the calling thread.
+        std::unique_lock<std::recursive_mutex> LockStructure();
         void RemoveRoot(GameObject* root);
+        void RemoveRootNow(GameObject* root);
         GameObject* CreateEmptyObject(GameObject* parent, GameScene* scene, bool assignId);
         GameObject* CreateObjectFromJson(GameObject* parent, std::istream& jsonStream, const std::function<void(GameObject*)>& objectCreated);
         GameObject* LoadObject(GameObject::AddReferenceComponentList& addReferenceComponents, GameObject* parent, minijson::istream_context &context, const std::function<void(GameObject*)>& objectCreated);
@@ -107,6 +125,7 @@ namespace Pocket {
         void AddSystemType() {
             AddSystemType(GameIdHelper::GetSystemID<T>(), [this] (SystemInfo& systemInfo, std::vector<ComponentId>& components) {
                 T::ExtractAllComponents(*this, components);
+                systemInfo.concurrent = T::ExtractComponentAccess(systemInfo.readComponents, systemInfo.writeComponents);
                 systemInfo.createFunction = [] (GameObject* root) {
                     T* system = new T();
                     GameObject** systemRoot = ((GameObject**)&system->root);
@@ -121,9 +140,13 @@ namespace Pocket {
             });
         }
         
+        void UpdateArchetype(GameObject* object);
+        void RebuildArchetypes();
+        
         void AddActiveSystem(IGameSystem* system, GameScene* scene);
         void RemoveActiveSystem(IGameSystem* system);
         void SortActiveSystems();
+        void UpdateSystems(float dt, GameScene* onlyScene);
         
        
         
@@ -172,6 +195,12 @@ namespace Pocket {
         
         int ObjectCount();
         
+        void SetArchetypeStorage(bool enabled);
+        bool ArchetypeStorage() const;
+        
+        void SetJobSystem(JobSystem* jobSystem);
+        JobSystem* GetJobSystem() const;
+        
         InputManager& Input();
         
         bool TryGetComponentIndex(const std::string& componentName, int& index);
@@ -221,6 +250,7 @@ namespace Pocket {
         friend class GameObject;
         friend class ScriptWorld;
         friend class GameObjectHandle;
+        friend class GameSystemBase;
     };
     
     template<typename T>
@@ -236,6 +266,7 @@ namespace Pocket {
     
     template<typename T>
     T* GameObject::AddComponent() {
+        std::unique_lock<std::recursive_mutex> lock = scene->world->LockStructure();
         scene->world->AddComponentType<T>();
         const ComponentId componentId = GameIdHelper::GetComponentID<T>();
         AddComponent(componentId);
@@ -244,12 +275,21 @@ namespace Pocket {
 
     template<typename T>
     T* GameObject::AddComponent(GameObject* source) {
+        std::unique_lock<std::recursive_mutex> lock = scene->world->LockStructure();
         scene->world->AddComponentType<T>();
         const ComponentId componentId = GameIdHelper::GetComponentID<T>();
         AddComponent(componentId, source);
         return static_cast<T*>(GetComponent(componentId));
     }
     
+    template<typename T>
+    T* GameObject::CloneComponent(GameObject* source) {
+        std::unique_lock<std::recursive_mutex> lock = scene->world->LockStructure();
+        const ComponentId componentId = GameIdHelper::GetComponentID<T>();
+        CloneComponent(componentId, source);
+        return static_cast<T*>(GetComponent(componentId));
+    }
+    
     template<typename T>
     GameObject* GameObject::GetComponentOwner() {
         const ComponentId componentId = GameIdHelper::GetComponentID<T>();
@@ -0,0 +1,113 @@
+//
+//  SystemScheduler.cpp
+//  TestComponentSystem
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "SystemScheduler.hpp"
+#include "IGameSystem.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+
+using namespace Pocket;
+
+namespace {
+    thread_local const SystemScheduler::Task* currentTask = 0;
+    thread_local CommandBuffer* currentCommands = 0;
+}
+
+static bool Intersects(const std::vector<ComponentId>& a, const std::vector<ComponentId>& b) {
+    for(auto id : a) {
+        if (std::find(b.begin(), b.end(), id)!=b.end()) return true;
+    }
+    return false;
+}
+
+SystemScheduler::SystemScheduler() : jobSystem(&JobSystem::Default()), tasks(0), predecessorsCapacity(0) { }
+
+void SystemScheduler::SetJobSystem(JobSystem* jobSystem) {
+    this->jobSystem = jobSystem;
+}
+
+JobSystem* SystemScheduler::GetJobSystem() const { return jobSystem; }
+
+bool SystemScheduler::Conflicts(const Task& a, const Task& b) {
+    return Intersects(*a.writes, *b.writes) ||
+           Intersects(*a.writes, *b.reads) ||
+           Intersects(*a.reads, *b.writes);
+}
+
+const SystemScheduler::Task* SystemScheduler::CurrentTask() { return currentTask; }
+
+CommandBuffer* SystemScheduler::CurrentCommands() { return currentCommands; }
+
+void SystemScheduler::Run(const Tasks& tasks, CommandBuffer& commands) {
+    if (tasks.empty()) return;
+    if (tasks.size() == 1 || !jobSystem || jobSystem->ThreadCount() == 0) {
+        for(auto& task : tasks) {
+            task.system->Update(task.dt);
+        }
+        return;
+    }
+
+    int count = (int)tasks.size();
+    this->tasks = &tasks;
+    if (predecessorsCapacity<count) {
+        predecessors.reset(new std::atomic<int>[count]);
+        predecessorsCapacity = count;
+    }
+    if ((int)successors.size()<count) {
+        successors.resize(count);
+    }
+    if ((int)taskCommands.size()<count) {
+        taskCommands.resize(count);
+    }
+    for(int i=0; i<count; ++i) {
+        successors[i].clear();
+        int incoming = 0;
+        for(int j=0; j<i; ++j) {
+            if (Conflicts(tasks[j], tasks[i])) {
+                successors[j].push_back(i);
+                incoming++;
+            }
+        }
+        predecessors[i] = incoming;
+    }
+
+    JobHandle handle;
+    for(int i=0; i<count; ++i) {
+        if (predecessors[i] == 0) {
+            jobSystem->Schedule([this, i, handle] () {
+                Execute(i, handle);
+            }, handle);
+        }
+    }
+    jobSystem->Wait(handle);
+    this->tasks = 0;
+    
+    for(int i=0; i<count; ++i) {
+        commands.Append(taskCommands[i]);
+        taskCommands[i].Clear();
+    }
+}
+
+void SystemScheduler::Execute(int index, const JobHandle& handle) {
+    const Task& task = (*tasks)[index];
+    // a thread waiting inside a system's Update can pick up another task
+    const Task* previousTask = currentTask;
+    CommandBuffer* previousCommands = currentCommands;
+    currentTask = &task;
+    currentCommands = &taskCommands[index];
+    task.system->Update(task.dt);
+    currentTask = previousTask;
+    currentCommands = previousCommands;
+    for(auto successor : successors[index]) {
+        if (--predecessors[successor] == 0) {
+            jobSystem->Schedule([this, successor, handle] () {
+                Execute(successor, handle);
+            }, handle);
+        }
+    }
+}
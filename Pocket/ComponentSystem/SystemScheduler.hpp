@@ -0,0 +1,64 @@
+//
+//  SystemScheduler.hpp
+//  TestComponentSystem
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include <vector>
+#include <memory>
+#include <atomic>
+#include "GameIDHelper.hpp"
+#include "CommandBuffer.hpp"
+
+namespace Pocket {
+    struct IGameSystem;
+    class JobSystem;
+    class JobHandle;
+
+    // Runs a group of systems with declared component access concurrently.
+    // Two systems conflict when one writes a component the other reads or writes,
+    // conflicting systems keep the order they were given in.
+    // Systems are executed as jobs on the given JobSystem, without one it runs serially.
+    // Commands recorded by a system while it runs as a job go to a buffer of its own,
+    // the buffers are appended to the world's commands in task order once all systems are done.
+    class SystemScheduler {
+    public:
+        struct Task {
+            IGameSystem* system;
+            float dt;
+            const std::vector<ComponentId>* reads;
+            const std::vector<ComponentId>* writes;
+        };
+        using Tasks = std::vector<Task>;
+
+        SystemScheduler();
+
+        void SetJobSystem(JobSystem* jobSystem);
+        JobSystem* GetJobSystem() const;
+
+        void Run(const Tasks& tasks, CommandBuffer& commands);
+
+        static bool Conflicts(const Task& a, const Task& b);
+        
+        // Task running as a job on the calling thread, or null.
+        // Shared state changed by side effects of component writes must be locked while it is set.
+        static const Task* CurrentTask();
+        
+        // Buffer the running task records commands into, or null when no task runs as a job on the calling thread.
+        static CommandBuffer* CurrentCommands();
+
+    private:
+        void Execute(int index, const JobHandle& handle);
+
+        JobSystem* jobSystem;
+
+        const Tasks* tasks;
+        std::unique_ptr<std::atomic<int>[]> predecessors;
+        int predecessorsCapacity;
+        std::vector<std::vector<int>> successors;
+        std::vector<CommandBuffer> taskCommands;
+    };
+}
@@ -4,15 +4,19 @@
 #include "Timer.hpp"
 #include "../Debugging/Assert.hpp"
 #include "OpenGL.hpp"
+#include "JobSystem.hpp"
 using namespace Pocket;
 
 Engine::Engine() {
 	window = 0;
+    rootState = 0;
     timer = new Timer();
     staticContext = &context;
 }
 
 Engine::~Engine() {
+    // states free their GL resources, so they go while the window's context is alive
+    delete rootState;
 	if (window) {
 		window->Destroy();
 		delete window;
@@ -63,6 +67,7 @@ void Engine::Loop(bool* exit) {
 bool Engine::Update(float dt) {
     context.InputDevice().StartFrame(rootState);
 	bool running = window->Update();
+    JobSystem::Default().Update();
     rootState->DoUpdate(dt);
 	context.InputDevice().EndFrame();
     return running;
@@ -42,8 +42,6 @@ namespace Pocket {
         IGameState* rootState;
         
         static EngineContext* staticContext;
-        
-        friend class Thread;
 	};
 }
 
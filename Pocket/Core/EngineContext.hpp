@@ -21,7 +21,7 @@ namespace Pocket {
         Property<Vector2> ScreenSize;
         Rect Viewport() const;
         AppMenu& Menu();
-        InputDevice& InputDevice();
+        Pocket::InputDevice& InputDevice();
         float ScreenScalingFactor;
     private:
         AppMenu* menu;
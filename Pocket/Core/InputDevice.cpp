@@ -98,6 +98,7 @@ void InputDevice::UpdateInputManager(Pocket::InputManager *inputManager) {
             }
         }
     }
+    inputManager->TouchesUpdated();
     
     for (Buttons::iterator it = currentButtons.begin(); it!=currentButtons.end(); ++it) {
         bool isDown = previousButtons.find(it->first)==previousButtons.end();
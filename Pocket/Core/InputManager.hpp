@@ -39,6 +39,8 @@ namespace Pocket {
 
 		Event<TouchEvent> TouchDown;
 		Event<TouchEvent> TouchUp;
+		// Fired after the TouchDown and TouchUp events of an update, so the touches can be handled together.
+		Event<> TouchesUpdated;
 
 		const Vector2& GetTouchPosition(int index);
         
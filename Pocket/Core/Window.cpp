@@ -16,6 +16,10 @@
 
 #include "WindowAndroid.hpp"
 
+#elif __linux__
+
+#include "WindowLinux.hpp"
+
 #else
 
 #include "WindowWin.hpp"
@@ -51,6 +55,8 @@ Window* Window::CreatePlatformWindow() {
     return new WindowWeb();
 #elif ANDROID
     return new WindowAndroid();
+#elif __linux__
+    return new WindowLinux();
 #else
     return new WindowWin();
 #endif
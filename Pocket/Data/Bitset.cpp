@@ -7,36 +7,121 @@
 //
 
 #include "Bitset.hpp"
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using namespace Pocket;
 
+Bitset::Bitset() : size(0), wordCount(0), capacity(InlineWords), words(inlineWords) {
+    std::memset(inlineWords, 0, sizeof(inlineWords));
+}
+
+Bitset::Bitset(const Bitset& other) : Bitset() {
+    *this = other;
+}
+
+Bitset& Bitset::operator=(const Bitset &other) {
+    if (this == &other) return *this;
+    Reserve(other.wordCount);
+    size = other.size;
+    wordCount = other.wordCount;
+    std::memcpy(words, other.words, wordCount * sizeof(Word));
+    std::memset(words + wordCount, 0, (capacity - wordCount) * sizeof(Word));
+    return *this;
+}
+
+Bitset::~Bitset() {
+    if (words!=inlineWords) {
+        delete[] words;
+    }
+}
+
+void Bitset::Reserve(int count) {
+    if (count<=capacity) return;
+    Word* newWords = new Word[count];
+    std::memcpy(newWords, words, wordCount * sizeof(Word));
+    std::memset(newWords + wordCount, 0, (count - wordCount) * sizeof(Word));
+    if (words!=inlineWords) {
+        delete[] words;
+    }
+    words = newWords;
+    capacity = count;
+}
+
 bool Bitset::operator[](int index) const {
-    return bits[index];
+    return (words[index / BitsPerWord] >> (index % BitsPerWord)) & 1;
 }
 
 void Bitset::Set(int index, bool value) {
-    bits[index] = value;
+    Word mask = Word(1) << (index % BitsPerWord);
+    Word& word = words[index / BitsPerWord];
+    word = value ? (word | mask) : (word & ~mask);
 }
 
 void Bitset::Resize(int index) {
-    bits.resize(index, false);
+    int newWordCount = (index + BitsPerWord - 1) / BitsPerWord;
+    Reserve(newWordCount);
+    if (index<size) {
+        for(int i=newWordCount; i<wordCount; ++i) {
+            words[i] = 0;
+        }
+        int tail = index % BitsPerWord;
+        if (tail) {
+            words[newWordCount - 1] &= (Word(1) << tail) - 1;
+        }
+    }
+    size = index;
+    wordCount = newWordCount;
 }
 
+// True when every bit set in this is also set in bitset.
+// Bits beyond the end of bitset count as cleared.
 bool Bitset::Contains(const Pocket::Bitset &bitset) const {
-    for(int i=0; i<bits.size();++i) {
-        if (bits[i] && !bitset.bits[i]) {
+    const Word* a = words;
+    const Word* b = bitset.words;
+    int shared = wordCount < bitset.wordCount ? wordCount : bitset.wordCount;
+    int i = 0;
+#if defined(__SSE2__)
+    for(; i + 2<=shared; i+=2) {
+        __m128i missing = _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(b + i)),
+                                           _mm_loadu_si128((const __m128i*)(a + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) != 0xFFFF) {
             return false;
         }
     }
+#endif
+    for(; i<shared; ++i) {
+        if (a[i] & ~b[i]) return false;
+    }
+    for(; i<wordCount; ++i) {
+        if (a[i]) return false;
+    }
     return true;
 }
 
 void Bitset::Reset() {
-    for(int i=0; i<bits.size();++i){
-        bits[i]=false;
-    }
+    std::memset(words, 0, wordCount * sizeof(Word));
 }
 
 int Bitset::Size() const {
-    return (int)bits.size();
-}
\ No newline at end of file
+    return size;
+}
+
+bool Bitset::operator==(const Pocket::Bitset &other) const {
+    if (size!=other.size) return false;
+    return std::memcmp(words, other.words, wordCount * sizeof(Word)) == 0;
+}
+
+std::size_t Bitset::Hash() const {
+    int count = wordCount;
+    while (count>0 && !words[count - 1]) {
+        --count;
+    }
+    Word hash = 14695981039346656037ULL;
+    for(int i=0; i<count; ++i) {
+        hash = (hash ^ words[i]) * 1099511628211ULL;
+    }
+    return (std::size_t)(hash ^ (hash >> 32));
+}
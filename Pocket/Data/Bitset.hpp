@@ -7,19 +7,40 @@
 //
 
 #pragma once
-#include <vector>
+#include <cstdint>
+#include <cstddef>
 
 namespace Pocket {
+  // Word based bitset, the first InlineBits are stored inside the object itself
+  // so component masks of typical worlds never touch the heap.
   class Bitset {
   public:
+        Bitset();
+        Bitset(const Bitset& other);
+        Bitset& operator = (const Bitset& other);
+        ~Bitset();
+    
         bool operator[] (int index) const;
         void Set(int index, bool value);
         bool Contains(const Bitset& bitset) const;
         void Resize(int index);
         void Reset();
         int Size() const;
+        bool operator == (const Bitset& other) const;
+        // Trailing zero words are ignored, so the hash is the same before and after Resize.
+        std::size_t Hash() const;
+    
+        using Word = std::uint64_t;
+        static const int BitsPerWord = 64;
+        static const int InlineWords = 4;
+        static const int InlineBits = InlineWords * BitsPerWord;
   private:
-      using Bits = std::vector<bool>;
-      Bits bits;
+      void Reserve(int wordCount);
+    
+      int size;
+      int wordCount;
+      int capacity;
+      Word* words;
+      Word inlineWords[InlineWords];
   };
-}
\ No newline at end of file
+}
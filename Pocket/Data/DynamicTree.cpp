@@ -0,0 +1,328 @@
+#include "DynamicTree.hpp"
+#include <algorithm>
+#include <cmath>
+using namespace Pocket;
+
+namespace {
+    inline Vector3 Min(const Vector3& a, const Vector3& b) {
+        return Vector3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+    }
+
+    inline Vector3 Max(const Vector3& a, const Vector3& b) {
+        return Vector3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+    }
+
+    // Half the surface area, flat boxes in 2d scenes still get the area of their rectangle.
+    inline float Area(const Vector3& min, const Vector3& max) {
+        const Vector3 size = max - min;
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+
+    inline float UnionArea(const Vector3& aMin, const Vector3& aMax, const Vector3& bMin, const Vector3& bMax) {
+        return Area(Min(aMin, bMin), Max(aMax, bMax));
+    }
+
+    inline bool Contains(const Vector3& min, const Vector3& max, const Vector3& otherMin, const Vector3& otherMax) {
+        return  min.x<=otherMin.x && min.y<=otherMin.y && min.z<=otherMin.z &&
+                max.x>=otherMax.x && max.y>=otherMax.y && max.z>=otherMax.z;
+    }
+}
+
+DynamicTree::DynamicTree() : root(-1), freeList(-1), size(0), margin(0.1f) {
+}
+
+DynamicTree::~DynamicTree() {
+}
+
+void DynamicTree::SetMargin(float margin) {
+    this->margin = std::max(margin, 0.0f);
+}
+
+int DynamicTree::Allocate() {
+    int index;
+    if (freeList>=0) {
+        index = freeList;
+        freeList = tree[index].parent;
+    } else {
+        index = (int)tree.size();
+        tree.resize(index + 1);
+    }
+    TreeNode& node = tree[index];
+    node.data = 0;
+    node.node = 0;
+    node.parent = -1;
+    node.child1 = -1;
+    node.child2 = -1;
+    node.height = 0;
+    return index;
+}
+
+void DynamicTree::Free(int index) {
+    TreeNode& node = tree[index];
+    node.parent = freeList;
+    node.height = -1;
+    freeList = index;
+}
+
+void DynamicTree::Fatten(const BoundingBox& box, const Vector3& displacement, float margin, Vector3& min, Vector3& max) const {
+    min = box.center - box.extends * (0.5f + margin);
+    max = box.center + box.extends * (0.5f + margin);
+    // objects moving at the same speed stay inside for a few moves
+    const Vector3 ahead = displacement * 4.0f;
+    if (ahead.x<0) min.x += ahead.x; else max.x += ahead.x;
+    if (ahead.y<0) min.y += ahead.y; else max.y += ahead.y;
+    if (ahead.z<0) min.z += ahead.z; else max.z += ahead.z;
+}
+
+bool DynamicTree::Insert(Node& node) {
+    if (node.IsInserted()) {
+        Move(node);
+        return true;
+    }
+    int leaf = Allocate();
+    TreeNode& treeNode = tree[leaf];
+    treeNode.box = node.box;
+    Fatten(node.box, Vector3(0, 0, 0), margin, treeNode.min, treeNode.max);
+    treeNode.data = node.data;
+    treeNode.node = &node;
+    node.index = leaf;
+    size++;
+    InsertLeaf(leaf);
+    return true;
+}
+
+void DynamicTree::Remove(Node& node) {
+    if (!node.IsInserted()) return;
+    RemoveLeaf(node.index);
+    Free(node.index);
+    node.index = -1;
+    size--;
+}
+
+// Objects staying inside their fat box only update their box. Others are reinserted,
+// and so are objects whose fat box is much larger than a new one would be, like when they stop moving.
+void DynamicTree::Move(Node& node) {
+    if (!node.IsInserted()) {
+        Insert(node);
+        return;
+    }
+    int leaf = node.index;
+    const Vector3 displacement = node.box.center - tree[leaf].box.center;
+    tree[leaf].box = node.box;
+    tree[leaf].data = node.data;
+    Vector3 min, max;
+    Fatten(node.box, displacement, margin, min, max);
+    const TreeNode& treeNode = tree[leaf];
+    if (Contains(treeNode.min, treeNode.max, node.box.center - node.box.extends * 0.5f, node.box.center + node.box.extends * 0.5f)) {
+        const Vector3 size = treeNode.max - treeNode.min;
+        const Vector3 limit = (max - min) * (1.0f + margin * 4.0f);
+        if (size.x<=limit.x && size.y<=limit.y && size.z<=limit.z) return;
+    }
+    RemoveLeaf(leaf);
+    tree[leaf].min = min;
+    tree[leaf].max = max;
+    InsertLeaf(leaf);
+}
+
+// Walks down to the sibling where the new parent adds the least area to the tree.
+void DynamicTree::InsertLeaf(int leaf) {
+    if (root<0) {
+        root = leaf;
+        tree[root].parent = -1;
+        return;
+    }
+
+    const Vector3 leafMin = tree[leaf].min;
+    const Vector3 leafMax = tree[leaf].max;
+    int index = root;
+    while (!tree[index].IsLeaf()) {
+        const TreeNode& node = tree[index];
+        const float area = Area(node.min, node.max);
+        const float combinedArea = UnionArea(node.min, node.max, leafMin, leafMax);
+
+        // cost of a new parent for this node and the leaf
+        const float cost = 2.0f * combinedArea;
+        // minimum cost of pushing the leaf further down
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCost[2];
+        const int children[2] = { node.child1, node.child2 };
+        for(int i=0; i<2; ++i) {
+            const TreeNode& child = tree[children[i]];
+            const float unionArea = UnionArea(child.min, child.max, leafMin, leafMax);
+            childCost[i] = (child.IsLeaf() ? unionArea : unionArea - Area(child.min, child.max)) + inheritanceCost;
+        }
+
+        if (cost<childCost[0] && cost<childCost[1]) break;
+        index = childCost[0]<childCost[1] ? children[0] : children[1];
+    }
+
+    const int sibling = index;
+    const int oldParent = tree[sibling].parent;
+    const int newParent = Allocate();
+    TreeNode& parent = tree[newParent];
+    parent.parent = oldParent;
+    parent.min = Min(leafMin, tree[sibling].min);
+    parent.max = Max(leafMax, tree[sibling].max);
+    parent.height = tree[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+
+    if (oldParent>=0) {
+        if (tree[oldParent].child1 == sibling) {
+            tree[oldParent].child1 = newParent;
+        } else {
+            tree[oldParent].child2 = newParent;
+        }
+    } else {
+        root = newParent;
+    }
+    tree[sibling].parent = newParent;
+    tree[leaf].parent = newParent;
+
+    Refit(newParent);
+}
+
+void DynamicTree::RemoveLeaf(int leaf) {
+    if (leaf == root) {
+        root = -1;
+        return;
+    }
+    const int parent = tree[leaf].parent;
+    const int grandParent = tree[parent].parent;
+    const int sibling = tree[parent].child1 == leaf ? tree[parent].child2 : tree[parent].child1;
+
+    if (grandParent>=0) {
+        if (tree[grandParent].child1 == parent) {
+            tree[grandParent].child1 = sibling;
+        } else {
+            tree[grandParent].child2 = sibling;
+        }
+        tree[sibling].parent = grandParent;
+        Free(parent);
+        Refit(grandParent);
+    } else {
+        root = sibling;
+        tree[sibling].parent = -1;
+        Free(parent);
+    }
+    tree[leaf].parent = -1;
+}
+
+void DynamicTree::Refit(int index) {
+    while (index>=0) {
+        index = Balance(index);
+        TreeNode& node = tree[index];
+        const TreeNode& child1 = tree[node.child1];
+        const TreeNode& child2 = tree[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.min = Min(child1.min, child2.min);
+        node.max = Max(child1.max, child2.max);
+        index = node.parent;
+    }
+}
+
+// Rotates the higher child up when the heights of the children of a differ by more than one.
+// Returns the node now at the position of a.
+int DynamicTree::Balance(int a) {
+    TreeNode& A = tree[a];
+    if (A.IsLeaf() || A.height<2) return a;
+
+    const int b = A.child1;
+    const int c = A.child2;
+    TreeNode& B = tree[b];
+    TreeNode& C = tree[c];
+    const int balance = C.height - B.height;
+
+    if (balance>1) {
+        // rotate c up
+        const int f = C.child1;
+        const int g = C.child2;
+        TreeNode& F = tree[f];
+        TreeNode& G = tree[g];
+
+        C.child1 = a;
+        C.parent = A.parent;
+        A.parent = c;
+
+        if (C.parent>=0) {
+            if (tree[C.parent].child1 == a) {
+                tree[C.parent].child1 = c;
+            } else {
+                tree[C.parent].child2 = c;
+            }
+        } else {
+            root = c;
+        }
+
+        if (F.height>G.height) {
+            C.child2 = f;
+            A.child2 = g;
+            G.parent = a;
+            A.min = Min(B.min, G.min);
+            A.max = Max(B.max, G.max);
+            C.min = Min(A.min, F.min);
+            C.max = Max(A.max, F.max);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        } else {
+            C.child2 = g;
+            A.child2 = f;
+            F.parent = a;
+            A.min = Min(B.min, F.min);
+            A.max = Max(B.max, F.max);
+            C.min = Min(A.min, G.min);
+            C.max = Max(A.max, G.max);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return c;
+    }
+
+    if (balance<-1) {
+        // rotate b up
+        const int d = B.child1;
+        const int e = B.child2;
+        TreeNode& D = tree[d];
+        TreeNode& E = tree[e];
+
+        B.child1 = a;
+        B.parent = A.parent;
+        A.parent = b;
+
+        if (B.parent>=0) {
+            if (tree[B.parent].child1 == a) {
+                tree[B.parent].child1 = b;
+            } else {
+                tree[B.parent].child2 = b;
+            }
+        } else {
+            root = b;
+        }
+
+        if (D.height>E.height) {
+            B.child2 = d;
+            A.child1 = e;
+            E.parent = a;
+            A.min = Min(C.min, E.min);
+            A.max = Max(C.max, E.max);
+            B.min = Min(A.min, D.min);
+            B.max = Max(A.max, D.max);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        } else {
+            B.child2 = e;
+            A.child1 = d;
+            D.parent = a;
+            A.min = Min(C.min, D.min);
+            A.max = Max(C.max, D.max);
+            B.min = Min(A.min, E.min);
+            B.max = Max(A.max, E.max);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return b;
+    }
+
+    return a;
+}
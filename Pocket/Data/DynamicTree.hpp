@@ -0,0 +1,190 @@
+//
+//  DynamicTree.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "BoundingBox.hpp"
+#include "BoundingFrustum.hpp"
+#include "OcclusionBuffer.hpp"
+#include "Ray.hpp"
+#include "SpatialNode.hpp"
+#include <vector>
+
+namespace Pocket {
+    // Bounding volume hierarchy over fattened boxes of the objects. Leaves are inserted where they
+    // add the least surface area, and the tree is kept balanced with rotations.
+    // Needs no world bounds, and objects moving within their fat box do not change the tree.
+	class DynamicTree
+	{
+	public:
+        // The index of a node is its leaf in the tree.
+		typedef SpatialNode Node;
+
+		DynamicTree();
+		~DynamicTree();
+
+		bool Insert(Node& node);
+		void Remove(Node& node);
+        // Call after changing the box of an inserted node.
+		void Move(Node& node);
+
+        // The tree has no bounds, kept so it can be used in place of an Octree.
+        void SetBoundingBox(const BoundingBox&) { }
+
+        // Fat boxes grow by margin times the size of the object on each side, and further in the direction
+        // it moved since it was last reinserted. 0.1 by default.
+        void SetMargin(float margin);
+
+        size_t Size() const { return size; }
+        int Height() const { return root<0 ? 0 : tree[root].height; }
+
+        // lastPlanes is not used by the tree, kept so it can be used in place of an Octree.
+        // Nodes and objects hidden in the optional occlusion buffer are skipped.
+        template<typename T>
+        void Get(const BoundingFrustum& frustum, std::vector<T>& list, std::vector<unsigned char>* lastPlanes = 0, const OcclusionBuffer* occlusion = 0) const {
+            if (root<0) return;
+            if (occlusion && occlusion->IsEmpty()) occlusion = 0;
+            int stack[MaxStack];
+            int count = 0;
+            stack[count++] = root;
+            while (count>0) {
+                const int index = stack[--count];
+                const TreeNode& node = tree[index];
+                if (node.IsLeaf()) {
+                    if (frustum.Intersect(node.box) == BoundingFrustum::OUTSIDE) continue;
+                    if (occlusion && occlusion->IsOccluded(node.box)) continue;
+                    list.push_back((T)node.data);
+                    continue;
+                }
+                const BoundingBox fat = node.Fat();
+                BoundingFrustum::Intersection test = frustum.Intersect(fat);
+                if (test == BoundingFrustum::OUTSIDE) continue;
+                if (occlusion && occlusion->IsOccluded(fat)) continue;
+                if (test == BoundingFrustum::INSIDE && !occlusion) {
+                    GetAll<T>(index, list);
+                    continue;
+                }
+                stack[count++] = node.child1;
+                stack[count++] = node.child2;
+            }
+        }
+
+        template<typename T>
+        void Get(const Ray& ray, std::vector<T>& list) const {
+            if (root<0) return;
+            Get<T>(root, ray, list);
+        }
+
+        // Walks the tree once for up to Ray::MaxBatch rays, lists holds one list per ray.
+        template<typename T>
+        void Get(const Ray* rays, int count, std::vector<T>* lists) const {
+            if (root<0 || count<=0) return;
+            if (count>Ray::MaxBatch) count = Ray::MaxBatch;
+            struct Entry {
+                int index;
+                unsigned rays;
+            };
+            Entry stack[MaxStack];
+            int stackSize = 0;
+            stack[stackSize++] = { root, count == Ray::MaxBatch ? ~0u : (1u << count) - 1 };
+            while (stackSize>0) {
+                const Entry entry = stack[--stackSize];
+                // a ray left on its own walks on without the masks
+                if (!(entry.rays & (entry.rays - 1))) {
+                    int r = 0;
+                    while (!(entry.rays & (1u << r))) ++r;
+                    Get<T>(entry.index, rays[r], lists[r]);
+                    continue;
+                }
+                const TreeNode& node = tree[entry.index];
+                const bool leaf = node.IsLeaf();
+                const BoundingBox box = leaf ? node.box : node.Fat();
+                unsigned mask = 0;
+                int r = 0;
+                for (unsigned m = entry.rays; m; m >>= 1, ++r) {
+                    if ((m & 1) && rays[r].Intersect(box)) mask |= 1u << r;
+                }
+                if (!mask) continue;
+                if (leaf) {
+                    r = 0;
+                    for (unsigned m = mask; m; m >>= 1, ++r) {
+                        if (m & 1) lists[r].push_back((T)node.data);
+                    }
+                    continue;
+                }
+                stack[stackSize++] = { node.child1, mask };
+                stack[stackSize++] = { node.child2, mask };
+            }
+        }
+
+	private:
+
+        // Balancing keeps the height within 1.44 log2 of the object count.
+        static const int MaxStack = 128;
+
+        struct TreeNode {
+            // Fat box of a leaf, or the union of the children.
+            Vector3 min;
+            Vector3 max;
+            // Box of the object, leaves only.
+            BoundingBox box;
+            void* data;
+            Node* node;
+            // Next free node, when unused.
+            int parent;
+            int child1;
+            int child2;
+            // Leaves are 0, unused nodes -1.
+            int height;
+
+            bool IsLeaf() const { return child1<0; }
+            BoundingBox Fat() const { return BoundingBox((min + max) * 0.5f, max - min); }
+        };
+
+        template<typename T>
+        void Get(int index, const Ray& ray, std::vector<T>& list) const {
+            int stack[MaxStack];
+            int count = 0;
+            stack[count++] = index;
+            while (count>0) {
+                const TreeNode& node = tree[stack[--count]];
+                if (node.IsLeaf()) {
+                    if (ray.Intersect(node.box)) list.push_back((T)node.data);
+                    continue;
+                }
+                if (!ray.Intersect(node.Fat())) continue;
+                stack[count++] = node.child1;
+                stack[count++] = node.child2;
+            }
+        }
+
+        template<typename T>
+        void GetAll(int index, std::vector<T>& list) const {
+            const TreeNode& node = tree[index];
+            if (node.IsLeaf()) {
+                list.push_back((T)node.data);
+                return;
+            }
+            GetAll<T>(node.child1, list);
+            GetAll<T>(node.child2, list);
+        }
+
+        int Allocate();
+        void Free(int index);
+        void Fatten(const BoundingBox& box, const Vector3& displacement, float margin, Vector3& min, Vector3& max) const;
+        void InsertLeaf(int leaf);
+        void RemoveLeaf(int leaf);
+        void Refit(int index);
+        int Balance(int index);
+
+        std::vector<TreeNode> tree;
+        int root;
+        int freeList;
+        size_t size;
+        float margin;
+	};
+}
@@ -9,164 +9,388 @@
 #pragma once
 #include <vector>
 #include <functional>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <type_traits>
 
 namespace Pocket {
+
+// Returned from Event::Bind, can be used to unbind in constant time.
+struct EventToken {
+    EventToken() : id(0), index(-1) {}
+    EventToken(unsigned id, int index) : id(id), index(index) {}
+    unsigned id;
+    int index;
+};
+
+// Delegates are stored by value, the first InlineDelegates within the event itself.
+// Member bindings and small lambdas are stored inline in the delegate, larger lambdas are heap allocated.
+// Delegates bound while the event is invoked are not called until the next invocation,
+// delegates unbound while invoked are skipped and released once the invocation completes.
 template<typename... T>
 class Event {
 private:
-    
-    template<typename...Args>
-    struct IDelegate {
-        int type;
-        virtual ~IDelegate() {}
-        virtual void Invoke(Args... values) = 0;
+    static const int InlineDelegates = 1;
+    static const int StorageSize = 4 * sizeof(void*);
+
+    struct Delegate;
+    enum class Operation { Move, Destroy };
+    using Invoker = void(*)(Delegate& delegate, T... values);
+    using Manager = void(*)(Delegate* target, Delegate* source, Operation operation);
+
+    struct Delegate {
+        Invoker invoke;
+        Manager manage;
+        unsigned id;
+        alignas(void*) unsigned char storage[StorageSize];
     };
-    using Delegate = IDelegate<T...>;
-    using Delegates = std::vector<Delegate*>;
-    Delegates delegates;
-    int defaultDelegatesCount;
-    
+
+    struct PendingDelegate {
+        Delegate delegate;
+        PendingDelegate* next;
+    };
+
+    template<typename F>
+    struct Stored {
+        static const bool IsInline = sizeof(F) <= StorageSize &&
+                                     alignof(F) <= alignof(void*) &&
+                                     std::is_nothrow_move_constructible<F>::value;
+        using Inline = std::integral_constant<bool, IsInline>;
+
+        static F* Get(Delegate& delegate, std::true_type) { return (F*)delegate.storage; }
+        static F* Get(Delegate& delegate, std::false_type) { return *(F**)delegate.storage; }
+        static F* Get(Delegate& delegate) { return Get(delegate, Inline()); }
+
+        template<typename Arg>
+        static void Create(Delegate& delegate, Arg&& arg, std::true_type) {
+            new (delegate.storage) F(std::forward<Arg>(arg));
+            delegate.manage = std::is_trivially_copyable<F>::value ? nullptr : &Manage;
+        }
+
+        template<typename Arg>
+        static void Create(Delegate& delegate, Arg&& arg, std::false_type) {
+            *(F**)delegate.storage = new F(std::forward<Arg>(arg));
+            delegate.manage = &Manage;
+        }
+
+        template<typename Arg>
+        static void Create(Delegate& delegate, Arg&& arg) {
+            delegate.invoke = &Invoke;
+            Create(delegate, std::forward<Arg>(arg), Inline());
+        }
+
+        static void Invoke(Delegate& delegate, T... values) {
+            (*Get(delegate))(std::forward<T>(values)...);
+        }
+
+        static void Destroy(Delegate& delegate, std::true_type) { Get(delegate)->~F(); }
+        static void Destroy(Delegate& delegate, std::false_type) { delete Get(delegate); }
+
+        static void Move(Delegate& target, Delegate& source, std::true_type) {
+            new (target.storage) F(std::move(*Get(source)));
+            Get(source)->~F();
+        }
+        static void Move(Delegate& target, Delegate& source, std::false_type) {
+            *(F**)target.storage = *(F**)source.storage;
+        }
+
+        static void Manage(Delegate* target, Delegate* source, Operation operation) {
+            if (operation == Operation::Destroy) {
+                Destroy(*source, Inline());
+            } else {
+                Move(*target, *source, Inline());
+            }
+        }
+    };
+
     template<typename Obj>
-    struct IDelegateMember : public IDelegate<T...> {
+    struct Member {
         Obj* object;
         void (Obj::*method)(T...);
-        
-        void Invoke(T... values) override {
+
+        void operator()(T... values) {
             (object->*method)(std::forward<T>(values)...);
         }
     };
-    
+
     template<typename Obj, typename Context>
-    struct IDelegateMemberContext : public IDelegate<T...> {
+    struct MemberContext {
         Obj* object;
-        Context context;
         void (Obj::*method)(T..., Context);
-        
-        void Invoke(T... values) override {
+        Context context;
+
+        void operator()(T... values) {
             (object->*method)(std::forward<T>(values)..., context);
         }
     };
-    
-    struct IDelegateLambda : public IDelegate<T...> {
-        std::function<void(T...)> function;
-        void Invoke(T... values) override {
-            function(std::forward<T>(values)...);
+
+    Delegate inlineDelegates[InlineDelegates];
+    Delegate* delegates;
+    int count;
+    int capacity;
+    int defaultDelegatesCount;
+    int removedCount;
+    int invoking;
+    unsigned nextId;
+    PendingDelegate* pending;
+
+    static void Relocate(Delegate& target, Delegate& source) {
+        target.invoke = source.invoke;
+        target.manage = source.manage;
+        target.id = source.id;
+        if (source.manage) {
+            source.manage(&target, &source, Operation::Move);
+        } else {
+            std::memcpy(target.storage, source.storage, StorageSize);
         }
-    };
-    
-    static int objectIDCounter;
-    
-    template<typename O>
-    int GetObjectID() {
-        static int id = objectIDCounter++;
-        return id;
-    }
-    
-public:
-    
-    Event() : defaultDelegatesCount(0) {}
-    Event(const Event<T...>& other) {
-        ClearNonDefaults();
+        source.invoke = nullptr;
+        source.manage = nullptr;
+        source.id = 0;
     }
-    Event(Event<T...>& other) {
-        ClearNonDefaults();
+
+    static void Destroy(Delegate& delegate) {
+        if (delegate.manage) {
+            delegate.manage(nullptr, &delegate, Operation::Destroy);
+        }
+        delegate.invoke = nullptr;
+        delegate.manage = nullptr;
+        delegate.id = 0;
+    }
+
+    void Reserve(int size) {
+        if (size<=capacity) return;
+        int newCapacity = capacity * 2 > size ? capacity * 2 : size;
+        Delegate* newDelegates = static_cast<Delegate*>(::operator new(sizeof(Delegate) * newCapacity));
+        for(int i=0; i<count; ++i) {
+            Relocate(newDelegates[i], delegates[i]);
+        }
+        if (delegates!=inlineDelegates) {
+            ::operator delete(delegates);
+        }
+        delegates = newDelegates;
+        capacity = newCapacity;
+    }
+
+    template<typename F, typename Arg>
+    EventToken Add(Arg&& arg) {
+        unsigned id = ++nextId;
+        if (id == 0) id = ++nextId;
+        if (invoking>0 && count == capacity) {
+            PendingDelegate* node = new PendingDelegate();
+            Stored<F>::Create(node->delegate, std::forward<Arg>(arg));
+            node->delegate.id = id;
+            node->next = 0;
+            PendingDelegate** last = &pending;
+            while (*last) last = &(*last)->next;
+            *last = node;
+            return EventToken(id, -1);
+        }
+        if (invoking == 0) {
+            Compact();
+        }
+        Reserve(count + 1);
+        Delegate& delegate = delegates[count];
+        Stored<F>::Create(delegate, std::forward<Arg>(arg));
+        delegate.id = id;
+        return EventToken(id, count++);
+    }
+
+    void Remove(int index) {
+        if (delegates[index].id == 0) return;
+        delegates[index].id = 0;
+        if (invoking == 0) {
+            Destroy(delegates[index]);
+        }
+        removedCount++;
+    }
+
+    void Compact() {
+        if (removedCount>0) {
+            int live = 0;
+            int defaults = 0;
+            for(int i=0; i<count; ++i) {
+                if (delegates[i].id == 0) {
+                    Destroy(delegates[i]);
+                    continue;
+                }
+                if (i<defaultDelegatesCount) {
+                    defaults++;
+                }
+                if (live!=i) {
+                    Relocate(delegates[live], delegates[i]);
+                }
+                live++;
+            }
+            count = live;
+            defaultDelegatesCount = defaults;
+            removedCount = 0;
+        }
+        while (pending) {
+            PendingDelegate* node = pending;
+            pending = node->next;
+            Reserve(count + 1);
+            Relocate(delegates[count++], node->delegate);
+            delete node;
+        }
     }
+
+    void ClearFrom(int index) {
+        for(int i=index; i<count; ++i) {
+            Remove(i);
+        }
+        while (pending) {
+            PendingDelegate* node = pending;
+            pending = node->next;
+            Destroy(node->delegate);
+            delete node;
+        }
+        if (invoking == 0) {
+            Compact();
+        }
+    }
+
+    void Reset() {
+        delegates = inlineDelegates;
+        count = 0;
+        capacity = InlineDelegates;
+        defaultDelegatesCount = 0;
+        removedCount = 0;
+        invoking = 0;
+        nextId = 0;
+        pending = 0;
+    }
+
+public:
+
+    Event() { Reset(); }
+    Event(const Event<T...>& other) { Reset(); }
+    Event(Event<T...>& other) { Reset(); }
     void operator=(Event<T...>& other) {
         ClearNonDefaults();
     }
-    
+
     Event(Event&& other) {
-        delegates = other.delegates;
+        Reset();
+        other.Compact();
+        Reserve(other.count);
+        for(int i=0; i<other.count; ++i) {
+            Relocate(delegates[i], other.delegates[i]);
+        }
+        count = other.count;
         defaultDelegatesCount = other.defaultDelegatesCount;
-        other.delegates.clear();
+        nextId = other.nextId;
+        other.count = 0;
+        other.defaultDelegatesCount = 0;
+    }
+
+    ~Event() {
+        Clear();
+        if (delegates!=inlineDelegates) {
+            ::operator delete(delegates);
+        }
     }
-    
-    ~Event() { Clear(); }
-    
+
     void Clear() noexcept {
-        for(auto d : delegates) delete d;
-        delegates.clear();
+        ClearFrom(0);
         defaultDelegatesCount = 0;
     }
-    
+
     void ClearNonDefaults() noexcept {
-        for(int i=defaultDelegatesCount; i<delegates.size(); ++i) {
-            delete delegates[i];
-        }
-        delegates.resize(defaultDelegatesCount);
+        ClearFrom(defaultDelegatesCount);
     }
-    
+
     void MarkDefaults() {
-        defaultDelegatesCount = (int)delegates.size();
+        if (invoking == 0) {
+            Compact();
+        }
+        defaultDelegatesCount = count;
     }
-    
+
     bool Empty() const noexcept {
-        return delegates.empty();
+        return count == removedCount && !pending;
     }
-    
+
     void operator () (T... values) {
-        for(auto d : delegates) {
-            d->Invoke(values...);
+        int size = count;
+        invoking++;
+        for(int i=0; i<size; ++i) {
+            Delegate& delegate = delegates[i];
+            if (delegate.id == 0) continue;
+            delegate.invoke(delegate, values...);
+        }
+        invoking--;
+        if (invoking == 0 && (removedCount>0 || pending)) {
+            Compact();
         }
     }
-    
+
     template<typename Obj>
-    void Bind(Obj* object, void (Obj::*method)(T...)) {
-        IDelegateMember<Obj>* delegate = new IDelegateMember<Obj>();
-        delegate->type = GetObjectID<Obj>();
-        delegate->object = object;
-        delegate->method = method;
-        delegates.push_back(delegate);
-    }
-    
+    EventToken Bind(Obj* object, void (Obj::*method)(T...)) {
+        return Add<Member<Obj>>(Member<Obj> { object, method });
+    }
+
     template<typename Obj>
     void Unbind(Obj* object, void (Obj::*method)(T...)) {
-        short typeID = GetObjectID<Obj>();
-        for(int i=0; i<delegates.size(); ++i) {
-            auto d = delegates[i];
-            if (d->type != typeID) continue;
-            IDelegateMember<Obj>* delegate = (IDelegateMember<Obj>*)(d);
-            if (delegate->object != object) continue;
-            if (delegate->method != method) continue;
-            delegates.erase(delegates.begin() + i);
+        using F = Member<Obj>;
+        for(int i=0; i<count; ++i) {
+            Delegate& delegate = delegates[i];
+            if (delegate.id == 0 || delegate.invoke != &Stored<F>::Invoke) continue;
+            F* member = Stored<F>::Get(delegate);
+            if (member->object != object) continue;
+            if (member->method != method) continue;
+            Remove(i);
             return;
         }
     }
-    
+
     template<typename Obj, typename Context>
-    void Bind(Obj* object, void (Obj::*method)(T..., Context), Context context) {
-        IDelegateMemberContext<Obj, Context>* delegate = new IDelegateMemberContext<Obj, Context>();
-        delegate->type = 10000 + GetObjectID<Obj>() + GetObjectID<Context>() * 10000;
-        delegate->object = object;
-        delegate->method = method;
-        delegate->context = context;
-        delegates.push_back(delegate);
-    }
-    
+    EventToken Bind(Obj* object, void (Obj::*method)(T..., Context), Context context) {
+        return Add<MemberContext<Obj, Context>>(MemberContext<Obj, Context> { object, method, context });
+    }
+
     template<typename Obj, typename Context>
     void Unbind(Obj* object, void (Obj::*method)(T..., Context), Context context) {
-        int typeID = 10000 + GetObjectID<Obj>() + GetObjectID<Context>() * 10000;
-        for(int i=0; i<delegates.size(); ++i) {
-            auto d = delegates[i];
-            if (d->type != typeID) continue;
-            IDelegateMemberContext<Obj, Context>* delegate = (IDelegateMemberContext<Obj, Context>*)(d);
-            if (delegate->object != object) continue;
-            if (delegate->method != method) continue;
-            if (delegate->context != context) continue;
-            delegates.erase(delegates.begin() + i);
+        using F = MemberContext<Obj, Context>;
+        for(int i=0; i<count; ++i) {
+            Delegate& delegate = delegates[i];
+            if (delegate.id == 0 || delegate.invoke != &Stored<F>::Invoke) continue;
+            F* member = Stored<F>::Get(delegate);
+            if (member->object != object) continue;
+            if (member->method != method) continue;
+            if (member->context != context) continue;
+            Remove(i);
             return;
         }
     }
-    
+
     template<typename Lambda>
-    void Bind(Lambda&& lambda) {
-        IDelegateLambda* delegate = new IDelegateLambda();
-        delegate->type = -1;
-        delegate->function = lambda;
-        delegates.push_back(delegate);
+    EventToken Bind(Lambda&& lambda) {
+        return Add<typename std::decay<Lambda>::type>(std::forward<Lambda>(lambda));
+    }
+
+    void Unbind(const EventToken& token) {
+        if (token.id == 0) return;
+        if (token.index>=0 && token.index<count && delegates[token.index].id == token.id) {
+            Remove(token.index);
+            return;
+        }
+        for(int i=0; i<count; ++i) {
+            if (delegates[i].id == token.id) {
+                Remove(i);
+                return;
+            }
+        }
+        for(PendingDelegate** node = &pending; *node; node = &(*node)->next) {
+            if ((*node)->delegate.id == token.id) {
+                PendingDelegate* removed = *node;
+                *node = removed->next;
+                Destroy(removed->delegate);
+                delete removed;
+                return;
+            }
+        }
     }
 };
 
-template<typename...T>
-int Event<T...>::objectIDCounter = 0;
 }
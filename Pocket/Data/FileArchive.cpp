@@ -10,6 +10,7 @@
 #include "FileHelper.hpp"
 #include "FileReader.hpp"
 #include "miniz.h"
+#include <cstring>
 
 using namespace Pocket;
 
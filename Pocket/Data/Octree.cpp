@@ -1,141 +1,366 @@
 #include "Octree.hpp"
-#include <iostream> 
+#include <algorithm>
+#include <cmath>
 using namespace Pocket;
 
-const static unsigned MaxObjectsInNode = 32;
+const static int MaxDepth = 10;
 
-Octree::Octree() {
-	children = 0;
-	nodes = 0;
-	parent = 0;
+Octree::Octree() : box(0, 0), looseness(1.5f), maxObjectsInCell(32), unusedSlots(0) {
 }
 
-Octree::Octree(const BoundingBox& box) {
-	SetBoundingBox(box);
+Octree::Octree(const BoundingBox& box) : box(box), looseness(1.5f), maxObjectsInCell(32), unusedSlots(0) {
+    Reset();
 }
 
 Octree::~Octree() {
-	if (children) delete[] children;
-	if (nodes) delete nodes;
 }
 
 void Octree::SetBoundingBox(const BoundingBox& box) {
 	this->box = box;
+    Rebuild();
+}
+
+void Octree::SetLooseness(float looseness) {
+    this->looseness = std::min(std::max(looseness, 1.1f), 4.0f);
+    Rebuild();
+}
+
+void Octree::SetMaxObjectsInCell(int maxObjects) {
+    maxObjectsInCell = std::max(maxObjects, 1);
+    Rebuild();
+}
+
+void Octree::Reset() {
+    cells.clear();
+    freeChildren.clear();
+    boxes.Clear();
+    datas.clear();
+    nodes.clear();
+    unusedSlots = 0;
+    cells.resize(1);
+    InitCell(0, -1, box.center, box.extends * 0.5f, 0);
+}
+
+void Octree::InitCell(int index, int parent, const Vector3& center, const Vector3& half, int depth) {
+    Cell& cell = cells[index];
+    cell.box = BoundingBox(center, half * (2.0f * looseness));
+    cell.center = center;
+    cell.half = half;
+    cell.depth = depth;
+    cell.parent = parent;
+    cell.children = -1;
+    cell.first = 0;
+    cell.count = 0;
+    cell.capacity = 0;
+    cell.total = 0;
+}
+
+// Objects are placed by their center within the regular bounds of a cell,
+// and fit when small enough to stay inside its loose bounds.
+bool Octree::Fits(int cellIndex, const Node& node) const {
+    if (cellIndex == 0) return true;
+    const Cell& cell = cells[cellIndex];
+    const Vector3 size = node.box.extends * 0.5f;
+    const Vector3 slack = cell.half * (looseness - 1.0f);
+    if (size.x>slack.x || size.y>slack.y || size.z>slack.z) return false;
+    const Vector3& center = node.box.center;
+    return  center.x>=cell.center.x - cell.half.x && center.x<=cell.center.x + cell.half.x &&
+            center.y>=cell.center.y - cell.half.y && center.y<=cell.center.y + cell.half.y &&
+            center.z>=cell.center.z - cell.half.z && center.z<=cell.center.z + cell.half.z;
+}
+
+// Moved objects stay in their cell until they leave its loose bounds.
+bool Octree::Contains(int cellIndex, const Node& node) const {
+    if (cellIndex == 0) return true;
+    const Cell& cell = cells[cellIndex];
+    const Vector3 loose = cell.half * looseness;
+    const Vector3 size = node.box.extends * 0.5f;
+    const Vector3& center = node.box.center;
+    return  fabsf(center.x - cell.center.x) + size.x<=loose.x &&
+            fabsf(center.y - cell.center.y) + size.y<=loose.y &&
+            fabsf(center.z - cell.center.z) + size.z<=loose.z;
+}
+
+int Octree::ChildFor(int cellIndex, const Vector3& position) const {
+    const Vector3& center = cells[cellIndex].center;
+    return (position.x>=center.x ? 1 : 0) | (position.y>=center.y ? 2 : 0) | (position.z>=center.z ? 4 : 0);
 }
 
 bool Octree::Insert(Octree::Node& node) {
-    
-    bool test;
-    if (parent) {
-        test = box.Contains(node.box);
-    } else {
-        test = box.Intersects(node.box);
-    }
-
-	if (test) {
-		if (!nodes) nodes = new Nodes();
-
-		if (nodes->size()>=MaxObjectsInNode) {
-			Split();
-			bool insertedIntoChildren = false;
-			for (int i=0; i<8; i++) {
-				insertedIntoChildren = children[i].Insert(node);
-				if (insertedIntoChildren) break;
-			}
-			if (!insertedIntoChildren) {
-				node.childIndex = nodes->size();
-				node.node = this;
-				nodes->push_back(&node);
-			}
-		} else {
-			node.childIndex = nodes->size();
-			node.node = this;
-			nodes->push_back(&node);
-		}
-		return true;
-	}
-
-	return false;
+    if (cells.empty()) Reset();
+    if (node.IsInserted()) {
+        Move(node);
+        return true;
+    }
+    Link(node, 0);
+    if (unusedSlots>4096 && unusedSlots>boxes.Size() / 2) Compact();
+	return true;
 }
 
 void Octree::Remove(Node& node) {
-	    
-	Nodes& nodes = *node.node->nodes;
-	
-	if (nodes.size()<=1) {
-		nodes.clear();
-	} else {
-		Node* last = nodes.back();
-		nodes[node.childIndex] = last;
-		last->childIndex = node.childIndex;
-		nodes.pop_back();
-	}
-    
-    node.node = 0;
+    if (!node.IsInserted()) return;
+    int cellIndex = node.index;
+    Unlink(node, 0);
+    CollapseFrom(cellIndex, 0);
 }
 
-
+// Objects staying within the loose bounds of their cell only update their box,
+// others are reinserted from the nearest cell they fit in.
 void Octree::Move(Node& node) {
-    
-	if (node.node->box.Contains(node.box)) {
-		return;
-	} else {
-		Remove(node);
-		Insert(node);
-	}
+    if (!node.IsInserted()) {
+        Insert(node);
+        return;
+    }
+    int cellIndex = node.index;
+    if (Contains(cellIndex, node)) {
+        boxes.Set(cells[cellIndex].first + node.slot, node.box);
+        return;
+    }
+    int start = cells[cellIndex].parent;
+    while (start>0 && !Fits(start, node)) {
+        start = cells[start].parent;
+    }
+    // cells above start keep their totals
+    start = std::max(start, 0);
+    Unlink(node, start);
+    Link(node, start);
+    CollapseFrom(cellIndex, start);
+    if (unusedSlots>4096 && unusedSlots>boxes.Size() / 2) Compact();
+}
+
+void Octree::Link(Node& node, int top) {
+    int cellIndex = top;
+    while (cells[cellIndex].children>=0) {
+        int child = cells[cellIndex].children + ChildFor(cellIndex, node.box.center);
+        if (!Fits(child, node)) break;
+        cellIndex = child;
+    }
+    AddToCell(cellIndex, node);
+    for(int i = cellIndex; ; i = cells[i].parent) {
+        cells[i].total++;
+        if (i == top) break;
+    }
+    const Cell& cell = cells[cellIndex];
+    if (cell.children<0 && cell.count>maxObjectsInCell && cell.depth<MaxDepth) {
+        Split(cellIndex);
+    }
+}
+
+void Octree::Unlink(Node& node, int top) {
+    for(int i = node.index; ; i = cells[i].parent) {
+        cells[i].total--;
+        if (i == top) break;
+    }
+    RemoveFromCell(node);
+}
+
+void Octree::AddToCell(int cellIndex, Node& node) {
+    Cell& cell = cells[cellIndex];
+    if (cell.count == cell.capacity) {
+        // full spans move to the end of the arrays with room to grow
+        int capacity = cell.capacity ? cell.capacity * 2 : 4;
+        int first = (int)boxes.Size();
+        boxes.Resize(first + capacity);
+        datas.resize(first + capacity);
+        nodes.resize(first + capacity);
+        for(int i=0; i<cell.count; ++i) {
+            boxes.Copy(first + i, cell.first + i);
+            datas[first + i] = datas[cell.first + i];
+            nodes[first + i] = nodes[cell.first + i];
+        }
+        unusedSlots += cell.capacity;
+        cell.first = first;
+        cell.capacity = capacity;
+    }
+    int slot = cell.count++;
+    boxes.Set(cell.first + slot, node.box);
+    datas[cell.first + slot] = node.data;
+    nodes[cell.first + slot] = &node;
+    node.index = cellIndex;
+    node.slot = slot;
+}
+
+void Octree::RemoveFromCell(Node& node) {
+    Cell& cell = cells[node.index];
+    int last = cell.count - 1;
+    if (node.slot!=last) {
+        int to = cell.first + node.slot;
+        int from = cell.first + last;
+        boxes.Copy(to, from);
+        datas[to] = datas[from];
+        nodes[to] = nodes[from];
+        nodes[to]->slot = node.slot;
+    }
+    cell.count--;
+    node.index = -1;
+}
+
+int Octree::AllocateChildren() {
+    if (!freeChildren.empty()) {
+        int children = freeChildren.back();
+        freeChildren.pop_back();
+        return children;
+    }
+    int children = (int)cells.size();
+    cells.resize(children + 8);
+    return children;
+}
+
+// Objects small enough for the children move down, larger ones stay.
+void Octree::Split(int cellIndex) {
+    int children = AllocateChildren();
+    const Vector3 center = cells[cellIndex].center;
+    const Vector3 half = cells[cellIndex].half * 0.5f;
+    const int depth = cells[cellIndex].depth;
+    for(int i=0; i<8; ++i) {
+        Vector3 offset((i & 1) ? half.x : -half.x, (i & 2) ? half.y : -half.y, (i & 4) ? half.z : -half.z);
+        InitCell(children + i, cellIndex, center + offset, half, depth + 1);
+    }
+    cells[cellIndex].children = children;
+
+    for(int i = cells[cellIndex].count - 1; i>=0; --i) {
+        Node& node = *nodes[cells[cellIndex].first + i];
+        int child = children + ChildFor(cellIndex, node.box.center);
+        if (!Fits(child, node)) continue;
+        RemoveFromCell(node);
+        AddToCell(child, node);
+        cells[child].total++;
+    }
+
+    for(int i=0; i<8; ++i) {
+        const Cell& child = cells[children + i];
+        if (child.count>maxObjectsInCell && child.depth<MaxDepth) {
+            Split(children + i);
+        }
+    }
+}
+
+// Collapses the highest cell up to top which has few enough objects left.
+void Octree::CollapseFrom(int cellIndex, int top) {
+    int target = -1;
+    for(int i = cellIndex; ; i = cells[i].parent) {
+        if (cells[i].children>=0 && cells[i].total<=maxObjectsInCell / 2) {
+            target = i;
+        }
+        if (i == top) break;
+    }
+    if (target<0) return;
+    int children = cells[target].children;
+    for(int i=0; i<8; ++i) {
+        Collapse(children + i, target);
+    }
+    freeChildren.push_back(children);
+    cells[target].children = -1;
 }
 
+void Octree::Collapse(int cellIndex, int intoCell) {
+    while (cells[cellIndex].count>0) {
+        Cell& cell = cells[cellIndex];
+        Node& node = *nodes[cell.first + cell.count - 1];
+        RemoveFromCell(node);
+        AddToCell(intoCell, node);
+    }
+    int children = cells[cellIndex].children;
+    if (children>=0) {
+        for(int i=0; i<8; ++i) {
+            Collapse(children + i, intoCell);
+        }
+        freeChildren.push_back(children);
+    }
+    Cell& cell = cells[cellIndex];
+    unusedSlots += cell.capacity;
+    cell.children = -1;
+    cell.capacity = 0;
+    cell.total = 0;
+}
 
-void Octree::Split() {
-	if (children) return;
-	children = new Octree[8];
+// Spans are laid out again in depth first order, so cells close in the tree are close in memory.
+void Octree::Compact() {
+    PackedBoxes newBoxes;
+    std::vector<void*> newDatas;
+    std::vector<Node*> newNodes;
+    size_t size = Size();
+    newBoxes.Resize(size);
+    newDatas.reserve(size);
+    newNodes.reserve(size);
 
-	Vector3 size = box.extends * 0.5f;
-	Vector3 offset = size * 0.5f;
+    std::vector<int> stack;
+    stack.push_back(0);
+    while (!stack.empty()) {
+        int cellIndex = stack.back();
+        stack.pop_back();
+        Cell& cell = cells[cellIndex];
+        int first = (int)newDatas.size();
+        for(int i=0; i<cell.count; ++i) {
+            newBoxes.Copy(first + i, boxes, cell.first + i);
+        }
+        newDatas.insert(newDatas.end(), datas.begin() + cell.first, datas.begin() + cell.first + cell.count);
+        newNodes.insert(newNodes.end(), nodes.begin() + cell.first, nodes.begin() + cell.first + cell.count);
+        cell.first = first;
+        cell.capacity = cell.count;
+        if (cell.children>=0) {
+            for(int i=7; i>=0; --i) {
+                stack.push_back(cell.children + i);
+            }
+        }
+    }
+    boxes.Swap(newBoxes);
+    datas.swap(newDatas);
+    nodes.swap(newNodes);
+    unusedSlots = 0;
+}
 
-	children[0].box = BoundingBox(box.center + Vector3(-offset.x, -offset.y, -offset.z), size);
-	children[1].box = BoundingBox(box.center + Vector3(-offset.x, offset.y, -offset.z), size);
-	children[2].box = BoundingBox(box.center + Vector3(offset.x, offset.y, -offset.z), size);
-	children[3].box = BoundingBox(box.center + Vector3(offset.x, -offset.y, -offset.z), size);
-	children[4].box = BoundingBox(box.center + Vector3(-offset.x, -offset.y, offset.z), size);
-	children[5].box = BoundingBox(box.center + Vector3(-offset.x, offset.y, offset.z), size);
-	children[6].box = BoundingBox(box.center + Vector3(offset.x, offset.y, offset.z), size);
-	children[7].box = BoundingBox(box.center + Vector3(offset.x, -offset.y, offset.z), size);
+void Octree::Rebuild() {
+    Nodes all;
+    if (!cells.empty()) {
+        all.reserve(Size());
+        GetNodes(0, all);
+    }
+    Reset();
+    for(Node* node : all) {
+        node->index = -1;
+        Link(*node, 0);
+    }
+    Compact();
+}
 
-	for (int i=0; i<8; i++) {
-		children[i].parent = this;
-	}
+void Octree::GetNodes(int cellIndex, Nodes& list) const {
+    const Cell& cell = cells[cellIndex];
+    if (cell.total == 0) return;
+    list.insert(list.end(), nodes.begin() + cell.first, nodes.begin() + cell.first + cell.count);
+    if (cell.children<0) return;
+    for(int i=0; i<8; ++i) {
+        GetNodes(cell.children + i, list);
+    }
 }
 
 void Octree::Get(const BoundingFrustum& frustum, Octree::Nodes& list) {
-	if (!nodes) return;
-
-	BoundingFrustum::Intersection test = frustum.Intersect(box);
-
-	if (test == BoundingFrustum::OUTSIDE) {
-		return;
-	} else if (test == BoundingFrustum::INSIDE) {
-		GetRecursive(list);
-		return;
-	} else {
-		for(size_t i = 0, size=nodes->size(); i<size; i++) {
-			Node* node = nodes->at(i);
-            
-			if (frustum.Intersect(node->box)!=BoundingFrustum::OUTSIDE) list.push_back(node);
-			//list.push_back(node);
-		}
-		if (!children) return;
-		for (int i=0; i<8; i++) {
-			children[i].Get(frustum, list);
-		}
-	}
-}
-
-void Octree::GetRecursive(Nodes& list) {
-	if (!nodes) return;
-	for	(unsigned i=0;i<nodes->size(); i++) {
-		list.push_back(nodes->at(i));
-	}
-	if (!children) return;
-	for(int i=0; i<8; i++) children[i].GetRecursive(list);
-}
\ No newline at end of file
+    if (cells.empty() || cells[0].total == 0) return;
+    const Cell& root = cells[0];
+    for(int i = root.first, end = root.first + root.count; i<end; ++i) {
+        if (frustum.Intersect(boxes.Get(i))!=BoundingFrustum::OUTSIDE) list.push_back(nodes[i]);
+    }
+    if (root.children<0 || frustum.Intersect(root.box) == BoundingFrustum::OUTSIDE) return;
+    for(int i=0; i<8; ++i) {
+        GetNodesInFrustum(root.children + i, frustum, list);
+    }
+}
+
+void Octree::GetNodesInFrustum(int cellIndex, const BoundingFrustum& frustum, Nodes& list) const {
+    const Cell& cell = cells[cellIndex];
+    if (cell.total == 0) return;
+    BoundingFrustum::Intersection test = frustum.Intersect(cell.box);
+    if (test == BoundingFrustum::OUTSIDE) {
+        return;
+    } else if (test == BoundingFrustum::INSIDE) {
+        GetNodes(cellIndex, list);
+        return;
+    }
+    for(int i = cell.first, end = cell.first + cell.count; i<end; ++i) {
+        if (frustum.Intersect(boxes.Get(i))!=BoundingFrustum::OUTSIDE) list.push_back(nodes[i]);
+    }
+    if (cell.children<0) return;
+    for(int i=0; i<8; ++i) {
+        GetNodesInFrustum(cell.children + i, frustum, list);
+    }
+}
@@ -1,23 +1,25 @@
 #pragma once
 #include "BoundingBox.hpp"
+#include "SpatialNode.hpp"
 #include "BoundingFrustum.hpp"
+#include "PackedBoxes.hpp"
+#include "OcclusionBuffer.hpp"
 #include "Ray.hpp"
+#include <algorithm>
 #include <vector>
 
 namespace Pocket {
+    // Loose octree, cells are larger than their regular size by the looseness factor, so an object
+    // is placed by its center and size alone, and small moves keep it in the same cell.
+    // Cells live in one array, the 8 children of a cell are stored together in Morton order.
+    // The boxes and data of the objects in a cell are stored together in one span of shared arrays,
+    // queries walk cells and spans by index without following pointers.
 	class Octree
 	{
 	public:
 
-		
-
-		struct Node {
-			BoundingBox box;
-			Octree* node;
-			size_t childIndex;
-            int order;
-			void* data;
-		};
+        // The index of a node is its cell, the slot its position within the cell.
+		typedef SpatialNode Node;
 
 		typedef std::vector<Node*> Nodes;
 
@@ -25,83 +27,240 @@ namespace Pocket {
 		Octree(const BoundingBox& box);
 		~Octree();
 
+        // Objects outside the bounds are kept in the root cell.
 		bool Insert(Node& node);
 		void Remove(Node& node);
+        // Call after changing the box of an inserted node.
 		void Move(Node& node);
 
 		void Get(const BoundingFrustum& frustum, Nodes& list);
 
+        // Reinserts all objects into the new bounds.
 		void SetBoundingBox(const BoundingBox& box);
-        
+
+        // Cells are looseness times their regular size, between 1.1 and 4, 1.5 by default.
+        // Looser cells hold objects in deeper cells, but overlap each other more.
+        void SetLooseness(float looseness);
+
+        // A cell is split when it holds more objects than this, cells are collapsed
+        // into their parent when all objects below the parent would fit in half of it.
+        void SetMaxObjectsInCell(int maxObjects);
+
+        // Reinserts all objects and lays out cells and spans in depth first order.
+        void Rebuild();
+
+        size_t Size() const { return cells.empty() ? 0 : cells[0].total; }
+
+        // Cells only test the frustum planes their parent was not inside of, and the objects of a cell
+        // are tested together. lastPlanes is optional, holding the plane that last rejected each object,
+        // which is tested first. Keep one per frustum, as a moving frustum is often rejected by the same planes.
+        // Cells and objects hidden in the optional occlusion buffer are skipped.
         template<typename T>
-        void Get(const BoundingFrustum& frustum, std::vector<T>& list) {
-            if (!nodes) return;
-            
-            BoundingFrustum::Intersection test = frustum.Intersect(box);
-            
-            if (test == BoundingFrustum::OUTSIDE) {
-                return;
-            } else if (test == BoundingFrustum::INSIDE) {
-                GetRecursive<T>(list);
+        void Get(const BoundingFrustum& frustum, std::vector<T>& list, std::vector<unsigned char>* lastPlanes = 0, const OcclusionBuffer* occlusion = 0) const {
+            if (cells.empty() || cells[0].total == 0) return;
+            if (occlusion && occlusion->IsEmpty()) occlusion = 0;
+            unsigned char* planes = 0;
+            if (lastPlanes) {
+                if (lastPlanes->size()<boxes.Size()) lastPlanes->resize(boxes.Size(), 0);
+                planes = lastPlanes->data();
+            }
+            // the root also holds objects outside its bounds, they are always tested
+            const Cell& root = cells[0];
+            GetInFrustum<T>(root, frustum, BoundingFrustum::AllPlanes, planes, occlusion, list);
+            if (root.children<0) return;
+            int planeMask = BoundingFrustum::AllPlanes;
+            if (frustum.Intersect(root.box, planeMask) == BoundingFrustum::OUTSIDE) return;
+            for (int i=0; i<8; i++) {
+                Get<T>(root.children + i, frustum, planeMask, planes, occlusion, list);
+            }
+        }
+
+        template<typename T>
+        void Get(const Ray& ray, std::vector<T>& list) const {
+            if (cells.empty() || cells[0].total == 0) return;
+            const Cell& root = cells[0];
+            for(int i = root.first, end = root.first + root.count; i<end; ++i) {
+                if (ray.Intersect(boxes, i)) list.push_back((T)datas[i]);
+            }
+            if (root.children<0 || !ray.Intersect(root.box)) return;
+            for (int i=0; i<8; i++) {
+                Get<T>(root.children + i, ray, list);
+            }
+        }
+
+        // Walks the cells once for up to Ray::MaxBatch rays, lists holds one list per ray.
+        template<typename T>
+        void Get(const Ray* rays, int count, std::vector<T>* lists) const {
+            if (cells.empty() || cells[0].total == 0 || count<=0) return;
+            if (count>Ray::MaxBatch) count = Ray::MaxBatch;
+            const unsigned all = count == Ray::MaxBatch ? ~0u : (1u << count) - 1;
+            const Cell& root = cells[0];
+            GetAtRays<T>(root, rays, all, lists);
+            if (root.children<0) return;
+            const unsigned mask = RaysIntersecting(root.box, rays, all);
+            if (!mask) return;
+            for (int i=0; i<8; i++) {
+                Get<T>(root.children + i, rays, mask, lists);
+            }
+        }
+
+	private:
+
+        struct Cell {
+            // Loose bounds, used by queries.
+            BoundingBox box;
+            Vector3 center;
+            // Half the regular size, objects are placed by their center within it.
+            Vector3 half;
+            int depth;
+            int parent;
+            // First of the 8 children, or -1.
+            int children;
+            // Span of the objects in this cell, within boxes, datas and nodes.
+            int first;
+            int count;
+            int capacity;
+            // Objects in this cell and all cells below it.
+            int total;
+        };
+
+        template<typename T>
+        void Get(int cellIndex, const BoundingFrustum& frustum, int planeMask, unsigned char* lastPlanes, const OcclusionBuffer* occlusion, std::vector<T>& list) const {
+            const Cell& cell = cells[cellIndex];
+            if (cell.total == 0) return;
+            BoundingFrustum::Intersection test = frustum.Intersect(cell.box, planeMask);
+            if (test == BoundingFrustum::OUTSIDE) return;
+            if (occlusion && occlusion->IsOccluded(cell.box)) return;
+            if (test == BoundingFrustum::INSIDE && !occlusion) {
+                GetAll<T>(cellIndex, list);
                 return;
-            } else {
-                for(size_t i = 0, size=nodes->size(); i<size; i++) {
-                    Node* node = nodes->at(i);
-                    
-                    if (frustum.Intersect(node->box)!=BoundingFrustum::OUTSIDE) list.push_back((T)node->data);
-                    //list.push_back(node);
+            }
+            GetInFrustum<T>(cell, frustum, planeMask, lastPlanes, occlusion, list);
+            if (cell.children<0) return;
+            for (int i=0; i<8; i++) {
+                Get<T>(cell.children + i, frustum, planeMask, lastPlanes, occlusion, list);
+            }
+        }
+
+        template<typename T>
+        void GetInFrustum(const Cell& cell, const BoundingFrustum& frustum, int planeMask, unsigned char* lastPlanes, const OcclusionBuffer* occlusion, std::vector<T>& list) const {
+            const int BatchSize = 64;
+            BoundingFrustum::Intersection results[BatchSize];
+            for(int begin = 0; begin<cell.count; begin += BatchSize) {
+                const int first = cell.first + begin;
+                const int count = std::min(BatchSize, cell.count - begin);
+                if (planeMask) {
+                    frustum.Intersect(boxes, first, count, planeMask, results, lastPlanes ? lastPlanes + first : 0);
+                } else {
+                    std::fill(results, results + count, BoundingFrustum::INSIDE);
                 }
-                if (!children) return;
-                for (int i=0; i<8; i++) {
-                    children[i].Get<T>(frustum, list);
+                for(int i=0; i<count; ++i) {
+                    if (results[i] == BoundingFrustum::OUTSIDE) continue;
+                    if (occlusion && IsOccluded(*occlusion, first + i)) continue;
+                    list.push_back((T)datas[first + i]);
                 }
             }
         }
-        
+
+        bool IsOccluded(const OcclusionBuffer& occlusion, int slot) const {
+            return occlusion.IsOccluded(Vector3(boxes.centerX[slot], boxes.centerY[slot], boxes.centerZ[slot]),
+                                        Vector3(boxes.halfX[slot], boxes.halfY[slot], boxes.halfZ[slot]));
+        }
+
+        template<typename T>
+        void GetAll(int cellIndex, std::vector<T>& list) const {
+            const Cell& cell = cells[cellIndex];
+            if (cell.total == 0) return;
+            for(int i = cell.first, end = cell.first + cell.count; i<end; ++i) {
+                list.push_back((T)datas[i]);
+            }
+            if (cell.children<0) return;
+            for (int i=0; i<8; i++) {
+                GetAll<T>(cell.children + i, list);
+            }
+        }
+
         template<typename T>
-        void GetRecursive(std::vector<T>& list) {
-            if (!nodes) return;
-            for	(unsigned i=0;i<nodes->size(); i++) {
-                list.push_back((T)nodes->at(i)->data);
+        void Get(int cellIndex, const Ray& ray, std::vector<T>& list) const {
+            const Cell& cell = cells[cellIndex];
+            if (cell.total == 0 || !ray.Intersect(cell.box)) return;
+            for(int i = cell.first, end = cell.first + cell.count; i<end; ++i) {
+                if (ray.Intersect(boxes, i)) list.push_back((T)datas[i]);
+            }
+            if (cell.children<0) return;
+            for (int i=0; i<8; i++) {
+                Get<T>(cell.children + i, ray, list);
             }
-            if (!children) return;
-            for(int i=0; i<8; i++) children[i].GetRecursive(list);
         }
-        
+
         template<typename T>
-        void Get(const Ray& ray, std::vector<T>& list) {
-            if (!nodes) return;
-            
-            if (!ray.Intersect(box)) {
+        void Get(int cellIndex, const Ray* rays, unsigned mask, std::vector<T>* lists) const {
+            // a ray left on its own walks on without the masks
+            if (!(mask & (mask - 1))) {
+                int r = 0;
+                while (!(mask & (1u << r))) ++r;
+                Get<T>(cellIndex, rays[r], lists[r]);
                 return;
             }
-            else {
-                for(size_t i = 0, size=nodes->size(); i<size; i++) {
-                    Node* node = nodes->at(i);
-                    
-                    if (ray.Intersect(node->box)) list.push_back((T)node->data);
-                }
-                if (!children) return;
-                for (int i=0; i<8; i++) {
-                    children[i].Get<T>(ray, list);
+            const Cell& cell = cells[cellIndex];
+            if (cell.total == 0) return;
+            mask = RaysIntersecting(cell.box, rays, mask);
+            if (!mask) return;
+            GetAtRays<T>(cell, rays, mask, lists);
+            if (cell.children<0) return;
+            for (int i=0; i<8; i++) {
+                Get<T>(cell.children + i, rays, mask, lists);
+            }
+        }
+
+        template<typename T>
+        void GetAtRays(const Cell& cell, const Ray* rays, unsigned mask, std::vector<T>* lists) const {
+            for(int i = cell.first, end = cell.first + cell.count; i<end; ++i) {
+                int r = 0;
+                for (unsigned m = mask; m; m >>= 1, ++r) {
+                    if ((m & 1) && rays[r].Intersect(boxes, i)) lists[r].push_back((T)datas[i]);
                 }
             }
         }
-        
-        
 
-	private:
+        static unsigned RaysIntersecting(const BoundingBox& box, const Ray* rays, unsigned mask) {
+            unsigned result = 0;
+            int r = 0;
+            for (unsigned m = mask; m; m >>= 1, ++r) {
+                if ((m & 1) && rays[r].Intersect(box)) result |= 1u << r;
+            }
+            return result;
+        }
 
-		BoundingBox box;
-		Octree* parent;
-		Octree* children;
-		
-		Nodes* nodes;
-		
-		void Split();
+        void Reset();
+        void InitCell(int index, int parent, const Vector3& center, const Vector3& half, int depth);
+        bool Fits(int cellIndex, const Node& node) const;
+        bool Contains(int cellIndex, const Node& node) const;
+        int ChildFor(int cellIndex, const Vector3& position) const;
+        // Totals are updated from the node's cell up to and including top.
+        void Link(Node& node, int top);
+        void Unlink(Node& node, int top);
+        void AddToCell(int cellIndex, Node& node);
+        void RemoveFromCell(Node& node);
+        void Split(int cellIndex);
+        void CollapseFrom(int cellIndex, int top);
+        void Collapse(int cellIndex, int intoCell);
+        int AllocateChildren();
+        void Compact();
+        void GetNodes(int cellIndex, Nodes& list) const;
+        void GetNodesInFrustum(int cellIndex, const BoundingFrustum& frustum, Nodes& list) const;
 
-		void GetRecursive(Nodes& list);
+		BoundingBox box;
+        float looseness;
+        int maxObjectsInCell;
 
+        std::vector<Cell> cells;
+        std::vector<int> freeChildren;
 
+        PackedBoxes boxes;
+        std::vector<void*> datas;
+        std::vector<Node*> nodes;
+        // Slots left behind when spans grew and moved to the end.
+        size_t unusedSlots;
 	};
 }
@@ -0,0 +1,27 @@
+//
+//  SpatialNode.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "BoundingBox.hpp"
+
+namespace Pocket {
+    // Object in a spatial index, like Octree or DynamicTree. Owned by the caller,
+    // and must stay at the same address while inserted.
+    struct SpatialNode {
+        SpatialNode() : data(0), index(-1), slot(0) { }
+
+        BoundingBox box;
+        void* data;
+
+        bool IsInserted() const { return index>=0; }
+
+        // Where the index keeps the node, -1 when not inserted.
+        int index;
+        int slot;
+    };
+}
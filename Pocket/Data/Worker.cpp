@@ -10,12 +10,18 @@
 
 using namespace Pocket;
 
+Worker::Worker() : Worker(JobSystem::Default()) { }
+
+Worker::Worker(JobSystem& jobs) : jobs(jobs), finished(std::make_shared<Finished>()) { }
+
 void Worker::Update() {
-    for (int i=0; i<tasks.size(); ++i) {
-        if (tasks[i].check()) {
-            tasks[i].finished();
-            tasks.erase(tasks.begin() + i);
-            i--;
-        }
+    {
+        std::lock_guard<std::mutex> lock(finished->mutex);
+        if (finished->callbacks.empty()) return;
+        running.swap(finished->callbacks);
+    }
+    for(auto& callback : running) {
+        callback();
     }
+    running.clear();
 }
@@ -8,31 +8,58 @@
 
 #pragma once
 #include <functional>
-#include <future>
-#include <deque>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "JobSystem.hpp"
 
 namespace Pocket {
+    // Runs tasks as background jobs of the JobSystem and hands their results to the finished callback
+    // on the thread calling Update. Only this worker's callbacks run from its Update,
+    // pending callbacks are dropped when the worker is destroyed.
     class Worker {
         private:
-            struct Task {
-                std::function<bool()> check;
-                std::function<void()> finished;
+            struct Finished {
+                std::mutex mutex;
+                std::vector<std::function<void()>> callbacks;
             };
-            std::deque<Task> tasks;
+            JobSystem& jobs;
+            std::shared_ptr<Finished> finished;
+            std::vector<std::function<void()>> running;
+        
+            template<typename Task, typename Callback>
+            static std::function<void()> Run(Task& task, Callback& callback, std::true_type) {
+                task();
+                return callback;
+            }
+        
+            template<typename Task, typename Callback>
+            static std::function<void()> Run(Task& task, Callback& callback, std::false_type) {
+                using Result = typename std::decay<decltype(task())>::type;
+                std::shared_ptr<Result> result = std::make_shared<Result>(task());
+                return [callback, result] () {
+                    callback(*result);
+                };
+            }
         public:
+        Worker();
+        Worker(JobSystem& jobs);
+        
         void Update();
         
-        template<typename Task, typename Finished>
-        void DoTask(Task&& task, Finished&& finished) {
-            auto future = std::async(std::launch::async, task).share();
-            const static auto zeroDuration = std::chrono::seconds(0);
-            tasks.push_back({
-                [future] () {
-                    return future.wait_for(zeroDuration) == std::future_status::ready;
-                },
-                [finished, future] () {
-                    finished(future.get());
-                }
+        template<typename Task, typename Callback>
+        void DoTask(Task&& task, Callback&& callback) {
+            using IsVoid = typename std::is_void<decltype(task())>::type;
+            std::weak_ptr<Finished> owner = finished;
+            typename std::decay<Task>::type job = std::forward<Task>(task);
+            typename std::decay<Callback>::type done = std::forward<Callback>(callback);
+            jobs.ScheduleBackground([job, done, owner] () mutable {
+                std::function<void()> call = Run(job, done, IsVoid());
+                std::shared_ptr<Finished> worker = owner.lock();
+                if (!worker) return;
+                std::lock_guard<std::mutex> lock(worker->mutex);
+                worker->callbacks.push_back(std::move(call));
             });
         }
     };
@@ -12,9 +12,9 @@
 using namespace Pocket;
 
 void ParticleMeshUpdater::Update(float dt) {
-    for (auto go : Objects()) {
-        UpdateMesh(go->GetComponent<Mesh>(), go->GetComponent<ParticleEmitter>());
-    }
+    ForEach([this] (Mesh& mesh, ParticleEmitter& emitter) {
+        UpdateMesh(&mesh, &emitter);
+    });
 }
 
 void ParticleMeshUpdater::UpdateMesh(Mesh *mesh, ParticleEmitter *emitter) {
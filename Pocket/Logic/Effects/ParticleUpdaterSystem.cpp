@@ -28,10 +28,9 @@ void ParticleUpdaterSystem::ObjectRemoved(Pocket::GameObject *object) {
 }
 
 void ParticleUpdaterSystem::Update(float dt) {
-    for (ObjectCollection::const_iterator it = Objects().begin(); it!=Objects().end(); ++it) {
-        GameObject* object = *it;
-        UpdateEmitter(dt, object->GetComponent<ParticleEffect>(), object->GetComponent<ParticleEmitter>(), object);
-    }
+    ForEachObject([this, dt] (GameObject* object, ParticleEffect& effect, ParticleEmitter& emitter) {
+        UpdateEmitter(dt, &effect, &emitter, object);
+    });
 }
 
 void ParticleUpdaterSystem::UpdateEmitter(float dt, ParticleEffect *effect, ParticleEmitter *emitter, GameObject* object) {
@@ -23,11 +23,13 @@ void TouchSystem::Initialize() {
 
     root->Input().TouchDown.Bind(this, &TouchSystem::TouchDown);
     root->Input().TouchUp.Bind(this, &TouchSystem::TouchUp);
+    root->Input().TouchesUpdated.Bind(this, &TouchSystem::TouchesUpdated);
 }
 
 void TouchSystem::Destroy() {
     root->Input().TouchDown.Unbind(this, &TouchSystem::TouchDown);
     root->Input().TouchUp.Unbind(this, &TouchSystem::TouchUp);
+    root->Input().TouchesUpdated.Unbind(this, &TouchSystem::TouchesUpdated);
 }
 
 TouchSystem::OctreeSystem& TouchSystem::Octree() { return *octree; }
@@ -60,6 +62,8 @@ void TouchSystem::ObjectRemoved(GameObject* object) {
 }
 
 void TouchSystem::Update(float dt) {
+    TouchesUpdated();
+    
     if (!cancelledTouchables.empty()) {
         for (CancelledTouchables::iterator it = cancelledTouchables.begin(); it!=cancelledTouchables.end(); ++it) {
             Touchable* cancelled = *it;
@@ -108,50 +112,75 @@ bool TouchSystem::IsTouchValid(const Pocket::TouchData &touchData) {
 }
 
 void TouchSystem::TouchDown(Pocket::TouchEvent e) {
-    Touched& list = touches[e.Index];
-    
-    FindTouchedObjects(list, e);
-    AddToTouchList(list, downs);
-    
-    for (size_t i = 0; i<list.size(); i++) {
-        list[i].Touchable->Cancelled.Bind(this, &TouchSystem::TouchableCancelled);
-    }
-    
-    if (!list.empty()) {
-        root->Input().SwallowTouch(e.Index, TouchDepth);
-    }
+    pendingDowns.push_back(e);
 }
 
 void TouchSystem::TouchUp(Pocket::TouchEvent e) {
-    
-    Touched& touchList = touches[e.Index];
-    
-    for (size_t i=0; i<touchList.size(); i++) {
-        CancelledTouchables::iterator it = cancelledTouchables.find(touchList[i].Touchable);
-        if (it!=cancelledTouchables.end()) {
-            touchList.erase(touchList.begin() + i);
-            i--;
+    pendingUps.push_back(e);
+}
+
+void TouchSystem::TouchesUpdated() {
+    if (!pendingDowns.empty()) {
+        FindTouchedObjects(foundTouches, pendingDowns);
+        
+        for (size_t d = 0; d<pendingDowns.size(); d++) {
+            const TouchEvent& e = pendingDowns[d];
+            Touched& list = touches[e.Index];
+            
+            AddToTouchList(foundTouches[d], list);
+            AddToTouchList(list, downs);
+            
+            for (size_t i = 0; i<list.size(); i++) {
+                list[i].Touchable->Cancelled.Bind(this, &TouchSystem::TouchableCancelled);
+            }
+            
+            if (!list.empty()) {
+                root->Input().SwallowTouch(e.Index, TouchDepth);
+            }
         }
+        pendingDowns.clear();
     }
     
-    if (touchList.empty()) return;
-    
-    Touched list;
-    FindTouchedObjects(list, e);
-    
-    for (unsigned i=0; i<list.size(); i++) {
-        if (IsTouchInList(list[i], touchList)) {
-            clicks.push_back(list[i]);
+    if (!pendingUps.empty()) {
+        for (size_t u = 0; u<pendingUps.size(); u++) {
+            Touched& touchList = touches[pendingUps[u].Index];
+            
+            for (size_t i=0; i<touchList.size(); i++) {
+                CancelledTouchables::iterator it = cancelledTouchables.find(touchList[i].Touchable);
+                if (it!=cancelledTouchables.end()) {
+                    touchList.erase(touchList.begin() + i);
+                    i--;
+                }
+            }
+            
+            if (touchList.empty()) {
+                pendingUps.erase(pendingUps.begin() + u);
+                u--;
+            }
         }
+        
+        FindTouchedObjects(foundTouches, pendingUps);
+        
+        for (size_t u = 0; u<pendingUps.size(); u++) {
+            Touched& touchList = touches[pendingUps[u].Index];
+            Touched& list = foundTouches[u];
+            
+            for (unsigned i=0; i<list.size(); i++) {
+                if (IsTouchInList(list[i], touchList)) {
+                    clicks.push_back(list[i]);
+                }
+            }
+            
+            AddToTouchList(touchList, ups);
+            
+            for (size_t i = 0; i<touchList.size(); i++) {
+                touchList[i].Touchable->Cancelled.Unbind(this, &TouchSystem::TouchableCancelled);
+            }
+            
+            touchList.clear();
+        }
+        pendingUps.clear();
     }
-    
-    AddToTouchList(touchList, ups);
-    
-    for (size_t i = 0; i<touchList.size(); i++) {
-        touchList[i].Touchable->Cancelled.Unbind(this, &TouchSystem::TouchableCancelled);
-    }
-    
-    touchList.clear();
 }
 
 TouchSystem::TouchableObject::TouchableObject(GameObject* object) {
@@ -161,6 +190,8 @@ TouchSystem::TouchableObject::TouchableObject(GameObject* object) {
     orderable = object->GetComponent<Orderable>();
     Renderable* renderable = object->GetComponent<Renderable>();
     clip = renderable ? renderable->Clip : 0;
+    rays = 0;
+    hitsIndex = 0;
 }
 
 bool TouchSystem::SortClippers(const TouchableObject *a, const TouchableObject *b) {
@@ -190,88 +221,117 @@ TouchSystem::TouchableObject* TouchSystem::FindClipper(TouchableObject *fromThis
 }
 
 void TouchSystem::FindTouchedObjects(Touched& list, const TouchEvent& e, bool forceClickThrough) {
+    FindTouchedObjects(&e, &list, 1, forceClickThrough);
+}
+
+void TouchSystem::FindTouchedObjects(std::vector<Touched>& lists, const TouchEvents& events, bool forceClickThrough) {
+    lists.resize(events.size());
+    for (size_t i = 0; i<lists.size(); i++) {
+        lists[i].clear();
+    }
+    if (events.empty()) return;
+    FindTouchedObjects(events.data(), lists.data(), (int)events.size(), forceClickThrough);
+}
+
+void TouchSystem::FindTouchedObjects(const TouchEvent* events, Touched* lists, int count, bool forceClickThrough) {
     const auto& cameras = this->cameras->Objects();
-    for (auto it = cameras.begin(); it!=cameras.end(); ++it) {
-        FindTouchedObjectsFromCamera(*it, list, e, forceClickThrough);
+    for (int first = 0; first<count; first += Ray::MaxBatch) {
+        int batchCount = std::min(count - first, (int)Ray::MaxBatch);
+        for (auto it = cameras.begin(); it!=cameras.end(); ++it) {
+            FindTouchedObjectsFromCamera(*it, events + first, lists + first, batchCount, forceClickThrough);
+        }
     }
 }
 
-void TouchSystem::FindTouchedObjectsFromCamera(GameObject* cameraObject, Touched& list, const TouchEvent& e, bool forceClickThrough) {
+void TouchSystem::FindTouchedObjectsFromCamera(GameObject* cameraObject, const TouchEvent* events, Touched* lists, int count, bool forceClickThrough) {
     Camera* camera = cameraObject->GetComponent<Camera>();
+    Transform* cameraTransform = cameraObject->GetComponent<Transform>();
     
-    Ray ray = camera->GetRay(cameraObject->GetComponent<Transform>(), e.Position);
+    Ray rays[Ray::MaxBatch];
+    for (int r = 0; r<count; r++) {
+        rays[r] = camera->GetRay(cameraTransform, events[r].Position);
+    }
     
     BoundingFrustum::Count = 0;
-    octree->GetObjectsAtRay(ray, touchableList);
+    octree->GetObjectsAtRays(rays, count, touchableLists);
     
-    if (touchableList.empty()) {
-        return;
+    // objects at several rays are tested against their mesh once, for all of the rays
+    for (int r = 0; r<count; r++) {
+        const ObjectCollection& touchableList = touchableLists[r];
+        for (size_t i = 0; i<touchableList.size(); i++) {
+            TouchableObject* t = (TouchableObject*)this->GetMetaData(touchableList[i]);
+            if (!t->rays) {
+                objectsAtRays.push_back(t);
+            }
+            t->rays |= 1u << r;
+        }
     }
     
-    /*
-    float minDistance = 1000000;
-    float barycentricU;
-    float barycentricV;
-    size_t triangleIndex = 0;
-    Touchable* touchable = 0;
-    Vector3 worldPosition;
-    TouchableObject* touchableObject = 0;
-    Vector3 touchNormal(0,0,0);
-    int minOrder = -1000000;
-    */
-
-    size_t max = touchableList.size() - 1;
-    for(unsigned i=0; i<touchableList.size(); i++) {
-        GameObject* object = touchableList[max - i];
-        TouchableObject* t = (TouchableObject*)this->GetMetaData(object);
-        Mesh* mesh = t->mesh;
+    meshHits.resize(objectsAtRays.size() * count);
+    for (size_t o = 0; o<objectsAtRays.size(); o++) {
+        TouchableObject* t = objectsAtRays[o];
         const Matrix4x4& worldInverse = t->transform->WorldInverse();
-        //int thisOrder = t->orderable ? t->orderable->Order.Get() : minOrder;
         
-        Ray localRay = ray;
-        localRay.Transform(worldInverse);
+        Ray localRays[Ray::MaxBatch];
+        int rayIndices[Ray::MaxBatch];
+        int localCount = 0;
+        for (int r = 0; r<count; r++) {
+            if (!(t->rays & (1u << r))) continue;
+            localRays[localCount] = rays[r];
+            localRays[localCount].Transform(worldInverse);
+            rayIndices[localCount++] = r;
+        }
+        
+        TriangleHit hits[Ray::MaxBatch];
+        unsigned hitMask = t->mesh->IntersectsRays(localRays, localCount, hits);
         
-        float distanceToPick;
-        float u;
-        float v;
-        size_t triIndex = 0;
-        Vector3 normal(0,0,0);
+        t->rays = 0;
+        t->hitsIndex = (int)(o * count);
+        for (int i = 0; i<localCount; i++) {
+            if (!(hitMask & (1u << i))) continue;
+            t->rays |= 1u << rayIndices[i];
+            meshHits[t->hitsIndex + rayIndices[i]] = hits[i];
+        }
+    }
+    
+    for (int r = 0; r<count; r++) {
+        ObjectCollection& touchableList = touchableLists[r];
+        if (touchableList.empty()) continue;
         
-        if (mesh->IntersectsRay(localRay, &distanceToPick, &u, &v, &triIndex, &normal)) {
+        size_t max = touchableList.size() - 1;
+        for(unsigned i=0; i<touchableList.size(); i++) {
+            GameObject* object = touchableList[max - i];
+            TouchableObject* t = (TouchableObject*)this->GetMetaData(object);
+            if (!(t->rays & (1u << r))) continue;
+            const TriangleHit& hit = meshHits[t->hitsIndex + r];
+            
+            Ray localRay = rays[r];
+            localRay.Transform(t->transform->WorldInverse());
+            
             Intersection intersection;
-            intersection.distanceToPick = distanceToPick;
-            intersection.u = u;
-            intersection.v = v;
-            intersection.triIndex = triIndex;
-            intersection.normal = normal;
+            intersection.distanceToPick = hit.distance;
+            intersection.u = hit.u;
+            intersection.v = hit.v;
+            intersection.triIndex = hit.triangleIndex;
+            intersection.normal = hit.normal;
             intersection.touchable = t;
             intersection.localRay = localRay;
             intersection.object = object;
             
             intersections.push_back(intersection);
-            
-            /*
-            if (distanceToPick<minDistance || thisOrder>minOrder) {
-                minOrder = thisOrder;
-                minDistance = distanceToPick;
-                barycentricU = u;
-                barycentricV = v;
-                touchable = t->touchable;
-                triangleIndex = triIndex;
-                
-                const Matrix4x4* world = t->transform->World.GetValue();
-                
-                Vector3 localPosition = localRay.GetPosition(distanceToPick);
-                worldPosition = world->TransformPosition(localPosition);
-                touchableObject = t;
-                 
-                touchNormal = normal;
-            }
-            */
         }
+        touchableList.clear();
+        
+        AddTouches(cameraObject, rays[r], events[r], lists[r], forceClickThrough);
     }
-    touchableList.clear();
     
+    for (size_t o = 0; o<objectsAtRays.size(); o++) {
+        objectsAtRays[o]->rays = 0;
+    }
+    objectsAtRays.clear();
+}
+
+void TouchSystem::AddTouches(GameObject* cameraObject, const Ray& ray, const TouchEvent& e, Touched& list, bool forceClickThrough) {
     if (intersections.empty()) return;
     
     std::sort(intersections.begin(), intersections.end(), SortIntersections);
@@ -330,7 +390,7 @@ void TouchSystem::FindTouchedObjectsFromCamera(GameObject* cameraObject, Touched
         touch.object = foundIntersection->object;
         touch.Input = &root->Input();
         touch.CameraTransform = cameraObject->GetComponent<Transform>();
-        touch.Camera = camera;
+        touch.Camera = cameraObject->GetComponent<Camera>();
         touch.Touchable = foundIntersection->touchable->touchable;
         touch.Index = e.Index;
         touch.Position = e.Position;
@@ -346,9 +406,10 @@ void TouchSystem::FindTouchedObjectsFromCamera(GameObject* cameraObject, Touched
         
         if (touch.WorldNormal.x == 0 && touch.WorldNormal.y == 0 && touch.WorldNormal.z == 0) {
             
-            Vector3 v0 = touchableObject->mesh->Position(touchableObject->mesh->Triangles()[touch.TriangleIndex  ]);
-            Vector3 v1 = touchableObject->mesh->Position(touchableObject->mesh->Triangles()[touch.TriangleIndex+1]);
-            Vector3 v2 = touchableObject->mesh->Position(touchableObject->mesh->Triangles()[touch.TriangleIndex+2]);
+            const IVertexMesh::Triangles& triangles = touchableObject->mesh->ConstTriangles();
+            Vector3 v0 = touchableObject->mesh->Position(triangles[touch.TriangleIndex  ]);
+            Vector3 v1 = touchableObject->mesh->Position(triangles[touch.TriangleIndex+1]);
+            Vector3 v2 = touchableObject->mesh->Position(triangles[touch.TriangleIndex+2]);
         
             Vector3 tan1 = v1 - v0;
             Vector3 tan2 = v2 - v0;
@@ -46,13 +46,19 @@ namespace Pocket {
         
     private:
                 
+        // Touches are picked together once all touch events of an update have arrived.
         void TouchDown(Pocket::TouchEvent e);
         void TouchUp(Pocket::TouchEvent e);
+        void TouchesUpdated();
         
         CameraSystem* cameras;
         OctreeSystem* octree;
         
-        ObjectCollection touchableList;
+        using TouchEvents = std::vector<TouchEvent>;
+        TouchEvents pendingDowns;
+        TouchEvents pendingUps;
+        
+        ObjectCollection touchableLists[Ray::MaxBatch];
         
         struct TouchableObject {
             TouchableObject(GameObject* object);
@@ -62,8 +68,14 @@ namespace Pocket {
             Touchable* touchable;
             Orderable* orderable;
             int clip;
+            // Rays at the object in the current query, then the rays hitting its mesh, and where their hits are stored.
+            unsigned rays;
+            int hitsIndex;
         };
         
+        std::vector<TouchableObject*> objectsAtRays;
+        std::vector<TriangleHit> meshHits;
+        
         using Clippers = std::vector<TouchableObject*>;
         
         Clippers clippers;
@@ -95,14 +107,22 @@ namespace Pocket {
         
         Touched equeuedDowns;
         
+        std::vector<Touched> foundTouches;
+        
     public:
         void FindTouchedObjects(Touched& list, const TouchEvent& e, bool forceClickThrough = false);
+        // Finds the objects at several touches with one query of the octree, and one test of each mesh hit by any of them.
+        // lists holds one list per touch.
+        void FindTouchedObjects(std::vector<Touched>& lists, const TouchEvents& events, bool forceClickThrough = false);
         void SetCameras(CameraSystem* cameraSystem);
         CameraSystem* GetCameras();
         CameraSystem* GetOriginalCameras();
     private:
         
-        void FindTouchedObjectsFromCamera(GameObject* cameraObject, Touched& list, const TouchEvent& e, bool forceClickThrough);
+        void FindTouchedObjects(const TouchEvent* events, Touched* lists, int count, bool forceClickThrough);
+        // Up to Ray::MaxBatch touches at once.
+        void FindTouchedObjectsFromCamera(GameObject* cameraObject, const TouchEvent* events, Touched* lists, int count, bool forceClickThrough);
+        void AddTouches(GameObject* cameraObject, const Ray& ray, const TouchEvent& e, Touched& list, bool forceClickThrough);
         using CancelledTouchables = std::set<Touchable*>;
         CancelledTouchables cancelledTouchables;
         
@@ -111,20 +111,17 @@ void PhysicsSystem2d::Update(float dt) {
     
     isSimulating = true;
     physicsWorld->Step(dt * 2, 10);
-    for (ObjectCollection::const_iterator it = Objects().begin(); it!=Objects().end(); ++it) {
-        GameObject* go = *it;
-        RigidBody2d* rigidBody = go->GetComponent<RigidBody2d>();
-        if (rigidBody->body->IsSleeping()) continue;
-        Transform* transform = go->GetComponent<Transform>();
+    ForEach([] (Transform& transform, RigidBody2d& rigidBody) {
+        if (rigidBody.body->IsSleeping()) return;
        
-        const b2Vec2 position = rigidBody->body->GetPosition();
-        float rotation = rigidBody->body->GetAngle();
-        Vector3 transformPosition = transform->Position;
+        const b2Vec2 position = rigidBody.body->GetPosition();
+        float rotation = rigidBody.body->GetAngle();
+        Vector3 transformPosition = transform.Position;
         transformPosition.x = position.x;
         transformPosition.y = position.y;
-        transform->Position = transformPosition;
-        transform->Rotation = rotation;
-    }
+        transform.Position = transformPosition;
+        transform.Rotation = rotation;
+    });
     isSimulating = false;
     
     //cout<<"Body count " << physicsWorld->GetBodyCount() << " Joint count " << physicsWorld->GetJointCount() << endl;
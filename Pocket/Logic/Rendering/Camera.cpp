@@ -12,6 +12,7 @@ Camera::Camera() {
 	Far = 512.0f;
     Orthographic = false;
     Mask = 0;
+    DepthPrePass = false;
     Viewport = {0,0,1,1};
     Aspect = 0;
 	
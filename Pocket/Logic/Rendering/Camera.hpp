@@ -24,6 +24,10 @@ namespace Pocket {
         Property<bool> Orthographic;
         
         Property<RenderMask> Mask;
+        
+        // Perspective cameras draw opaque objects into the depth buffer first, so each pixel is shaded once.
+        // Pays off when fragments are expensive, at the cost of submitting opaque geometry twice.
+        Property<bool> DepthPrePass;
     
 		DirtyProperty<Matrix4x4> Projection;
 		DirtyProperty<Matrix4x4> ProjectionInverse;
@@ -49,6 +53,7 @@ namespace Pocket {
         TYPE_FIELD(Aspect)
         TYPE_FIELD(Orthographic)
         TYPE_FIELD(Mask)
+        TYPE_FIELD(DepthPrePass)
         TYPE_FIELDS_END
 	};
 }
@@ -10,6 +10,8 @@
 #include "VertexMesh.hpp"
 #include "BoundingBox.hpp"
 #include "DirtyProperty.hpp"
+#include "MeshBuffer.hpp"
+#include "TriangleTree.hpp"
 
 namespace Pocket {
 
@@ -26,10 +28,11 @@ struct MeshIntersector {
 struct Mesh {
 public:
     
-    Mesh() : vertexMesh(0), vertexType(0), customIntersector(0) { }
-    ~Mesh() { delete vertexMesh; }
+    Mesh() : customIntersector(0), vertexMesh(0), vertexType(0), version(1), buffer(0), triangleTree(0), pickedVersion(0) { }
+    ~Mesh() { delete vertexMesh; delete buffer; delete triangleTree; }
     
     void operator=(const Mesh& other) {
+        version++;
         if (other.vertexMesh) {
             vertexMesh = other.vertexMesh->Clone();
             vertexType = other.vertexType;
@@ -53,6 +56,7 @@ public:
         }
         VertexMesh<Vertex>& mesh = *((VertexMesh<Vertex>*)vertexMesh);
         LocalBoundingBox.MakeDirty();
+        version++;
         return mesh;
     }
 
@@ -71,15 +75,49 @@ public:
     
     int VertexType() { return vertexType; }
     
-    IVertexMesh::Triangles& Triangles() { return vertexMesh->triangles; }
+    IVertexMesh::Triangles& Triangles() { version++; return vertexMesh->triangles; }
+    const IVertexMesh::Triangles& ConstTriangles() const { return vertexMesh->triangles; }
     DirtyProperty<BoundingBox> LocalBoundingBox;
 
+    // Meshes with many triangles are tested against a TriangleTree, built when the mesh is picked a second time without having changed.
     bool IntersectsRay(const Ray& ray, float* pickDistance, float* barycentricU, float* barycentricV, size_t* triangleIndex, Vector3* normal) {
         if (customIntersector) {
             return customIntersector->IntersectsRay(*this, ray, pickDistance, barycentricU, barycentricV, triangleIndex, normal);
         }
         if (!vertexMesh) return false;
-        return vertexMesh->IntersectsRay(ray, pickDistance, barycentricU, barycentricV, triangleIndex, normal);
+        const TriangleTree* tree = Tree();
+        if (!tree) {
+            return vertexMesh->IntersectsRay(ray, pickDistance, barycentricU, barycentricV, triangleIndex, normal);
+        }
+        TriangleHit hit;
+        if (!tree->IntersectsRay(ray, hit)) return false;
+        *pickDistance = hit.distance;
+        *barycentricU = hit.u;
+        *barycentricV = hit.v;
+        *triangleIndex = hit.triangleIndex;
+        return true;
+    }
+
+    // Tests up to Ray::MaxBatch rays, hits holds one entry per ray. Returns a mask of the rays which hit the mesh.
+    // The TriangleTree is looked up once, and walked for each ray, as touch rays rarely share enough of it to walk it together.
+    unsigned IntersectsRays(const Ray* rays, int count, TriangleHit* hits) {
+        if (count>Ray::MaxBatch) count = Ray::MaxBatch;
+        const TriangleTree* tree = !customIntersector && vertexMesh ? Tree() : 0;
+        unsigned mask = 0;
+        for (int i=0; i<count; ++i) {
+            TriangleHit& hit = hits[i];
+            hit.normal = Vector3(0,0,0);
+            bool intersects;
+            if (tree) {
+                intersects = tree->IntersectsRay(rays[i], hit);
+            } else if (customIntersector) {
+                intersects = customIntersector->IntersectsRay(*this, rays[i], &hit.distance, &hit.u, &hit.v, &hit.triangleIndex, &hit.normal);
+            } else {
+                intersects = vertexMesh && vertexMesh->IntersectsRay(rays[i], &hit.distance, &hit.u, &hit.v, &hit.triangleIndex, &hit.normal);
+            }
+            if (intersects) mask |= 1u << i;
+        }
+        return mask;
     }
 
     MeshIntersector* customIntersector;
@@ -92,9 +130,26 @@ public:
     
     void Clear() {
         if (!vertexMesh) return;
+        version++;
         vertexMesh->Clear();
     }
     
+    // Incremented whenever the mesh is accessed for modification.
+    unsigned Version() const { return version; }
+    
+    // Gpu buffers for rendering the mesh untransformed, uploaded again when the mesh has changed.
+    template<class Vertex>
+    MeshBuffer& StaticBuffer() {
+        if (!buffer) {
+            buffer = new MeshBuffer();
+        }
+        if (buffer->version != version) {
+            buffer->Upload(ConstMesh<Vertex>());
+            buffer->version = version;
+        }
+        return *buffer;
+    }
+    
     //template<class T>
     VertexMesh<class Vertex>::Vertices& Vertices() {
         return GetMesh<Vertex>().vertices;
@@ -112,6 +167,28 @@ public:
 private:
     IVertexMesh* vertexMesh;
     int vertexType;
+    unsigned version;
+    MeshBuffer* buffer;
+    TriangleTree* triangleTree;
+    unsigned pickedVersion;
+
+    static const size_t MinTrianglesInTree = 64;
+
+    // Brute force is faster for few triangles, and for meshes changing between picks.
+    const TriangleTree* Tree() {
+        if (vertexMesh->triangles.size()<MinTrianglesInTree * 3) return 0;
+        if (triangleTree && triangleTree->version == version) return triangleTree;
+        if (pickedVersion != version) {
+            pickedVersion = version;
+            return 0;
+        }
+        if (!triangleTree) {
+            triangleTree = new TriangleTree();
+        }
+        triangleTree->Build(*vertexMesh);
+        triangleTree->version = version;
+        return triangleTree;
+    }
     
     friend class RenderSystem;
 };
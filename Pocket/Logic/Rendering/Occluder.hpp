@@ -0,0 +1,26 @@
+//
+//  Occluder.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "Property.hpp"
+#include "TypeInfo.hpp"
+#include "Camera.hpp"
+
+namespace Pocket {
+    // Marks the Mesh of the object as an occluder, see RenderSystem::SetOcclusionCulling.
+    // The mesh is drawn solid from both sides, so it should be a few triangles lying within the surfaces it stands for,
+    // like a box inside a wall. Only cameras whose mask contains the mask of the occluder use it.
+    struct Occluder {
+        Occluder() { Mask = 0; }
+        Property<RenderMask> Mask;
+
+        TYPE_FIELDS_BEGIN
+        TYPE_FIELD(Mask)
+        TYPE_FIELDS_END
+    };
+}
@@ -9,17 +9,77 @@
 #include "RenderSystem.hpp"
 #include "Engine.hpp"
 #include "ShaderComponent.hpp"
+#include "Timer.hpp"
+#include <algorithm>
+#include <cmath>
 
 using namespace Pocket;
 
 RenderSystem::ObjectRenderers RenderSystem::objectRenderers;
 int RenderSystem::objectRenderersRefCounter = 0;
 
+RenderSystem::RenderSystem() :
+passCount(0), preparedVersion(0), preparedPasses(0), jobSystem(&JobSystem::Default()),
+version(1), octreeVersion(0), opaqueOrder(OpaqueOrder::State), frameStats(), gpuTiming(false),
+occlusionCulling(false), occlusionWidth(256), occlusionHeight(128), cameras(0), occluders(0), meshOctreeSystem(0) { }
+
+template<typename Component>
+void RenderSystem::MaterialSystem<Component>::Initialize() {
+    renderSystem = this->root->template CreateSystem<RenderSystem>();
+}
+
+template<typename Component>
+void RenderSystem::MaterialSystem<Component>::ObjectAdded(GameObject *) {
+    renderSystem->InvalidateVisibility();
+}
+
+template<typename Component>
+void RenderSystem::MaterialSystem<Component>::ObjectRemoved(GameObject *) {
+    renderSystem->InvalidateVisibility();
+}
+
+void RenderSystem::OrderableSystem::ObjectAdded(GameObject *object) {
+    object->GetComponent<Orderable>()->Order.Changed.Bind(renderSystem, &RenderSystem::InvalidateVisibility);
+    renderSystem->InvalidateVisibility();
+}
+
+void RenderSystem::OrderableSystem::ObjectRemoved(GameObject *object) {
+    object->GetComponent<Orderable>()->Order.Changed.Unbind(renderSystem, &RenderSystem::InvalidateVisibility);
+    renderSystem->InvalidateVisibility();
+}
+
+void RenderSystem::OccluderSystem::Initialize() {
+    renderSystem = root->CreateSystem<RenderSystem>();
+}
+
+void RenderSystem::OccluderSystem::ObjectAdded(GameObject *object) {
+    object->GetComponent<Transform>()->World.HasBecomeDirty.Bind(renderSystem, &RenderSystem::InvalidateVisibility);
+    object->GetComponent<Mesh>()->LocalBoundingBox.HasBecomeDirty.Bind(renderSystem, &RenderSystem::InvalidateVisibility);
+    object->GetComponent<Occluder>()->Mask.Changed.Bind(renderSystem, &RenderSystem::InvalidateVisibility);
+    renderSystem->InvalidateVisibility();
+}
+
+void RenderSystem::OccluderSystem::ObjectRemoved(GameObject *object) {
+    object->GetComponent<Transform>()->World.HasBecomeDirty.Unbind(renderSystem, &RenderSystem::InvalidateVisibility);
+    object->GetComponent<Mesh>()->LocalBoundingBox.HasBecomeDirty.Unbind(renderSystem, &RenderSystem::InvalidateVisibility);
+    object->GetComponent<Occluder>()->Mask.Changed.Unbind(renderSystem, &RenderSystem::InvalidateVisibility);
+    renderSystem->InvalidateVisibility();
+}
+
 void RenderSystem::Initialize() {
     
+    // component ids are assigned on first use, which must not happen inside the render jobs
+    GameIdHelper::GetComponentID<ShaderComponent>();
+    GameIdHelper::GetComponentID<TextureComponent>();
+    GameIdHelper::GetComponentID<Orderable>();
+    
     cameras = root->CreateSystem<CameraSystem>();
+    occluders = root->CreateSystem<OccluderSystem>();
     meshOctreeSystem = root->CreateSystem<OctreeSystem>();
     root->CreateSystem<TextureSystem>();
+    root->CreateSystem<MaterialSystem<ShaderComponent>>();
+    root->CreateSystem<MaterialSystem<TextureComponent>>();
+    root->CreateSystem<OrderableSystem>();
 
     Shaders.Initialize();
     DefaultShader = &Shaders.Colored;
@@ -44,7 +104,25 @@ void RenderSystem::Destroy() {
 }
 
 void RenderSystem::ObjectAdded(GameObject *object) {
+    Renderable* renderable = object->GetComponent<Renderable>();
+    renderable->BlendMode.Changed.Bind(this, &RenderSystem::InvalidateVisibility);
+    renderable->Mask.Changed.Bind(this, &RenderSystem::InvalidateVisibility);
+    renderable->Clip.Changed.Bind(this, &RenderSystem::InvalidateVisibility);
+    renderable->Static.Changed.Bind(this, &RenderSystem::InvalidateVisibility);
+    InvalidateVisibility();
+}
 
+void RenderSystem::ObjectRemoved(GameObject *object) {
+    Renderable* renderable = object->GetComponent<Renderable>();
+    renderable->BlendMode.Changed.Unbind(this, &RenderSystem::InvalidateVisibility);
+    renderable->Mask.Changed.Unbind(this, &RenderSystem::InvalidateVisibility);
+    renderable->Clip.Changed.Unbind(this, &RenderSystem::InvalidateVisibility);
+    renderable->Static.Changed.Unbind(this, &RenderSystem::InvalidateVisibility);
+    InvalidateVisibility();
+}
+
+void RenderSystem::InvalidateVisibility() {
+    version++;
 }
 
 RenderSystem::OctreeSystem& RenderSystem::Octree() {
@@ -52,32 +130,249 @@ RenderSystem::OctreeSystem& RenderSystem::Octree() {
 }
 
 void RenderSystem::RenderCamera(GameObject* cameraObject) {
-    Transform* cameraTransform = cameraObject->GetComponent<Transform>();
-    Camera* camera = cameraObject->GetComponent<Camera>();
-    RenderMask cameraMask = camera->Mask;
-    //if (!camera->Orthographic()) {
-        const Rect& viewport = camera->Viewport;
-        const Vector2& screenSize = Engine::Context().ScreenSize * Engine::Context().ScreenScalingFactor;
-        Rect screenRect = viewport * screenSize;
-        glViewport(screenRect.x, screenRect.y, screenRect.width, screenRect.height);
-    //}
+    RenderCameras(&cameraObject, 1);
+}
+
+void RenderSystem::RenderCameras(GameObject* const* cameraObjects, int count) {
+    Timer frameTimer;
+    frameTimer.Begin();
+    passCount = count;
+    frameStats.cameras = count;
+    frameStats.prepareTime = 0;
+    frameStats.total.Clear();
+    if (count == 0) {
+        frameStats.frameTime = frameTimer.End();
+        return;
+    }
     
-    const Matrix4x4 viewProjection = camera->Projection().Multiply(cameraTransform->WorldInverse);
+    // Camera matrices and moved octree nodes are resolved up front,
+    // so the jobs below only read components.
+    meshOctreeSystem->UpdateAllNodes();
+    if (meshOctreeSystem->Version() != octreeVersion) {
+        octreeVersion = meshOctreeSystem->Version();
+        InvalidateVisibility();
+    }
+    if ((int)passes.size()<count) {
+        passes.resize(count);
+    }
+    changedPasses.clear();
+    for(int i=0; i<count; ++i) {
+        if (SetupPass(passes[i], cameraObjects[i])) {
+            changedPasses.push_back(i);
+        }
+    }
+    
+    if (!changedPasses.empty()) {
+        BuildPasses();
+    }
+    
+    if (!IsPrepared(count)) {
+        Timer prepareTimer;
+        prepareTimer.Begin();
+        PrepareVertices(count);
+        frameStats.prepareTime = prepareTimer.End();
+    }
     
-    BoundingFrustum frustum;
-    frustum.SetFromViewProjection(viewProjection);
-    meshOctreeSystem->GetObjectsInFrustum(frustum, objectsInFrustum);
+    const int objects = (int)meshOctreeSystem->Objects().size();
+    for(int i=0; i<count; ++i) {
+        CameraPass& pass = passes[i];
+        Timer submitTimer;
+        submitTimer.Begin();
+        SubmitPass(pass);
+        pass.stats.submitTime = submitTimer.End();
+        pass.stats.objects = objects;
+        for(int p=0; p<CameraStats::PassCount; ++p) {
+            frameStats.total.Add(pass.stats.passes[p]);
+        }
+    }
+    frameStats.frameTime = frameTimer.End();
+}
 
-    if (objectsInFrustum.empty()) return;
+// Only passes whose camera or scene changed since their last frame are culled and sorted again.
+void RenderSystem::BuildPasses() {
+    if (occlusionCulling) {
+        RasterizeOccluders();
+    }
     
-    const float* viewProjectionGL = viewProjection.GetGlMatrix();
+    int passCount = (int)changedPasses.size();
+    ParallelFor(passCount, 1, [this] (int begin, int end) {
+        for(int i=begin; i<end; ++i) {
+            CameraPass& pass = passes[changedPasses[i]];
+            Timer timer;
+            timer.Begin();
+            meshOctreeSystem->QueryFrustum(pass.frustum, pass.objectsInFrustum, &pass.lastPlanes, occlusionCulling ? &pass.occlusion : 0);
+            pass.visibleObjects.resize(pass.objectsInFrustum.size());
+            pass.stats.cullTime = timer.End();
+            pass.stats.inFrustum = (int)pass.objectsInFrustum.size();
+        }
+    });
     
-    for (auto renderer : objectRenderers) {
-        renderer->viewProjection = viewProjectionGL;
+    const int chunkSize = 512;
+    int chunkCount = 0;
+    for(int passIndex : changedPasses) {
+        int objects = (int)passes[passIndex].objectsInFrustum.size();
+        for(int begin = 0; begin<objects; begin+=chunkSize) {
+            if ((int)chunks.size()<=chunkCount) {
+                chunks.emplace_back();
+            }
+            Chunk& chunk = chunks[chunkCount++];
+            chunk.pass = passIndex;
+            chunk.begin = begin;
+            chunk.end = begin + chunkSize < objects ? begin + chunkSize : objects;
+        }
+    }
+    
+    ParallelFor(chunkCount, 1, [this] (int begin, int end) {
+        for(int i=begin; i<end; ++i) {
+            BuildVisibleObjects(chunks[i]);
+        }
+    });
+    
+    // chunks are merged in order, keeping equal keys in frustum order
+    for(int i=0; i<chunkCount; ++i) {
+        const Chunk& chunk = chunks[i];
+        CameraPass& pass = passes[chunk.pass];
+        pass.opaqueQueue.Append(chunk.opaqueQueue);
+        pass.transparentQueue.Append(chunk.transparentQueue);
+        pass.overdraw.opaque += chunk.opaqueCoverage;
+        pass.overdraw.transparent += chunk.transparentCoverage;
+        pass.hasClipping |= chunk.hasClipping;
+        pass.stats.buildTime += chunk.buildTime;
+    }
+    
+    ParallelFor(passCount, 1, [this] (int begin, int end) {
+        for(int i=begin; i<end; ++i) {
+            CameraPass& pass = passes[changedPasses[i]];
+            Timer timer;
+            timer.Begin();
+            pass.opaqueQueue.Sort();
+            pass.transparentQueue.Sort();
+            pass.stats.sortTime = timer.End();
+            pass.stats.visible = (int)(pass.opaqueQueue.Size() + pass.transparentQueue.Size());
+        }
+    });
+}
+
+// Occluders are transformed and binned on the calling thread, which also resolves their world matrices and bounds,
+// the tiles of all changed passes are then rasterized as jobs.
+void RenderSystem::RasterizeOccluders() {
+    occludedPasses.clear();
+    for(int passIndex : changedPasses) {
+        CameraPass& pass = passes[passIndex];
+        Timer timer;
+        timer.Begin();
+        pass.occlusion.Begin(occlusionWidth, occlusionHeight, pass.viewProjection);
+        for(GameObject* object : occluders->Objects()) {
+            RenderMask mask = object->GetComponent<Occluder>()->Mask;
+            if (!((pass.mask & mask) == mask)) continue;
+            Mesh* mesh = object->GetComponent<Mesh>();
+            if (!mesh->vertexMesh) continue;
+            const Matrix4x4& world = object->GetComponent<Transform>()->World;
+            BoundingBox worldBox;
+            mesh->LocalBoundingBox().CreateWorldAligned(world, worldBox);
+            if (pass.frustum.Intersect(worldBox) == BoundingFrustum::OUTSIDE) continue;
+            const size_t count = mesh->vertexMesh->Size();
+            occluderPositions.resize(count);
+            for(size_t i=0; i<count; ++i) {
+                occluderPositions[i] = mesh->vertexMesh->GetPosition(i);
+            }
+            const IVertexMesh::Triangles& triangles = mesh->vertexMesh->triangles;
+            pass.occlusion.AddTriangles(world, occluderPositions.data(), count, triangles.data(), triangles.size());
+        }
+        pass.stats.occlusionTime = timer.End();
+        pass.stats.occluderTriangles = (int)pass.occlusion.Triangles();
+        if (!pass.occlusion.IsEmpty()) {
+            occludedPasses.push_back(passIndex);
+        }
     }
     
+    if (occludedPasses.empty()) return;
+    const int tileCount = passes[occludedPasses[0]].occlusion.TileCount();
+    tileTimes.resize(occludedPasses.size() * tileCount);
+    ParallelFor((int)tileTimes.size(), 4, [this, tileCount] (int begin, int end) {
+        for(int i=begin; i<end; ++i) {
+            Timer timer;
+            timer.Begin();
+            passes[occludedPasses[i / tileCount]].occlusion.RasterizeTile(i % tileCount);
+            tileTimes[i] = timer.End();
+        }
+    });
+    for(size_t i=0; i<tileTimes.size(); ++i) {
+        passes[occludedPasses[i / tileCount]].stats.occlusionTime += tileTimes[i];
+    }
+}
+
+// Returns true when the pass has to be rebuilt, the visible set only depends on
+// the view projection, the camera mask and the scene.
+bool RenderSystem::SetupPass(CameraPass& pass, GameObject* cameraObject) {
+    Transform* cameraTransform = cameraObject->GetComponent<Transform>();
+    Camera* camera = cameraObject->GetComponent<Camera>();
+    const Rect& viewport = camera->Viewport;
+    const Vector2& screenSize = Engine::Context().ScreenSize * Engine::Context().ScreenScalingFactor;
+    pass.camera = cameraObject;
+    pass.screenRect = viewport * screenSize;
+    pass.wantsDepthPrePass = camera->DepthPrePass() && !camera->Orthographic();
+    pass.stats.rebuilt = false;
+    pass.stats.cullTime = 0;
+    pass.stats.occlusionTime = 0;
+    pass.stats.buildTime = 0;
+    pass.stats.sortTime = 0;
+    const Matrix4x4 viewProjection = camera->Projection().Multiply(cameraTransform->WorldInverse);
+    RenderMask mask = camera->Mask;
+    if (pass.version == version && pass.mask == mask && pass.viewProjection == viewProjection) {
+        return false;
+    }
+    pass.version = version;
+    pass.mask = mask;
+    pass.viewProjection = viewProjection;
+    pass.frustum.SetFromViewProjection(pass.viewProjection);
+    pass.objectsInFrustum.clear();
+    pass.opaqueQueue.Clear();
+    pass.transparentQueue.Clear();
+    pass.overdraw.opaque = 0.0f;
+    pass.overdraw.transparent = 0.0f;
+    pass.hasClipping = false;
+    pass.stats.rebuilt = true;
+    pass.stats.inFrustum = 0;
+    pass.stats.visible = 0;
+    pass.stats.occluderTriangles = 0;
+    return true;
+}
+
+static inline float ProjectExtents(const float* row, const Vector3& extents) {
+    return std::abs(row[0]) * extents.x + std::abs(row[1]) * extents.y + std::abs(row[2]) * extents.z;
+}
+
+// Fraction of the screen covered by a world aligned box, from the screen rectangle around its projection at its center depth.
+static float ScreenCoverage(const Matrix4x4& viewProjection, const Vector3& center, const Vector3& halfExtents) {
+    float w = viewProjection[3][0] * center.x + viewProjection[3][1] * center.y + viewProjection[3][2] * center.z + viewProjection[3][3];
+    if (w - ProjectExtents(viewProjection[3], halfExtents)<=0.0f) return 1.0f; // the box reaches the camera plane
+    float invW = 1.0f / w;
+    float x = (viewProjection[0][0] * center.x + viewProjection[0][1] * center.y + viewProjection[0][2] * center.z + viewProjection[0][3]) * invW;
+    float y = (viewProjection[1][0] * center.x + viewProjection[1][1] * center.y + viewProjection[1][2] * center.z + viewProjection[1][3]) * invW;
+    float sizeX = ProjectExtents(viewProjection[0], halfExtents) * invW;
+    float sizeY = ProjectExtents(viewProjection[1], halfExtents) * invW;
+    float width = std::min(x + sizeX, 1.0f) - std::max(x - sizeX, -1.0f);
+    float height = std::min(y + sizeY, 1.0f) - std::max(y - sizeY, -1.0f);
+    if (width<=0.0f || height<=0.0f) return 0.0f;
+    return width * height * 0.25f;
+}
+
+void RenderSystem::BuildVisibleObjects(Chunk& chunk) {
+    Timer timer;
+    timer.Begin();
+    CameraPass& pass = passes[chunk.pass];
+    const Matrix4x4& viewProjection = pass.viewProjection;
+    RenderMask cameraMask = pass.mask;
+    chunk.opaqueQueue.Clear();
+    chunk.transparentQueue.Clear();
+    chunk.opaqueCoverage = 0.0f;
+    chunk.transparentCoverage = 0.0f;
+    chunk.hasClipping = false;
+    
     Vector3 distanceToCameraPosition;
-    for(auto object : objectsInFrustum) {
+    for(int i = chunk.begin; i<chunk.end; ++i) {
+        GameObject* object = pass.objectsInFrustum[i];
         
         Renderable* renderable = object->GetComponent<Renderable>();
         RenderMask mask = renderable->Mask;
@@ -97,8 +392,6 @@ void RenderSystem::RenderCamera(GameObject* cameraObject) {
         float fInvW = 1.0f / ( viewProjection[3][0] * distanceToCameraPosition.x + viewProjection[3][1] * distanceToCameraPosition.y + viewProjection[3][2] * distanceToCameraPosition.z + viewProjection[3][3] );
         float distanceToCamera = ( viewProjection[2][0] * distanceToCameraPosition.x + viewProjection[2][1] * distanceToCameraPosition.y + viewProjection[2][2] * distanceToCameraPosition.z + viewProjection[2][3] ) * fInvW;
         
-        VisibleObjects& visibleObjects = renderable->BlendMode() == BlendModeType::Opaque ? opaqueObjects : transparentObjects;
-        
         IShader* shader = 0;
         ShaderComponent* shaderComponent = object->GetComponent<ShaderComponent>();
         TextureComponent* textureComponent = object->GetComponent<TextureComponent>();
@@ -109,126 +402,317 @@ void RenderSystem::RenderCamera(GameObject* cameraObject) {
             shader = textureComponent ? &Shaders.Textured : &Shaders.Colored;
         }
         
-        visibleObjects.push_back({
+        Orderable* orderable = object->GetComponent<Orderable>();
+        int order = orderable ? orderable->Order() : 0;
+        
+        VisibleObject& visibleObject = pass.visibleObjects[i];
+        visibleObject = {
             transform,
             renderable,
             shader,
             mesh,
             mesh->VertexType(),
             textureComponent,
-            object->GetComponent<Orderable>(),
-            distanceToCamera
-        });
+            orderable,
+            distanceToCamera,
+            VisibleObject::NotPrepared
+        };
+        
+        // bounds are clean, the octree read them when the object last moved
+        const BoundingBox& localBox = mesh->LocalBoundingBox();
+        const Vector3 localHalfExtents = localBox.extends * 0.5f;
+        const Vector3 center = world.TransformPositionAffine(localBox.center);
+        const Vector3 halfExtents(ProjectExtents(world[0], localHalfExtents),
+                                  ProjectExtents(world[1], localHalfExtents),
+                                  ProjectExtents(world[2], localHalfExtents));
+        float coverage = ScreenCoverage(viewProjection, center, halfExtents);
+        
+        if (renderable->BlendMode() == BlendModeType::Opaque) {
+            // keyed by the bound texture, so objects packed into the same page are grouped
+            const void* texture = textureComponent ? &textureComponent->Texture() : 0;
+            uint32_t shaderId = SortId(shader, RenderQueue::MaxShaders);
+            uint32_t textureId = SortId(texture, RenderQueue::MaxTextures);
+            uint64_t key = opaqueOrder == OpaqueOrder::FrontToBack ?
+                RenderQueue::FrontToBackKey(order, mesh->VertexType(), shaderId, textureId, visibleObject.DrawsStatic(), distanceToCamera) :
+                RenderQueue::OpaqueKey(order, mesh->VertexType(), shaderId, textureId, visibleObject.DrawsStatic(), distanceToCamera);
+            chunk.opaqueQueue.Add(key, (uint32_t)i);
+            chunk.opaqueCoverage += coverage;
+            chunk.hasClipping |= renderable->Clip != 0;
+        } else {
+            chunk.transparentQueue.Add(RenderQueue::TransparentKey(order, distanceToCamera), (uint32_t)i);
+            chunk.transparentCoverage += coverage;
+        }
+    }
+    chunk.buildTime = timer.End();
+}
+
+// Vertices of all dynamic objects in all passes get their own range in the renderers,
+// and are transformed by the jobs before any gl calls are made.
+void RenderSystem::PrepareVertices(int passCount) {
+    std::vector<size_t>& offsets = preparedOffsets;
+    offsets.assign(objectRenderers.size(), 0);
+    preparedObjects.clear();
+    for(int i=0; i<passCount; ++i) {
+        CameraPass& pass = passes[i];
+        for(int q=0; q<2; ++q) {
+            const RenderQueue& queue = q == 0 ? pass.opaqueQueue : pass.transparentQueue;
+            for(auto& item : queue.Sorted()) {
+                VisibleObject& visibleObject = pass.visibleObjects[item.index];
+                if (visibleObject.DrawsStatic()) continue;
+                size_t& offset = offsets[visibleObject.vertexType];
+                visibleObject.preparedVertex = (uint32_t)offset;
+                offset += visibleObject.mesh->VerticesSize();
+                preparedObjects.push_back(&visibleObject);
+            }
+        }
+    }
+    preparedVersion = version;
+    preparedPasses = passCount;
+    if (preparedObjects.empty()) return;
+    
+    for(size_t i=0; i<objectRenderers.size(); ++i) {
+        objectRenderers[i]->ReservePrepared(offsets[i]);
+        objectRenderers[i]->preparedOwner = this;
+    }
+    
+    ParallelFor((int)preparedObjects.size(), 256, [this] (int begin, int end) {
+        for(int i=begin; i<end; ++i) {
+            const VisibleObject& visibleObject = *preparedObjects[i];
+            objectRenderers[visibleObject.vertexType]->PrepareObject(visibleObject);
+        }
+    });
+}
+
+// Prepared vertices stay valid until a pass is rebuilt, or another render system uses the renderers.
+bool RenderSystem::IsPrepared(int passCount) const {
+    if (preparedVersion != version || passCount > preparedPasses || changedPasses.size()>0) return false;
+    if (preparedObjects.empty()) return true;
+    for (auto renderer : objectRenderers) {
+        if (renderer->preparedOwner != this) return false;
+    }
+    return true;
+}
+
+void RenderSystem::SubmitPass(CameraPass& pass) {
+    CameraStats& stats = pass.stats;
+    for(int p=0; p<CameraStats::PassCount; ++p) {
+        stats.passes[p].Clear();
+    }
+    stats.vertexTypes.assign(objectRenderers.size(), RenderInfo());
+    stats.gpuTime = gpuTiming && pass.gpuTimer ? pass.gpuTimer->Elapsed() : -1.0;
+    
+    const Rect& screenRect = pass.screenRect;
+    glViewport(screenRect.x, screenRect.y, screenRect.width, screenRect.height);
+    
+    if (pass.opaqueQueue.Empty() && pass.transparentQueue.Empty()) return;
+    
+    if (gpuTiming) {
+        if (!pass.gpuTimer) {
+            pass.gpuTimer.reset(new GpuTimer());
+        }
+        pass.gpuTimer->Begin();
+    }
+    
+    const float* viewProjectionGL = pass.viewProjection.GetGlMatrix();
+    
+    clipper.SetView(pass.viewProjection, screenRect);
+    for (auto renderer : objectRenderers) {
+        renderer->viewProjection = viewProjectionGL;
+        renderer->viewProjectionMatrix = pass.viewProjection;
+        renderer->clipper = &clipper;
     }
-    objectsInFrustum.clear();
     
     glEnable(GL_DEPTH_TEST);
     
-    if (!opaqueObjects.empty()) {
-        std::sort(opaqueObjects.begin(), opaqueObjects.end(), SortOpaqueObjects);
+    // the clipper toggles color writes itself, so passes with clipping draw without the pre pass
+    pass.overdraw.depthPrePass = pass.wantsDepthPrePass && !pass.hasClipping && !pass.opaqueQueue.Empty();
+    
+    if (pass.overdraw.depthPrePass) {
+        glDisable(GL_BLEND);
+        glDepthMask(true);
+        glColorMask(false, false, false, false);
+        RenderVisibleObjects(pass.visibleObjects, pass.opaqueQueue, stats, stats.passes[CameraStats::DepthPrePass]);
+        glColorMask(true, true, true, true);
+        glDepthFunc(GL_LEQUAL);
+        glDepthMask(false);
+        RenderVisibleObjects(pass.visibleObjects, pass.opaqueQueue, stats, stats.passes[CameraStats::Opaque]);
+        glDepthFunc(GL_LESS);
+        glDepthMask(true);
+    } else if (!pass.opaqueQueue.Empty()) {
         glDisable(GL_BLEND);
         glDepthMask(true);
-        RenderVisibleObjects(opaqueObjects);
-        opaqueObjects.clear();
+        RenderVisibleObjects(pass.visibleObjects, pass.opaqueQueue, stats, stats.passes[CameraStats::Opaque]);
     }
     
-    if (!transparentObjects.empty()) {
-        
-        std::sort(transparentObjects.begin(), transparentObjects.end(), SortTransparentObjects);
+    if (!pass.transparentQueue.Empty()) {
         
         glEnable(GL_BLEND);
         glDepthMask(false);
         //clipper.UseDepth = false;
         
-        RenderTransparentVisibleObjects(transparentObjects);
+        RenderTransparentVisibleObjects(pass.visibleObjects, pass.transparentQueue, stats, stats.passes[CameraStats::Transparent]);
         glDepthMask(true);
-        transparentObjects.clear();
     }
+    
+    if (gpuTiming) {
+        pass.gpuTimer->End();
+    }
+}
+
+void RenderSystem::EndRenderer(int vertexType, CameraStats& stats, RenderInfo& passInfo) {
+    RenderInfo info;
+    objectRenderers[vertexType]->End(info);
+    passInfo.Add(info);
+    stats.vertexTypes[vertexType].Add(info);
 }
 
-void RenderSystem::RenderVisibleObjects(const VisibleObjects& visibleObjects) {
-    int currentVertexType = visibleObjects[0].vertexType;
+void RenderSystem::RenderVisibleObjects(const VisibleObjects& visibleObjects, const RenderQueue& queue, CameraStats& stats, RenderInfo& passInfo) {
+    const RenderQueue::Items& items = queue.Sorted();
+    int currentVertexType = visibleObjects[items[0].index].vertexType;
     objectRenderers[currentVertexType]->Begin(false);
-    objectRenderers[currentVertexType]->RenderObject(visibleObjects[0]);
-    for (size_t i=1; i<visibleObjects.size(); ++i) {
-        const VisibleObject& visibleObject = visibleObjects[i];
+    objectRenderers[currentVertexType]->RenderObject(visibleObjects[items[0].index]);
+    for (size_t i=1; i<items.size(); ++i) {
+        const VisibleObject& visibleObject = visibleObjects[items[i].index];
         if (currentVertexType!=visibleObject.vertexType) {
-            objectRenderers[currentVertexType]->End(renderInfo);
+            EndRenderer(currentVertexType, stats, passInfo);
             currentVertexType = visibleObject.vertexType;
             objectRenderers[currentVertexType]->Begin(false);
         }
         objectRenderers[currentVertexType]->RenderObject(visibleObject);
     }
-    objectRenderers[currentVertexType]->End(renderInfo);
+    EndRenderer(currentVertexType, stats, passInfo);
+    clipper.Reset();
 }
 
-void RenderSystem::RenderTransparentVisibleObjects(const VisibleObjects& visibleObjects) {
-    int currentVertexType = visibleObjects[0].vertexType;
+void RenderSystem::RenderTransparentVisibleObjects(const VisibleObjects& visibleObjects, const RenderQueue& queue, CameraStats& stats, RenderInfo& passInfo) {
+    const RenderQueue::Items& items = queue.Sorted();
+    int currentVertexType = visibleObjects[items[0].index].vertexType;
     objectRenderers[currentVertexType]->Begin(true);
-    objectRenderers[currentVertexType]->RenderTransparentObject(visibleObjects[0]);
-    for (size_t i=1; i<visibleObjects.size(); ++i) {
-        const VisibleObject& visibleObject = visibleObjects[i];
+    objectRenderers[currentVertexType]->RenderTransparentObject(visibleObjects[items[0].index]);
+    for (size_t i=1; i<items.size(); ++i) {
+        const VisibleObject& visibleObject = visibleObjects[items[i].index];
         if (currentVertexType!=visibleObject.vertexType) {
-            objectRenderers[currentVertexType]->End(renderInfo);
+            EndRenderer(currentVertexType, stats, passInfo);
             currentVertexType = visibleObject.vertexType;
             objectRenderers[currentVertexType]->Begin(true);
         }
         objectRenderers[currentVertexType]->RenderTransparentObject(visibleObject);
     }
-    objectRenderers[currentVertexType]->End(renderInfo);
+    EndRenderer(currentVertexType, stats, passInfo);
+    clipper.Reset();
 }
 
 void RenderSystem::Render() {
-    renderInfo.drawCalls = 0;
-    renderInfo.verticesRendered = 0;
-    renderInfo.objectsRendered = 0;
-    for(auto camera : cameras->Objects()) {
-        RenderCamera(camera);
+    const auto& cameraObjects = cameras->Objects();
+    RenderCameras(cameraObjects.data(), (int)cameraObjects.size());
+}
+
+uint32_t RenderSystem::SortId(const void* pointer, uint32_t maxIds) {
+    // objects sharing an id are still drawn correctly, but may not be grouped
+    uint64_t hash = ((uint64_t)(size_t)pointer >> 4) * 0x9E3779B97F4A7C15ull;
+    return (uint32_t)(hash >> 32) & (maxIds - 1);
+}
+
+void RenderSystem::ParallelFor(int count, int batchSize, const JobSystem::RangeJob& job) {
+    if (!jobSystem) {
+        job(0, count);
+        return;
     }
-    
-    /*static int counter = 0;
-    if (counter++%300==0) {
-        std::cout<<"Draw calls : " << renderInfo.drawCalls<< ", Vertices Rendered : " << renderInfo.verticesRendered<<", Objects rendered : "<< renderInfo.objectsRendered<<std::endl;
-    }*/
+    jobSystem->ParallelFor(count, batchSize, job);
 }
 
-bool RenderSystem::SortOpaqueObjects(const VisibleObject& a, const VisibleObject& b) {
+void RenderSystem::SetOpaqueOrder(OpaqueOrder order) {
+    if (opaqueOrder == order) return;
+    opaqueOrder = order;
+    InvalidateVisibility();
+}
 
-    if (a.orderable && b.orderable) {
-        int orderA = a.orderable->Order();
-        int orderB = b.orderable->Order();
-        if (orderA!=orderB) {
-            return orderA<orderB;
-        }
+RenderSystem::OpaqueOrder RenderSystem::GetOpaqueOrder() const { return opaqueOrder; }
+
+void RenderSystem::SetOcclusionCulling(bool enabled) {
+    if (occlusionCulling == enabled) return;
+    occlusionCulling = enabled;
+    InvalidateVisibility();
+}
+
+bool RenderSystem::GetOcclusionCulling() const { return occlusionCulling; }
+
+void RenderSystem::SetOcclusionBufferSize(int width, int height) {
+    occlusionWidth = std::max(width, 1);
+    occlusionHeight = std::max(height, 1);
+    if (occlusionCulling) {
+        InvalidateVisibility();
     }
+}
 
-    if (a.vertexType != b.vertexType) {
-        return a.vertexType<b.vertexType;
+const RenderSystem::Overdraw* RenderSystem::GetOverdraw(GameObject* cameraObject) const {
+    for(int i=0; i<passCount; ++i) {
+        if (passes[i].camera == cameraObject) return &passes[i].overdraw;
     }
+    return 0;
+}
 
-    if (a.shader == b.shader) {
-        if (a.texture==b.texture) {
-            return a.distanceToCamera<b.distanceToCamera;
-        } else {
-            return a.texture<b.texture;
+const RenderSystem::CameraStats* RenderSystem::GetCameraStats(GameObject* cameraObject) const {
+    for(int i=0; i<passCount; ++i) {
+        if (passes[i].camera == cameraObject) return &passes[i].stats;
+    }
+    return 0;
+}
+
+const RenderSystem::FrameStats& RenderSystem::GetFrameStats() const { return frameStats; }
+
+static void PrintRenderInfo(std::ostream& stream, const char* name, const RenderInfo& info) {
+    static const char* reasons[] = { "shader", "texture", "blend", "clip", "static", "capacity", "end" };
+    stream << "  " << name << ": draws " << info.drawCalls << ", vertices " << info.verticesRendered
+           << ", objects " << info.objectsRendered << ", uploaded " << info.bytesUploaded << " bytes, flushes";
+    for(int i=0; i<(int)FlushReason::Count; ++i) {
+        stream << " " << reasons[i] << " " << info.flushes[i];
+    }
+    stream << std::endl;
+}
+
+void RenderSystem::PrintStats(std::ostream& stream) const {
+    static const char* passNames[] = { "depth pre pass", "opaque", "transparent" };
+    stream << "Frame: cameras " << frameStats.cameras << ", prepare " << frameStats.prepareTime * 1000.0
+           << " ms, total " << frameStats.frameTime * 1000.0 << " ms" << std::endl;
+    PrintRenderInfo(stream, "all", frameStats.total);
+    for(int i=0; i<passCount; ++i) {
+        const CameraStats& stats = passes[i].stats;
+        stream << "Camera " << i << ": objects " << stats.objects << ", in frustum " << stats.inFrustum
+               << ", visible " << stats.visible << (stats.rebuilt ? ", rebuilt" : ", cached")
+               << ", cull " << stats.cullTime * 1000.0 << " ms, build " << stats.buildTime * 1000.0
+               << " ms, sort " << stats.sortTime * 1000.0 << " ms, submit " << stats.submitTime * 1000.0 << " ms";
+        if (occlusionCulling) {
+            stream << ", occluder triangles " << stats.occluderTriangles << ", occlusion " << stats.occlusionTime * 1000.0 << " ms";
+        }
+        if (stats.gpuTime >= 0) {
+            stream << ", gpu " << stats.gpuTime * 1000.0 << " ms";
+        }
+        stream << std::endl;
+        for(int p=0; p<CameraStats::PassCount; ++p) {
+            if (stats.passes[p].drawCalls == 0) continue;
+            PrintRenderInfo(stream, passNames[p], stats.passes[p]);
         }
-    } else {
-        return ((size_t)a.shader)<((size_t)b.shader);
     }
 }
 
-bool RenderSystem::SortTransparentObjects(const VisibleObject& a, const VisibleObject& b) {
-    if (a.orderable && b.orderable) {
-        int orderA = a.orderable->Order();
-        int orderB = b.orderable->Order();
-        if (orderA!=orderB) {
-            return orderA<orderB;
+void RenderSystem::SetGpuTiming(bool enabled) {
+    gpuTiming = enabled && GpuTimer::IsSupported();
+    if (!gpuTiming) {
+        for(auto& pass : passes) {
+            pass.gpuTimer.reset();
         }
     }
+}
 
-    return a.distanceToCamera>b.distanceToCamera;
+bool RenderSystem::GetGpuTiming() const { return gpuTiming; }
+
+void RenderSystem::SetJobSystem(JobSystem* jobSystem) {
+    this->jobSystem = jobSystem;
 }
 
+JobSystem* RenderSystem::GetJobSystem() const { return jobSystem; }
+
 void RenderSystem::SetCameras(Pocket::RenderSystem::CameraSystem *cameraSystem) {
     cameras = cameraSystem;
 }
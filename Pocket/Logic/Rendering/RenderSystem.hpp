@@ -12,30 +12,139 @@
 #include "OctreeSystem.hpp"
 #include "ObjectRenderer.hpp"
 #include "ShaderCollection.hpp"
+#include "RenderQueue.hpp"
+#include "JobSystem.hpp"
+#include "GpuTimer.hpp"
+#include "Occluder.hpp"
+#include "OcclusionBuffer.hpp"
+#include <memory>
+#include <atomic>
+#include <ostream>
 
 namespace Pocket {
 
 class RenderSystem : public GameSystem<Transform, Mesh, Renderable> {
 public:
-    using OctreeSystem = OctreeSystem<Renderable>;
+    using OctreeSystem = Pocket::OctreeSystem<Renderable>;
     
     struct CameraSystem : GameSystem<Transform, Camera> { };
     
     struct TextureSystem : GameSystem<TextureComponent, Orderable> {};
     
+    // Renderables gaining or losing a material component are sorted and drawn differently.
+    template<typename Component>
+    struct MaterialSystem : GameSystem<Transform, Mesh, Renderable, Component> {
+        void Initialize();
+        void ObjectAdded(GameObject* object);
+        void ObjectRemoved(GameObject* object);
+        RenderSystem* renderSystem;
+    };
+    
+    struct OrderableSystem : MaterialSystem<Orderable> {
+        void ObjectAdded(GameObject* object);
+        void ObjectRemoved(GameObject* object);
+    };
+    
+    // Occluders need no Renderable, adding, moving or changing one invalidates visibility.
+    struct OccluderSystem : GameSystem<Transform, Mesh, Occluder> {
+        void Initialize();
+        void ObjectAdded(GameObject* object);
+        void ObjectRemoved(GameObject* object);
+        RenderSystem* renderSystem;
+    };
+    
     using ObjectRenderers = std::vector<IObjectRenderer*>;
     using VisibleObjects = std::vector<VisibleObject>;
 
+    RenderSystem();
     void Initialize();
     void Destroy();
     void ObjectAdded(GameObject *object);
+    void ObjectRemoved(GameObject *object);
     OctreeSystem& Octree();
     void RenderCamera(GameObject* cameraObject);
-    void RenderVisibleObjects(const VisibleObjects& visibleObjects);
-    void RenderTransparentVisibleObjects(const VisibleObjects& visibleObjects);
     void Render();
-    static bool SortOpaqueObjects(const VisibleObject& a, const VisibleObject& b);
-    static bool SortTransparentObjects(const VisibleObject& a, const VisibleObject& b);
+    
+    // Culling, sorting and vertex transforms run as jobs, the calling thread only issues gl calls.
+    void SetJobSystem(JobSystem* jobSystem);
+    JobSystem* GetJobSystem() const;
+    
+    // Visible sets, sort orders and transformed vertices are kept between frames.
+    // They are rebuilt when a camera moves, an octree node moves, or renderables or their materials change.
+    // Call this after changes that can't be observed, like replacing the shader of a ShaderComponent.
+    void InvalidateVisibility();
+    
+    // How opaque objects are ordered within each Orderable order.
+    enum class OpaqueOrder {
+        // Grouped by vertex type, shader and texture, front to back within a group. Fewest state changes.
+        State,
+        // Front to back first, so early depth testing rejects hidden fragments. For fragment heavy scenes.
+        FrontToBack,
+    };
+    void SetOpaqueOrder(OpaqueOrder order);
+    OpaqueOrder GetOpaqueOrder() const;
+    
+    // Layers of surfaces per pixel, estimated from the screen area covered by the bounds of the visible objects.
+    struct Overdraw {
+        float opaque;
+        float transparent;
+        // When the depth pre pass ran, opaque pixels are shaded once regardless of opaque overdraw.
+        bool depthPrePass;
+    };
+    
+    // Overdraw of the last frame rendered by the camera, or null.
+    const Overdraw* GetOverdraw(GameObject* cameraObject) const;
+    
+    // Meshes with an Occluder component are rasterized into a small depth buffer on the cpu for each camera,
+    // and octree cells and objects hidden behind them are culled along with the frustum. Off by default.
+    void SetOcclusionCulling(bool enabled);
+    bool GetOcclusionCulling() const;
+    
+    // Size of the occlusion depth buffer in pixels, 256 x 128 by default.
+    void SetOcclusionBufferSize(int width, int height);
+    
+    // What a camera cost in the last frame, times are in seconds.
+    struct CameraStats {
+        enum Pass { DepthPrePass, Opaque, Transparent, PassCount };
+        
+        // Renderables in the octree, inside the frustum and not occluded, and drawn after the camera mask was applied.
+        int objects;
+        int inFrustum;
+        int visible;
+        // Occluder triangles rasterized for occlusion culling.
+        int occluderTriangles;
+        // Culling, building and sorting only run when the visible set changed, their times are zero otherwise.
+        bool rebuilt;
+        // Job times are summed over all threads.
+        double cullTime;
+        double occlusionTime;
+        double buildTime;
+        double sortTime;
+        double submitTime;
+        // Measured a few frames late, -1 when gpu timing is off or unsupported.
+        double gpuTime;
+        RenderInfo passes[PassCount];
+        // All passes, indexed by vertex type.
+        std::vector<RenderInfo> vertexTypes;
+    };
+    
+    struct FrameStats {
+        int cameras;
+        double prepareTime;
+        double frameTime;
+        RenderInfo total;
+    };
+    
+    // Stats of the last frame rendered by the camera, or null.
+    const CameraStats* GetCameraStats(GameObject* cameraObject) const;
+    const FrameStats& GetFrameStats() const;
+    
+    // Writes the stats of the last frame, one line per camera and pass.
+    void PrintStats(std::ostream& stream) const;
+    
+    // Times each camera on the gpu with timer queries, see GpuTimer for where they are supported.
+    void SetGpuTiming(bool enabled);
+    bool GetGpuTiming() const;
     
     ShaderCollection Shaders;
     IShader* DefaultShader;
@@ -50,13 +159,91 @@ private:
     static ObjectRenderers objectRenderers;
     static int objectRenderersRefCounter;
     
-    VisibleObjects opaqueObjects;
-    VisibleObjects transparentObjects;
+    struct CameraPass {
+        CameraPass() : version(0), stats() { }
+        GameObject* camera;
+        Rect screenRect;
+        RenderMask mask;
+        Matrix4x4 viewProjection;
+        BoundingFrustum frustum;
+        ObjectCollection objectsInFrustum;
+        // Frustum plane that last rejected each object, tested first by the next cull.
+        std::vector<unsigned char> lastPlanes;
+        OcclusionBuffer occlusion;
+        // One slot per object in frustum, only the slots referenced by the queues are valid.
+        VisibleObjects visibleObjects;
+        RenderQueue opaqueQueue;
+        RenderQueue transparentQueue;
+        // Scene version the visible set was built for.
+        unsigned version;
+        Overdraw overdraw;
+        bool wantsDepthPrePass;
+        bool hasClipping;
+        CameraStats stats;
+        std::unique_ptr<GpuTimer> gpuTimer;
+    };
+    
+    struct Chunk {
+        int pass;
+        int begin;
+        int end;
+        RenderQueue opaqueQueue;
+        RenderQueue transparentQueue;
+        float opaqueCoverage;
+        float transparentCoverage;
+        bool hasClipping;
+        double buildTime;
+    };
+    
+    using CameraPasses = std::vector<CameraPass>;
+    using Chunks = std::vector<Chunk>;
+    
+    void RenderCameras(GameObject* const* cameraObjects, int count);
+    bool SetupPass(CameraPass& pass, GameObject* cameraObject);
+    void BuildPasses();
+    void RasterizeOccluders();
+    void BuildVisibleObjects(Chunk& chunk);
+    void PrepareVertices(int passCount);
+    bool IsPrepared(int passCount) const;
+    void SubmitPass(CameraPass& pass);
+    void RenderVisibleObjects(const VisibleObjects& visibleObjects, const RenderQueue& queue, CameraStats& stats, RenderInfo& passInfo);
+    void RenderTransparentVisibleObjects(const VisibleObjects& visibleObjects, const RenderQueue& queue, CameraStats& stats, RenderInfo& passInfo);
+    void EndRenderer(int vertexType, CameraStats& stats, RenderInfo& passInfo);
+    void ParallelFor(int count, int batchSize, const JobSystem::RangeJob& job);
+    
+    // Pointers hashed down to the id bits of the sort keys.
+    static uint32_t SortId(const void* pointer, uint32_t maxIds);
+    
+    CameraPasses passes;
+    int passCount;
+    std::vector<int> changedPasses;
+    Chunks chunks;
+    std::vector<const VisibleObject*> preparedObjects;
+    std::vector<size_t> preparedOffsets;
+    unsigned preparedVersion;
+    int preparedPasses;
+    JobSystem* jobSystem;
+    
+    // Invalidated by component events, which systems updating concurrently can fire from several threads.
+    std::atomic<unsigned> version;
+    unsigned octreeVersion;
+    OpaqueOrder opaqueOrder;
 
-    RenderInfo renderInfo;
-    ObjectCollection objectsInFrustum;
+    FrameStats frameStats;
+    bool gpuTiming;
+    
+    bool occlusionCulling;
+    int occlusionWidth;
+    int occlusionHeight;
+    std::vector<Vector3> occluderPositions;
+    // Time spent on each rasterized tile, summed into the stats of its pass.
+    std::vector<double> tileTimes;
+    std::vector<int> occludedPasses;
+    
+    Clipper clipper;
 
     CameraSystem* cameras;
+    OccluderSystem* occluders;
     OctreeSystem* meshOctreeSystem;
 };
 
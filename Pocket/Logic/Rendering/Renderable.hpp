@@ -20,13 +20,18 @@ namespace Pocket {
 
     struct Renderable {
     public:
-        Renderable() { BlendMode = BlendModeType::Opaque; Mask = 0; Clip = 0; }
+        Renderable() { BlendMode = BlendModeType::Opaque; Mask = 0; Clip = 0; Static = false; }
         Property<BlendModeType> BlendMode;
         Property<RenderMask> Mask;
-        int Clip;
+        Property<int> Clip;
+        // Static meshes keep their own gpu buffers and are drawn with the world matrix as a shader uniform,
+        // instead of being transformed and uploaded every frame.
+        Property<bool> Static;
         TYPE_FIELDS_BEGIN
         TYPE_FIELD(BlendMode)
         TYPE_FIELD(Mask)
+        TYPE_FIELD(Clip)
+        TYPE_FIELD(Static)
         TYPE_FIELDS_END
     };
 }
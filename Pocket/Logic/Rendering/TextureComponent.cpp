@@ -7,14 +7,38 @@
 //
 
 #include "TextureComponent.hpp"
+#include "ImageLoader.hpp"
 
 using namespace Pocket;
 
-Texture& TextureComponent::Texture() { return texture; }
+Texture& TextureComponent::Texture() {
+    if (page) return *page;
+    return texture;
+}
 
-TextureComponent::TextureComponent() {}
+TextureComponent::TextureComponent() : page(0) {}
 TextureComponent::~TextureComponent() { texture.Free(); }
 
 void TextureComponent::LoadAsset(const std::string &path) {
+    page = 0;
     texture.LoadFromFile(path);
 }
+
+bool TextureComponent::LoadIntoPage(const std::string &path, TexturePage &page) {
+    bool added = false;
+    ImageLoader::TryLoadImage(path, [this, &page, &added] (unsigned char* pixels, int width, int height) {
+        added = LoadIntoPage(pixels, width, height, page);
+    });
+    return added;
+}
+
+bool TextureComponent::LoadIntoPage(const unsigned char* pixels, int width, int height, TexturePage &page) {
+    if (!page.Add(pixels, width, height, pageRegion)) return false;
+    texture.Free();
+    this->page = &page;
+    return true;
+}
+
+TexturePage* TextureComponent::Page() const { return page; }
+
+const Box& TextureComponent::PageRegion() const { return pageRegion; }
@@ -8,6 +8,7 @@
 
 #pragma once
 #include "Texture.hpp"
+#include "TexturePage.hpp"
 
 namespace Pocket {
     struct TextureComponent {
@@ -15,11 +16,25 @@ namespace Pocket {
         TextureComponent();
         ~TextureComponent();
         
+        // The page when the image was loaded into one, otherwise the component's own texture.
         Pocket::Texture& Texture();
         
         void LoadAsset(const std::string& path);
+        
+        // Loads the image into a shared page instead of its own texture, objects textured from
+        // the same page are batched together even when their images differ.
+        // Texture coordinates are remapped to the image's region, so they must stay within 0..1,
+        // and the page must outlive the component. Returns false when the image did not fit.
+        // Components already being rendered need RenderSystem::InvalidateVisibility afterwards.
+        bool LoadIntoPage(const std::string& path, TexturePage& page);
+        bool LoadIntoPage(const unsigned char* pixels, int width, int height, TexturePage& page);
+        
+        TexturePage* Page() const;
+        const Box& PageRegion() const;
     private:
         class Pocket::Texture texture;
         std::string prevPath;
+        TexturePage* page;
+        Box pageRegion;
     };
 }
\ No newline at end of file
@@ -12,20 +12,47 @@
 #include "Transform.hpp"
 #include "Mesh.hpp"
 #include "Octree.hpp"
+#include "DynamicTree.hpp"
+#include "SpatialIndex.hpp"
+#include <memory>
+#include <mutex>
 
 namespace Pocket {
+    // Objects are kept in an Octree by default, SetSpatialIndex can replace it,
+    // with a DynamicTree for scenes without fixed bounds.
     template<typename...ExtraComponents>
     class OctreeSystem : public GameSystem<Transform, Mesh, ExtraComponents...> {
     public:
         
-        OctreeSystem() {
+        OctreeSystem() : version(0), spatialIndex(new SpatialIndex<Octree>()) {
             SetWorldBounds(BoundingBox(0, 1000));
         }
 
         void SetWorldBounds(const Pocket::BoundingBox &bounds) {
-            octree.SetBoundingBox(bounds);
+            worldBounds = bounds;
+            spatialIndex->SetBoundingBox(bounds);
+            version++;
         }
 
+        // Moves all objects into a new index of type Index, which is returned so it can be configured.
+        template<typename Index>
+        Index& SetSpatialIndex() {
+            SpatialIndex<Index>* newIndex = new SpatialIndex<Index>();
+            newIndex->SetBoundingBox(worldBounds);
+            for(GameObject* object : this->Objects()) {
+                Node* node = (Node*)this->GetMetaData(object);
+                if (!node->octreeNode.IsInserted()) continue;
+                spatialIndex->Remove(node->octreeNode);
+                newIndex->Insert(node->octreeNode);
+            }
+            spatialIndex.reset(newIndex);
+            version++;
+            return newIndex->index;
+        }
+        
+        // Changes whenever a node is added, moved or removed, so query results can be cached.
+        unsigned Version() const { return version; }
+
         void ObjectAdded(GameObject* object) {
             this->SetMetaData(object, new Node(object, object->GetComponent<Transform>(), object->GetComponent<Mesh>(), this));
         }
@@ -43,22 +70,38 @@ namespace Pocket {
             octreeObjectsUpdateList.clear();
         }
 
-        void GetObjectsInFrustum(const Pocket::BoundingFrustum &frustum, ObjectCollection& objectList) {
+        void GetObjectsInFrustum(const Pocket::BoundingFrustum &frustum, ObjectCollection& objectList, std::vector<unsigned char>* lastPlanes = 0, const OcclusionBuffer* occlusion = 0) {
             UpdateAllNodes();
-            octree.Get<GameObject*>(frustum, objectList);
+            spatialIndex->Get(frustum, objectList, lastPlanes, occlusion);
+        }
+
+        // Leaves moved objects where they were, call UpdateAllNodes first.
+        // Does not modify the octree, so several threads can query at once, each with its own lastPlanes.
+        void QueryFrustum(const Pocket::BoundingFrustum &frustum, ObjectCollection& objectList, std::vector<unsigned char>* lastPlanes = 0, const OcclusionBuffer* occlusion = 0) {
+            spatialIndex->Get(frustum, objectList, lastPlanes, occlusion);
         }
 
         void GetObjectsAtRay(const Pocket::Ray &ray, ObjectCollection& objectList) {
             UpdateAllNodes();
-            octree.Get<GameObject*>(ray, objectList);
+            spatialIndex->Get(ray, objectList);
+        }
+
+        // Finds the objects at up to Ray::MaxBatch rays in one walk of the index, objectLists holds one list per ray.
+        void GetObjectsAtRays(const Pocket::Ray* rays, int count, ObjectCollection* objectLists) {
+            UpdateAllNodes();
+            spatialIndex->Get(rays, count, objectLists);
         }
 
         
         struct Node;
         
-        Octree octree;
+        unsigned version;
+        BoundingBox worldBounds;
+        std::unique_ptr<ISpatialIndex> spatialIndex;
         typedef std::vector<Node*> OctreeObjectsUpdateList;
 		OctreeObjectsUpdateList octreeObjectsUpdateList;
+        // Systems updating concurrently can move objects of the same octree.
+        std::mutex updateListMutex;
         
         struct Node {
             
@@ -70,8 +113,6 @@ namespace Pocket {
             {
                 boundingBoxDirty = true;
                 octreeNodeDirty = false;
-                octreeNode.order = 0;
-                octreeNode.node = 0;
                 octreeNode.data = object;
                 
                 transform->World.HasBecomeDirty.Bind(this, &Node::TransformChanged);
@@ -89,19 +130,29 @@ namespace Pocket {
                     system->octreeObjectsUpdateList[indexInList] = 0;
                 }
                 
-                if (octreeNode.node) {
-                    system->octree.Remove(octreeNode);
+                if (octreeNode.IsInserted()) {
+                    system->spatialIndex->Remove(octreeNode);
                 }
+                system->version++;
             }
 
             void TransformChanged() {
-                boundingBoxDirty = true;
-                SetOctreeNodeDirty();
+                SetBoundingBoxDirty();
             }
 
             void MeshBoundingBoxChanged() {
-                boundingBoxDirty = true;
-                SetOctreeNodeDirty();
+                SetBoundingBoxDirty();
+            }
+            
+            void SetBoundingBoxDirty() {
+                if (SystemScheduler::CurrentTask()) {
+                    std::lock_guard<std::mutex> lock(system->updateListMutex);
+                    boundingBoxDirty = true;
+                    SetOctreeNodeDirty();
+                } else {
+                    boundingBoxDirty = true;
+                    SetOctreeNodeDirty();
+                }
             }
 
             bool InView(const BoundingFrustum& frustum) {
@@ -116,6 +167,7 @@ namespace Pocket {
             void SetOctreeNodeDirty() {
                 if (octreeNodeDirty) return;
                 octreeNodeDirty = true;
+                system->version++;
                 indexInList = system->octreeObjectsUpdateList.size();
                 system->octreeObjectsUpdateList.push_back(this);
             }
@@ -130,17 +182,17 @@ namespace Pocket {
                     box.CreateWorldAligned(transform->World, octreeNode.box);
                 }
                 
-                if (!octreeNode.node) {
-                    system->octree.Insert(octreeNode);
+                if (!octreeNode.IsInserted()) {
+                    system->spatialIndex->Insert(octreeNode);
                 } else {
-                    system->octree.Move(octreeNode);
+                    system->spatialIndex->Move(octreeNode);
                 }
             }
                         
             Transform* transform;
             Mesh* mesh;
             OctreeSystem* system;
-            Octree::Node octreeNode;
+            SpatialNode octreeNode;
             BoundingBox boundingBox;
             bool octreeNodeDirty;
             bool boundingBoxDirty;
@@ -0,0 +1,48 @@
+//
+//  SpatialIndex.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "GameObject.hpp"
+#include "SpatialNode.hpp"
+#include "BoundingFrustum.hpp"
+#include "OcclusionBuffer.hpp"
+#include "Ray.hpp"
+
+namespace Pocket {
+    // Spatial index of game objects used by OctreeSystem, nodes hold the objects as data.
+    class ISpatialIndex {
+    public:
+        virtual ~ISpatialIndex() {}
+        virtual void SetBoundingBox(const BoundingBox& box) = 0;
+        virtual void Insert(SpatialNode& node) = 0;
+        virtual void Remove(SpatialNode& node) = 0;
+        virtual void Move(SpatialNode& node) = 0;
+        // Queries do not modify the index, so several threads can query at once.
+        // lastPlanes is an optional per frustum cache of the plane that last rejected each object,
+        // objects hidden in the optional occlusion buffer are skipped.
+        virtual void Get(const BoundingFrustum& frustum, ObjectCollection& list, std::vector<unsigned char>* lastPlanes, const OcclusionBuffer* occlusion) const = 0;
+        virtual void Get(const Ray& ray, ObjectCollection& list) const = 0;
+        // Up to Ray::MaxBatch rays in one query, lists holds one list per ray.
+        virtual void Get(const Ray* rays, int count, ObjectCollection* lists) const = 0;
+    };
+
+    // Wraps Octree, DynamicTree or any class with the same Insert, Remove, Move, SetBoundingBox and Get<T> methods.
+    template<typename Index>
+    class SpatialIndex : public ISpatialIndex {
+    public:
+        void SetBoundingBox(const BoundingBox& box) override { index.SetBoundingBox(box); }
+        void Insert(SpatialNode& node) override { index.Insert(node); }
+        void Remove(SpatialNode& node) override { index.Remove(node); }
+        void Move(SpatialNode& node) override { index.Move(node); }
+        void Get(const BoundingFrustum& frustum, ObjectCollection& list, std::vector<unsigned char>* lastPlanes, const OcclusionBuffer* occlusion) const override { index.template Get<GameObject*>(frustum, list, lastPlanes, occlusion); }
+        void Get(const Ray& ray, ObjectCollection& list) const override { index.template Get<GameObject*>(ray, list); }
+        void Get(const Ray* rays, int count, ObjectCollection* lists) const override { index.template Get<GameObject*>(rays, count, lists); }
+
+        Index index;
+    };
+}
@@ -1,4 +1,8 @@
 #include "BoundingFrustum.hpp"
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using namespace Pocket;
 
@@ -153,53 +157,139 @@ void BoundingFrustum::SetFromViewProjection(const Matrix4x4& viewProjection) {
 //          OUTSIDE : 2 
 
 
-int BoundingFrustum::Count = 0;
-
-BoundingFrustum::Intersection BoundingFrustum::Intersect(const BoundingBox& box) const { 
-	Intersection ret = INSIDE; 
-	Vector3 vmin, vmax; 
-	Vector3 halfExtends = box.extends * 0.5f;
-	Vector3 mins = box.center - halfExtends;
-	Vector3 maxs = box.center + halfExtends;
-
-	Count++;
-
-	for(int i = 0; i < 6; ++i) { 
-		// X axis 
-		if(planes[i].normal.x > 0) { 
-			vmin.x = mins.x; 
-			vmax.x = maxs.x; 
-		} else { 
-			vmin.x = maxs.x; 
-			vmax.x = mins.x; 
-		} 
-		// Y axis 
-		if(planes[i].normal.y > 0) { 
-			vmin.y = mins.y; 
-			vmax.y = maxs.y; 
-		} else { 
-			vmin.y = maxs.y; 
-			vmax.y = mins.y; 
-		} 
-		// Z axis 
-		if(planes[i].normal.z > 0) { 
-			vmin.z = mins.z; 
-			vmax.z = maxs.z; 
-		} else { 
-			vmin.z = maxs.z; 
-			vmax.z = mins.z;
+std::atomic<int> BoundingFrustum::Count(0);
+
+BoundingFrustum::Intersection BoundingFrustum::Intersect(const BoundingBox& box) const {
+	int planeMask = AllPlanes;
+	return Intersect(box, planeMask);
+}
+
+// A box is outside a plane when its center is further behind it than the box reaches along the normal,
+// and inside when the center is further in front.
+BoundingFrustum::Intersection BoundingFrustum::Intersect(const BoundingBox& box, int& planeMask) const {
+	Count.fetch_add(1, std::memory_order_relaxed);
+	const Vector3& center = box.center;
+	const Vector3 half = box.extends * 0.5f;
+	for(int i = 0; i < 6; ++i) {
+		if (!(planeMask & (1 << i))) continue;
+		const Plane& plane = planes[i];
+		const float distance = plane.Distance(center);
+		const float radius = fabsf(plane.normal.x) * half.x + fabsf(plane.normal.y) * half.y + fabsf(plane.normal.z) * half.z;
+		if (distance + radius < 0) return OUTSIDE;
+		if (distance - radius > 0) planeMask &= ~(1 << i);
+	}
+	return planeMask ? INTERSECT : INSIDE;
+}
+
+void BoundingFrustum::Intersect(const PackedBoxes& boxes, size_t first, size_t count, int planeMask, Intersection* results, unsigned char* lastPlanes) const {
+	if (count == 0) return;
+	Count.fetch_add((int)count, std::memory_order_relaxed);
+
+	int active[6];
+	int activeCount = 0;
+	for(int i = 0; i < 6; ++i) {
+		if (planeMask & (1 << i)) active[activeCount++] = i;
+	}
+
+	const float* centerX = &boxes.centerX[first];
+	const float* centerY = &boxes.centerY[first];
+	const float* centerZ = &boxes.centerZ[first];
+	const float* halfX = &boxes.halfX[first];
+	const float* halfY = &boxes.halfY[first];
+	const float* halfZ = &boxes.halfZ[first];
+
+	size_t i = 0;
+#if defined(__SSE2__)
+	__m128 normalX[6], normalY[6], normalZ[6], absX[6], absY[6], absZ[6], d[6];
+	for(int p = 0; p < 6; ++p) {
+		const Plane& plane = planes[p];
+		normalX[p] = _mm_set1_ps(plane.normal.x);
+		normalY[p] = _mm_set1_ps(plane.normal.y);
+		normalZ[p] = _mm_set1_ps(plane.normal.z);
+		absX[p] = _mm_set1_ps(fabsf(plane.normal.x));
+		absY[p] = _mm_set1_ps(fabsf(plane.normal.y));
+		absZ[p] = _mm_set1_ps(fabsf(plane.normal.z));
+		d[p] = _mm_set1_ps(plane.d);
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	for(; i + 4 <= count; i += 4) {
+		const __m128 x = _mm_loadu_ps(centerX + i);
+		const __m128 y = _mm_loadu_ps(centerY + i);
+		const __m128 z = _mm_loadu_ps(centerZ + i);
+		const __m128 hx = _mm_loadu_ps(halfX + i);
+		const __m128 hy = _mm_loadu_ps(halfY + i);
+		const __m128 hz = _mm_loadu_ps(halfZ + i);
+
+		__m128 outside = zero;
+		if (lastPlanes) {
+			// each box is first tested against the plane that rejected it last time
+			const Plane& p0 = planes[lastPlanes[i]];
+			const Plane& p1 = planes[lastPlanes[i + 1]];
+			const Plane& p2 = planes[lastPlanes[i + 2]];
+			const Plane& p3 = planes[lastPlanes[i + 3]];
+			const __m128 nx = _mm_setr_ps(p0.normal.x, p1.normal.x, p2.normal.x, p3.normal.x);
+			const __m128 ny = _mm_setr_ps(p0.normal.y, p1.normal.y, p2.normal.y, p3.normal.y);
+			const __m128 nz = _mm_setr_ps(p0.normal.z, p1.normal.z, p2.normal.z, p3.normal.z);
+			const __m128 pd = _mm_setr_ps(p0.d, p1.d, p2.d, p3.d);
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)), _mm_add_ps(_mm_mul_ps(nz, z), pd));
+			const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), hx), _mm_mul_ps(_mm_andnot_ps(signMask, ny), hy)), _mm_mul_ps(_mm_andnot_ps(signMask, nz), hz));
+			outside = _mm_cmplt_ps(_mm_add_ps(distance, radius), zero);
+			if (_mm_movemask_ps(outside) == 0xF) {
+				results[i] = results[i + 1] = results[i + 2] = results[i + 3] = OUTSIDE;
+				continue;
+			}
+		}
+
+		__m128 intersect = zero;
+		for(int a = 0; a < activeCount; ++a) {
+			const int p = active[a];
+			const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX[p], x), _mm_mul_ps(normalY[p], y)), _mm_add_ps(_mm_mul_ps(normalZ[p], z), d[p]));
+			const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], hx), _mm_mul_ps(absY[p], hy)), _mm_mul_ps(absZ[p], hz));
+			const __m128 out = _mm_cmplt_ps(_mm_add_ps(distance, radius), zero);
+			if (lastPlanes) {
+				int rejected = _mm_movemask_ps(_mm_andnot_ps(outside, out));
+				for(int lane = 0; rejected; ++lane, rejected >>= 1) {
+					if (rejected & 1) lastPlanes[i + lane] = (unsigned char)p;
+				}
+			}
+			outside = _mm_or_ps(outside, out);
+			intersect = _mm_or_ps(intersect, _mm_cmple_ps(_mm_sub_ps(distance, radius), zero));
+			if (_mm_movemask_ps(outside) == 0xF) break;
+		}
+
+		const int outsideMask = _mm_movemask_ps(outside);
+		const int intersectMask = _mm_movemask_ps(intersect);
+		for(int lane = 0; lane < 4; ++lane) {
+			results[i + lane] = (outsideMask & (1 << lane)) ? OUTSIDE : (intersectMask & (1 << lane)) ? INTERSECT : INSIDE;
+		}
+	}
+#endif
+	for(; i < count; ++i) {
+		if (lastPlanes) {
+			const Plane& plane = planes[lastPlanes[i]];
+			const float distance = plane.normal.x * centerX[i] + plane.normal.y * centerY[i] + plane.normal.z * centerZ[i] + plane.d;
+			const float radius = fabsf(plane.normal.x) * halfX[i] + fabsf(plane.normal.y) * halfY[i] + fabsf(plane.normal.z) * halfZ[i];
+			if (distance + radius < 0) {
+				results[i] = OUTSIDE;
+				continue;
+			}
+		}
+		Intersection result = INSIDE;
+		for(int a = 0; a < activeCount; ++a) {
+			const int p = active[a];
+			const Plane& plane = planes[p];
+			const float distance = plane.normal.x * centerX[i] + plane.normal.y * centerY[i] + plane.normal.z * centerZ[i] + plane.d;
+			const float radius = fabsf(plane.normal.x) * halfX[i] + fabsf(plane.normal.y) * halfY[i] + fabsf(plane.normal.z) * halfZ[i];
+			if (distance + radius < 0) {
+				result = OUTSIDE;
+				if (lastPlanes) lastPlanes[i] = (unsigned char)p;
+				break;
+			}
+			if (distance - radius <= 0) result = INTERSECT;
 		}
-        if (planes[i].Distance(vmax)<0) return OUTSIDE;
-		if (planes[i].Distance(vmin)<=0) ret = INTERSECT;
-
-		//if (planes[i].Distance(vmin)>0) return 2;
-		//if (planes[i].Distance(vmax)>=0) ret = 0;
-
-		//if(Vector::DotProduct(planes[i].normal, vmin) + planes[i].d > 0) 
-		//	return 2; 
-		//if(Vector::DotProduct(planes[i].normal, vmax) + planes[i].d >= 0) 
-		//	ret = 0; 
-	} 
-	return ret;
+		results[i] = result;
+	}
 } 
 
@@ -2,6 +2,8 @@
 #include "Matrix4x4.hpp"
 #include "Plane.hpp"
 #include "BoundingBox.hpp"
+#include "PackedBoxes.hpp"
+#include <atomic>
 
 namespace Pocket {
 	class BoundingFrustum
@@ -19,10 +21,22 @@ namespace Pocket {
 			OUTSIDE = 2,
 		};
 
-		static int Count;
+		// Number of box tests, may be counted from several culling jobs at once
+		static std::atomic<int> Count;
 
 		Intersection Intersect(const BoundingBox& box) const;
 
+		// A bit per plane, for plane masks.
+		static const int AllPlanes = 0x3F;
+
+		// Only tests the planes in planeMask, and clears the planes the box is inside of.
+		// Boxes within the box then only need to be tested against the planes left.
+		Intersection Intersect(const BoundingBox& box, int& planeMask) const;
+
+		// Tests count boxes from first against the planes in planeMask, 4 at a time when SIMD is available.
+		// lastPlanes is optional, with a plane per box which is tested first, and set to the plane rejecting the box.
+		void Intersect(const PackedBoxes& boxes, size_t first, size_t count, int planeMask, Intersection* results, unsigned char* lastPlanes = 0) const;
+
 		Plane planes[6];
 	};
 }
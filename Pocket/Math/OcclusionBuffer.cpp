@@ -0,0 +1,293 @@
+//
+//  OcclusionBuffer.cpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "OcclusionBuffer.hpp"
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace Pocket;
+
+// Boxes must be this much behind the buffer to be occluded, so occluders are not hidden by their own triangles.
+static const float DepthBias = 1e-5f;
+
+OcclusionBuffer::OcclusionBuffer() : width(0), height(0), stride(0), tilesX(0), tilesY(0) { }
+
+void OcclusionBuffer::Begin(int width, int height, const Matrix4x4& viewProjection) {
+    this->width = std::max(width, 1);
+    this->height = std::max(height, 1);
+    this->viewProjection = viewProjection;
+    stride = (this->width + 3) & ~3;
+    tilesX = (this->width + TileWidth - 1) / TileWidth;
+    tilesY = (this->height + TileHeight - 1) / TileHeight;
+    depth.resize(stride * this->height);
+    tileMaxDepth.resize(TileCount());
+    if (bins.size()<(size_t)TileCount()) {
+        bins.resize(TileCount());
+    }
+    for(int i=0; i<TileCount(); ++i) {
+        bins[i].clear();
+    }
+    triangles.clear();
+}
+
+void OcclusionBuffer::AddTriangles(const Matrix4x4& world, const Vector3* positions, size_t positionCount, const short* indices, size_t indexCount) {
+    const Matrix4x4 m = viewProjection.Multiply(world);
+    clipVertices.resize(positionCount);
+    for(size_t i=0; i<positionCount; ++i) {
+        const Vector3& p = positions[i];
+        ClipVertex& v = clipVertices[i];
+        v.x = m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3];
+        v.y = m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3];
+        v.z = m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3];
+        v.w = m[3][0] * p.x + m[3][1] * p.y + m[3][2] * p.z + m[3][3];
+    }
+
+    for(size_t i=0; i + 2<indexCount; i+=3) {
+        const size_t i0 = (unsigned short)indices[i];
+        const size_t i1 = (unsigned short)indices[i + 1];
+        const size_t i2 = (unsigned short)indices[i + 2];
+        if (i0>=positionCount || i1>=positionCount || i2>=positionCount) continue;
+        const ClipVertex* input[3] = { &clipVertices[i0], &clipVertices[i1], &clipVertices[i2] };
+
+        // distances to the near plane, z = -w
+        float distances[3];
+        int inside = 0;
+        for(int k=0; k<3; ++k) {
+            distances[k] = input[k]->z + input[k]->w;
+            if (distances[k]>=0) inside++;
+        }
+        if (inside == 0) continue;
+        if (inside == 3) {
+            AddTriangle(*input[0], *input[1], *input[2]);
+            continue;
+        }
+
+        ClipVertex clipped[4];
+        int count = 0;
+        for(int k=0; k<3; ++k) {
+            const int next = (k + 1) % 3;
+            const ClipVertex& a = *input[k];
+            const ClipVertex& b = *input[next];
+            if (distances[k]>=0) {
+                clipped[count++] = a;
+            }
+            if ((distances[k]>=0) != (distances[next]>=0)) {
+                const float t = distances[k] / (distances[k] - distances[next]);
+                ClipVertex& v = clipped[count++];
+                v.x = a.x + (b.x - a.x) * t;
+                v.y = a.y + (b.y - a.y) * t;
+                v.z = a.z + (b.z - a.z) * t;
+                v.w = a.w + (b.w - a.w) * t;
+            }
+        }
+        for(int k=2; k<count; ++k) {
+            AddTriangle(clipped[0], clipped[k - 1], clipped[k]);
+        }
+    }
+}
+
+void OcclusionBuffer::AddTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2) {
+    const ClipVertex* vertices[3] = { &v0, &v1, &v2 };
+    float x[3], y[3], z[3];
+    for(int k=0; k<3; ++k) {
+        const ClipVertex& v = *vertices[k];
+        if (v.w<=0) return;
+        const float invW = 1.0f / v.w;
+        x[k] = (v.x * invW * 0.5f + 0.5f) * width;
+        y[k] = (v.y * invW * 0.5f + 0.5f) * height;
+        z[k] = v.z * invW;
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (!(std::abs(area)>1e-8f)) return;
+    if (area<0) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        area = -area;
+    }
+
+    const float minX = std::min(x[0], std::min(x[1], x[2]));
+    const float maxX = std::max(x[0], std::max(x[1], x[2]));
+    const float minY = std::min(y[0], std::min(y[1], y[2]));
+    const float maxY = std::max(y[0], std::max(y[1], y[2]));
+    if (maxX<0 || maxY<0 || minX>width || minY>height) return;
+
+    Triangle triangle;
+    triangle.minX = std::max(0, (int)std::floor(minX));
+    triangle.minY = std::max(0, (int)std::floor(minY));
+    triangle.maxX = std::min(width - 1, (int)std::floor(maxX));
+    triangle.maxY = std::min(height - 1, (int)std::floor(maxY));
+    if (triangle.minX>triangle.maxX || triangle.minY>triangle.maxY) return;
+
+    for(int k=0; k<3; ++k) {
+        const int next = (k + 1) % 3;
+        triangle.edgeA[k] = y[k] - y[next];
+        triangle.edgeB[k] = x[next] - x[k];
+        triangle.edgeC[k] = -(triangle.edgeA[k] * x[k] + triangle.edgeB[k] * y[k]);
+    }
+    const float invArea = 1.0f / area;
+    triangle.depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * invArea;
+    triangle.depthB = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * invArea;
+    triangle.depthC = z[0] - triangle.depthA * x[0] - triangle.depthB * y[0];
+
+    const int index = (int)triangles.size();
+    triangles.push_back(triangle);
+    for(int ty = triangle.minY / TileHeight; ty<=triangle.maxY / TileHeight; ++ty) {
+        for(int tx = triangle.minX / TileWidth; tx<=triangle.maxX / TileWidth; ++tx) {
+            bins[ty * tilesX + tx].push_back(index);
+        }
+    }
+}
+
+// Pixels are covered when their center is inside a triangle, and keep the nearest depth.
+void OcclusionBuffer::RasterizeTile(int tile) {
+    const int tileX = (tile % tilesX) * TileWidth;
+    const int tileY = (tile / tilesX) * TileHeight;
+    const int endX = std::min(tileX + TileWidth, width);
+    const int endY = std::min(tileY + TileHeight, height);
+    // tiles start at a multiple of 4, so groups of 4 pixels never cross into the next tile
+    const int paddedEndX = std::min(tileX + TileWidth, stride);
+
+    for(int y=tileY; y<endY; ++y) {
+        std::fill(depth.begin() + y * stride + tileX, depth.begin() + y * stride + paddedEndX, 1.0f);
+    }
+
+    for(int index : bins[tile]) {
+        const Triangle& triangle = triangles[index];
+        const int startX = std::max(triangle.minX, tileX) & ~3;
+        const int stopX = std::min(triangle.maxX + 1, endX);
+        const int startY = std::max(triangle.minY, tileY);
+        const int stopY = std::min(triangle.maxY + 1, endY);
+#if defined(__SSE2__)
+        const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        __m128 edgeA[3];
+        for(int k=0; k<3; ++k) {
+            edgeA[k] = _mm_set1_ps(triangle.edgeA[k]);
+        }
+        const __m128 depthA = _mm_set1_ps(triangle.depthA);
+        for(int y=startY; y<stopY; ++y) {
+            const float centerY = y + 0.5f;
+            __m128 rowEdge[3];
+            for(int k=0; k<3; ++k) {
+                rowEdge[k] = _mm_set1_ps(triangle.edgeB[k] * centerY + triangle.edgeC[k]);
+            }
+            const __m128 rowDepth = _mm_set1_ps(triangle.depthB * centerY + triangle.depthC);
+            float* row = &depth[y * stride];
+            for(int x=startX; x<stopX; x+=4) {
+                const __m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[0], centerX), rowEdge[0]), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[1], centerX), rowEdge[1]), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[2], centerX), rowEdge[2]), zero));
+                if (_mm_movemask_ps(inside) == 0) continue;
+                const __m128 z = _mm_add_ps(_mm_mul_ps(depthA, centerX), rowDepth);
+                const __m128 current = _mm_loadu_ps(row + x);
+                const __m128 nearest = _mm_min_ps(current, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+            }
+        }
+#else
+        for(int y=startY; y<stopY; ++y) {
+            const float centerY = y + 0.5f;
+            float* row = &depth[y * stride];
+            for(int x=startX; x<stopX; ++x) {
+                const float centerX = x + 0.5f;
+                if (triangle.edgeA[0] * centerX + triangle.edgeB[0] * centerY + triangle.edgeC[0]<0) continue;
+                if (triangle.edgeA[1] * centerX + triangle.edgeB[1] * centerY + triangle.edgeC[1]<0) continue;
+                if (triangle.edgeA[2] * centerX + triangle.edgeB[2] * centerY + triangle.edgeC[2]<0) continue;
+                const float z = triangle.depthA * centerX + triangle.depthB * centerY + triangle.depthC;
+                if (z<row[x]) row[x] = z;
+            }
+        }
+#endif
+    }
+
+    float maxDepth = 0.0f;
+    for(int y=tileY; y<endY; ++y) {
+        const float* row = &depth[y * stride];
+        for(int x=tileX; x<endX; ++x) {
+            maxDepth = std::max(maxDepth, row[x]);
+        }
+    }
+    tileMaxDepth[tile] = maxDepth;
+}
+
+bool OcclusionBuffer::IsOccluded(const BoundingBox& box) const {
+    return IsOccluded(box.center, box.extends * 0.5f);
+}
+
+bool OcclusionBuffer::IsOccluded(const Vector3& center, const Vector3& half) const {
+    if (triangles.empty()) return false;
+    const Matrix4x4& m = viewProjection;
+
+    // corners are the clip space center plus or minus each clip space axis
+    float clipCenter[4], axisX[4], axisY[4], axisZ[4];
+    for(int r=0; r<4; ++r) {
+        clipCenter[r] = m[r][0] * center.x + m[r][1] * center.y + m[r][2] * center.z + m[r][3];
+        axisX[r] = m[r][0] * half.x;
+        axisY[r] = m[r][1] * half.y;
+        axisZ[r] = m[r][2] * half.z;
+    }
+
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, minZ = 1e30f;
+    for(int corner=0; corner<8; ++corner) {
+        const float sx = (corner & 1) ? 1.0f : -1.0f;
+        const float sy = (corner & 2) ? 1.0f : -1.0f;
+        const float sz = (corner & 4) ? 1.0f : -1.0f;
+        float clip[4];
+        for(int r=0; r<4; ++r) {
+            clip[r] = clipCenter[r] + sx * axisX[r] + sy * axisY[r] + sz * axisZ[r];
+        }
+        if (clip[3]<=0 || clip[2]<-clip[3]) return false;
+        const float invW = 1.0f / clip[3];
+        const float x = (clip[0] * invW * 0.5f + 0.5f) * width;
+        const float y = (clip[1] * invW * 0.5f + 0.5f) * height;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        minZ = std::min(minZ, clip[2] * invW);
+    }
+
+    if (maxX<0 || maxY<0 || minX>=width || minY>=height) return false;
+    // pixels are covered by their center, so a pixel at the edge of an occluder can be partly uncovered,
+    // the pixels around the box are tested as well, reaching past such edges
+    const int x0 = std::max(0, (int)std::floor(minX) - 1);
+    const int y0 = std::max(0, (int)std::floor(minY) - 1);
+    const int x1 = std::min(width - 1, (int)std::floor(maxX) + 1);
+    const int y1 = std::min(height - 1, (int)std::floor(maxY) + 1);
+    const float boxDepth = minZ - DepthBias;
+
+    for(int tileY = y0 / TileHeight; tileY<=y1 / TileHeight; ++tileY) {
+        for(int tileX = x0 / TileWidth; tileX<=x1 / TileWidth; ++tileX) {
+            if (boxDepth>tileMaxDepth[tileY * tilesX + tileX]) continue;
+            const int startX = std::max(x0, tileX * TileWidth);
+            const int stopX = std::min(x1, tileX * TileWidth + TileWidth - 1);
+            const int startY = std::max(y0, tileY * TileHeight);
+            const int stopY = std::min(y1, tileY * TileHeight + TileHeight - 1);
+            for(int y=startY; y<=stopY; ++y) {
+                const float* row = &depth[y * stride];
+                int x = startX;
+#if defined(__SSE2__)
+                const __m128 boxDepths = _mm_set1_ps(boxDepth);
+                for(; x + 3<=stopX; x+=4) {
+                    if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), boxDepths))) return false;
+                }
+#endif
+                for(; x<=stopX; ++x) {
+                    if (row[x]>=boxDepth) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
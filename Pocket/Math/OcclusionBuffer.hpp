@@ -0,0 +1,87 @@
+//
+//  OcclusionBuffer.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "Matrix4x4.hpp"
+#include "BoundingBox.hpp"
+#include <vector>
+
+namespace Pocket {
+    // Low resolution depth buffer filled on the cpu with the triangles of occluders, used to skip boxes hidden behind them.
+    // Triangles are binned into tiles which are rasterized independently, so tiles can run on separate threads.
+    // Testing does not modify the buffer, so several threads can test at once.
+    class OcclusionBuffer {
+    public:
+        static const int TileWidth = 32;
+        static const int TileHeight = 16;
+
+        OcclusionBuffer();
+
+        // Clears the triangles, tiles are cleared when rasterized.
+        void Begin(int width, int height, const Matrix4x4& viewProjection);
+
+        // Adds a triangle list in the space of world, triangles are clipped by the near plane and drawn double sided.
+        void AddTriangles(const Matrix4x4& world, const Vector3* positions, size_t positionCount, const short* indices, size_t indexCount);
+
+        int TileCount() const { return tilesX * tilesY; }
+        void RasterizeTile(int tile);
+
+        // True when the box is behind the rasterized triangles everywhere it covers the buffer.
+        // Boxes reaching the near plane or outside the buffer are never occluded.
+        bool IsOccluded(const Vector3& center, const Vector3& half) const;
+        bool IsOccluded(const BoundingBox& box) const;
+
+        // No triangles were added, nothing can be occluded.
+        bool IsEmpty() const { return triangles.empty(); }
+        size_t Triangles() const { return triangles.size(); }
+
+        int Width() const { return width; }
+        int Height() const { return height; }
+        // Depth in normalized device coordinates, 1 where nothing was drawn.
+        float Depth(int x, int y) const { return depth[y * stride + x]; }
+
+    private:
+        struct Triangle {
+            // Edge functions a * x + b * y + c, positive inside.
+            float edgeA[3];
+            float edgeB[3];
+            float edgeC[3];
+            // Depth plane z = depthA * x + depthB * y + depthC.
+            float depthA;
+            float depthB;
+            float depthC;
+            int minX;
+            int minY;
+            int maxX;
+            int maxY;
+        };
+
+        struct ClipVertex {
+            float x;
+            float y;
+            float z;
+            float w;
+        };
+
+        void AddTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+
+        int width;
+        int height;
+        // Rows are padded to a multiple of 4 pixels.
+        int stride;
+        int tilesX;
+        int tilesY;
+        Matrix4x4 viewProjection;
+        std::vector<float> depth;
+        // Farthest depth within each tile.
+        std::vector<float> tileMaxDepth;
+        std::vector<Triangle> triangles;
+        std::vector<std::vector<int>> bins;
+        std::vector<ClipVertex> clipVertices;
+    };
+}
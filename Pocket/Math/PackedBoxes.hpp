@@ -0,0 +1,85 @@
+//
+//  PackedBoxes.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "BoundingBox.hpp"
+#include <vector>
+
+namespace Pocket {
+    // Boxes stored as one array per coordinate of their centers and half sizes,
+    // so BoundingFrustum can test several boxes at once.
+    class PackedBoxes {
+    public:
+        size_t Size() const { return centerX.size(); }
+
+        void Resize(size_t size) {
+            centerX.resize(size);
+            centerY.resize(size);
+            centerZ.resize(size);
+            halfX.resize(size);
+            halfY.resize(size);
+            halfZ.resize(size);
+        }
+
+        void Reserve(size_t size) {
+            centerX.reserve(size);
+            centerY.reserve(size);
+            centerZ.reserve(size);
+            halfX.reserve(size);
+            halfY.reserve(size);
+            halfZ.reserve(size);
+        }
+
+        void Clear() {
+            Resize(0);
+        }
+
+        void Set(size_t index, const BoundingBox& box) {
+            centerX[index] = box.center.x;
+            centerY[index] = box.center.y;
+            centerZ[index] = box.center.z;
+            halfX[index] = box.extends.x * 0.5f;
+            halfY[index] = box.extends.y * 0.5f;
+            halfZ[index] = box.extends.z * 0.5f;
+        }
+
+        BoundingBox Get(size_t index) const {
+            return BoundingBox(Vector3(centerX[index], centerY[index], centerZ[index]),
+                               Vector3(halfX[index], halfY[index], halfZ[index]) * 2.0f);
+        }
+
+        void Copy(size_t to, size_t from) {
+            Copy(to, *this, from);
+        }
+
+        void Copy(size_t to, const PackedBoxes& source, size_t from) {
+            centerX[to] = source.centerX[from];
+            centerY[to] = source.centerY[from];
+            centerZ[to] = source.centerZ[from];
+            halfX[to] = source.halfX[from];
+            halfY[to] = source.halfY[from];
+            halfZ[to] = source.halfZ[from];
+        }
+
+        void Swap(PackedBoxes& other) {
+            centerX.swap(other.centerX);
+            centerY.swap(other.centerY);
+            centerZ.swap(other.centerZ);
+            halfX.swap(other.halfX);
+            halfY.swap(other.halfY);
+            halfZ.swap(other.halfZ);
+        }
+
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> halfX;
+        std::vector<float> halfY;
+        std::vector<float> halfZ;
+    };
+}
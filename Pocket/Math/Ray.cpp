@@ -9,6 +9,7 @@
 #include "Ray.hpp"
 #include "Matrix4x4.hpp"
 #include "BoundingBox.hpp"
+#include "PackedBoxes.hpp"
 #include <cmath>
 
 using namespace Pocket;
@@ -45,4 +46,32 @@ bool Ray::Intersect(const BoundingBox& box) const {
 	f = direction.x * Diff.y - direction.y * Diff.x;	if(fabsf(f)>box.extends.x*fAWdU[1] + box.extends.y*fAWdU[0])	return false;
     
 	return true;    
+}
+
+bool Ray::Intersect(const PackedBoxes& boxes, size_t index) const {
+    Vector3 Diff;
+    Vector3 extends;
+
+    Diff.x = position.x - boxes.centerX[index];
+    extends.x = boxes.halfX[index] * 2.0f;
+	if(fabsf(Diff.x)>extends.x && Diff.x*direction.x>=0.0f)	return false;
+
+    Diff.y = position.y - boxes.centerY[index];
+    extends.y = boxes.halfY[index] * 2.0f;
+	if(fabsf(Diff.y)>extends.y && Diff.y*direction.y>=0.0f)	return false;
+
+    Diff.z = position.z - boxes.centerZ[index];
+    extends.z = boxes.halfZ[index] * 2.0f;
+	if(fabsf(Diff.z)>extends.z && Diff.z*direction.z>=0.0f)	return false;
+
+	const float absX = fabsf(direction.x);
+	const float absY = fabsf(direction.y);
+	const float absZ = fabsf(direction.z);
+
+	float f;
+	f = direction.y * Diff.z - direction.z * Diff.y;	if(fabsf(f)>extends.y*absZ + extends.z*absY)	return false;
+	f = direction.z * Diff.x - direction.x * Diff.z;	if(fabsf(f)>extends.x*absZ + extends.z*absX)	return false;
+	f = direction.x * Diff.y - direction.y * Diff.x;	if(fabsf(f)>extends.x*absY + extends.y*absX)	return false;
+
+	return true;
 }
\ No newline at end of file
@@ -8,12 +8,17 @@
 
 #pragma once
 #include "Vector3.hpp"
+#include <cstddef>
 
 namespace Pocket {
     class Matrix4x4;
     class BoundingBox;
+    class PackedBoxes;
     class Ray {
     public:
+        // Queries taking several rays at once keep track of them in a 32 bit mask.
+        static const int MaxBatch = 32;
+
         Ray() {}
         ~Ray() {}
         
@@ -33,6 +38,8 @@ namespace Pocket {
                 
         void Transform(const Pocket::Matrix4x4 &matrix);
         bool Intersect(const BoundingBox& box) const;
+        // Same test against one of the packed boxes, without gathering the box first.
+        bool Intersect(const PackedBoxes& boxes, size_t index) const;
         
         Vector3 position;
         Vector3 direction;
@@ -49,6 +49,17 @@ extern PFNGLUNMAPBUFFEROESPROC glUnmapBuffer;
     #include <EGL/egl.h>
     #include <GLES2/gl2.h>
 
+    #define DISABLE_MAP_BUFFER
+
+#elif __linux__
+
+#define GL_GLEXT_PROTOTYPES
+    #include <GL/gl.h>
+    #include <GL/glext.h>
+    #define OPENGL_DESKTOP
+
+#define DISABLE_MAP_BUFFER
+
 #else
 
     #include <OpenGL/gl.h>
@@ -0,0 +1,30 @@
+//
+//  AppMenu.cpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "AppMenu.hpp"
+
+using namespace Pocket;
+
+AppMenu::AppMenu() { }
+AppMenu::~AppMenu() { }
+
+AppMenu& AppMenu::AddChild(const std::string& text, const std::string& shortcut) {
+    return *this;
+}
+
+void AppMenu::ShowPopup(const Vector2& location) {
+    
+}
+
+void AppMenu::CreateAppMenu(AppMenu* parent, const std::string& text, const std::string& shortcut) {
+
+}
+
+void AppMenu::InitializeMainMenu() {}
+void AppMenu::InitializePopUp() {}
+void AppMenu::Clear() {}
@@ -0,0 +1,107 @@
+//
+//  FileReader.cpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "FileReader.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <limits.h>
+#include <fstream>
+#include <iostream>
+
+using namespace Pocket;
+using namespace std;
+
+vector<string> FileReader::RunCommmand(const string &cmd) {
+    FILE*           fp;
+    const int       SIZEBUF = 1234;
+    char            buf [SIZEBUF];
+    vector<string> out;
+    
+    if ((fp = popen(cmd.c_str (), "r")) == NULL) {
+        return out;
+    }
+    string cur_string = "";
+    while (fgets(buf, sizeof (buf), fp)) {
+        cur_string += buf;
+    }
+    out.push_back(cur_string.substr (0, cur_string.size () - 1));
+    pclose(fp);
+    return out;
+}
+
+std::string FileReader::GetFile(std::string localFile) {
+    return localFile;
+}
+
+std::string FileReader::GetWritablePath() {
+    const char* home = getenv("HOME");
+    return home ? home : ".";
+}
+
+std::string FileReader::GetExecutablePath() {
+    char path[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length<=0) return "";
+    return std::string(path, length);
+}
+
+std::string FileReader::GetBundlePath() {
+    return GetExecutablePath();
+}
+
+std::string FileReader::GetBundleDir() {
+    std::string bundlePath = GetBundlePath();
+    auto pos = bundlePath.rfind('/');
+    if (pos == std::string::npos) return "";
+    return bundlePath.substr(0, pos + 1);
+}
+
+std::vector<std::string> FileReader::ShowOpenFileRequester(const std::string &, bool, bool) {
+    return std::vector<std::string>();
+}
+
+std::string FileReader::ShowSaveFileRequester(const std::string &) {
+    return "";
+}
+
+// xdg-open is started without a shell so the path is passed as is,
+// the intermediate child exits at once and the opener is reparented to init.
+void FileReader::OpenPathInFileExplorer(const std::string &path) {
+    pid_t child = fork();
+    if (child == 0) {
+        if (fork() == 0) {
+            execlp("xdg-open", "xdg-open", path.c_str(), (char*)nullptr);
+        }
+        _exit(0);
+    }
+    if (child>0) {
+        waitpid(child, nullptr, 0);
+    }
+}
+
+void FileReader::ShowMessageBox(const std::string &message) {
+    std::cout << message << std::endl;
+}
+
+std::string FileReader::ShowMessageTextBox(const std::string &, const std::string &) {
+    return "";
+}
+
+void FileReader::ParseFile(const std::string& filename, const std::function<void(const std::string& line)>& lineRead) {
+    std::ifstream file(filename);
+    std::string line;
+    if (file.is_open())
+    {
+        while ( std::getline (file,line) ) {
+            lineRead(line);
+        }
+        file.close();
+    }
+}
@@ -0,0 +1,187 @@
+//
+//  NullGL.cpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "NullGL.hpp"
+#include "OpenGL.hpp"
+#include <cstring>
+
+using namespace Pocket;
+
+namespace {
+    struct Function {
+        Function(const char* name);
+        const char* name;
+        size_t calls;
+        Function* next;
+    };
+
+    Function* functions = 0;
+    NullGL::Counters counters = { 0, 0, 0, 0, 0 };
+    bool recording = false;
+    std::vector<const char*> recordedCalls;
+    GLuint nextName = 0;
+
+    Function::Function(const char* name) : name(name), calls(0), next(functions) {
+        functions = this;
+    }
+
+    void Record(Function& function) {
+        function.calls++;
+        counters.calls++;
+        if (recording) {
+            recordedCalls.push_back(function.name);
+        }
+    }
+
+    void GenNames(GLsizei n, GLuint* names) {
+        for(GLsizei i=0; i<n; ++i) {
+            names[i] = ++nextName;
+        }
+    }
+
+    size_t BytesPerPixel(GLenum format) {
+        switch (format) {
+            case GL_RGBA: return 4;
+            case GL_RGB: return 3;
+            case GL_LUMINANCE_ALPHA: return 2;
+            default: return 1;
+        }
+    }
+}
+
+#define NULL_GL_RECORD(name) static Function function(#name); Record(function)
+
+const NullGL::Counters& NullGL::GetCounters() { return counters; }
+
+size_t NullGL::CallCount(const std::string& name) {
+    for(Function* function = functions; function; function = function->next) {
+        if (name == function->name) return function->calls;
+    }
+    return 0;
+}
+
+void NullGL::SetRecording(bool record) {
+    recording = record;
+}
+
+const std::vector<const char*>& NullGL::RecordedCalls() { return recordedCalls; }
+
+void NullGL::Reset() {
+    for(Function* function = functions; function; function = function->next) {
+        function->calls = 0;
+    }
+    counters = { 0, 0, 0, 0, 0 };
+    recordedCalls.clear();
+}
+
+extern "C" {
+
+// Buffers
+void glGenBuffers(GLsizei n, GLuint* buffers) { NULL_GL_RECORD(glGenBuffers); GenNames(n, buffers); }
+void glDeleteBuffers(GLsizei n, const GLuint* buffers) { NULL_GL_RECORD(glDeleteBuffers); }
+void glBindBuffer(GLenum target, GLuint buffer) { NULL_GL_RECORD(glBindBuffer); }
+void glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    NULL_GL_RECORD(glBufferData);
+    if (data) counters.bufferBytesUploaded += (size_t)size;
+}
+void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    NULL_GL_RECORD(glBufferSubData);
+    if (data) counters.bufferBytesUploaded += (size_t)size;
+}
+void* glMapBuffer(GLenum target, GLenum access) { NULL_GL_RECORD(glMapBuffer); return 0; }
+GLboolean glUnmapBuffer(GLenum target) { NULL_GL_RECORD(glUnmapBuffer); return GL_TRUE; }
+void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) { NULL_GL_RECORD(glVertexAttribPointer); }
+void glEnableVertexAttribArray(GLuint index) { NULL_GL_RECORD(glEnableVertexAttribArray); }
+
+// Drawing
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices) {
+    NULL_GL_RECORD(glDrawElements);
+    counters.drawCalls++;
+    counters.indicesDrawn += (size_t)count;
+}
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) { NULL_GL_RECORD(glViewport); }
+void glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha) { NULL_GL_RECORD(glClearColor); }
+void glClear(GLbitfield mask) { NULL_GL_RECORD(glClear); }
+void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels) {
+    NULL_GL_RECORD(glReadPixels);
+    if (pixels) std::memset(pixels, 0, (size_t)width * height * BytesPerPixel(format));
+}
+
+// State
+void glEnable(GLenum cap) { NULL_GL_RECORD(glEnable); }
+void glDisable(GLenum cap) { NULL_GL_RECORD(glDisable); }
+void glCullFace(GLenum mode) { NULL_GL_RECORD(glCullFace); }
+void glDepthFunc(GLenum func) { NULL_GL_RECORD(glDepthFunc); }
+void glDepthMask(GLboolean flag) { NULL_GL_RECORD(glDepthMask); }
+void glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) { NULL_GL_RECORD(glColorMask); }
+void glBlendFunc(GLenum sfactor, GLenum dfactor) { NULL_GL_RECORD(glBlendFunc); }
+void glStencilFunc(GLenum func, GLint ref, GLuint mask) { NULL_GL_RECORD(glStencilFunc); }
+void glStencilOp(GLenum fail, GLenum zfail, GLenum zpass) { NULL_GL_RECORD(glStencilOp); }
+void glScissor(GLint x, GLint y, GLsizei width, GLsizei height) { NULL_GL_RECORD(glScissor); }
+void glPixelStorei(GLenum pname, GLint param) { NULL_GL_RECORD(glPixelStorei); }
+GLenum glGetError() { return GL_NO_ERROR; }
+
+// Textures
+void glGenTextures(GLsizei n, GLuint* textures) { NULL_GL_RECORD(glGenTextures); GenNames(n, textures); }
+void glDeleteTextures(GLsizei n, const GLuint* textures) { NULL_GL_RECORD(glDeleteTextures); }
+void glBindTexture(GLenum target, GLuint texture) { NULL_GL_RECORD(glBindTexture); }
+void glActiveTexture(GLenum texture) { NULL_GL_RECORD(glActiveTexture); }
+void glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels) {
+    NULL_GL_RECORD(glTexImage2D);
+    if (pixels) counters.textureBytesUploaded += (size_t)width * height * BytesPerPixel(format);
+}
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels) {
+    NULL_GL_RECORD(glTexSubImage2D);
+    if (pixels) counters.textureBytesUploaded += (size_t)width * height * BytesPerPixel(format);
+}
+void glTexParameteri(GLenum target, GLenum pname, GLint param) { NULL_GL_RECORD(glTexParameteri); }
+void glGetTexImage(GLenum target, GLint level, GLenum format, GLenum type, GLvoid* pixels) { NULL_GL_RECORD(glGetTexImage); }
+void glGenerateMipmap(GLenum target) { NULL_GL_RECORD(glGenerateMipmap); }
+
+// Framebuffers
+void glGenFramebuffers(GLsizei n, GLuint* framebuffers) { NULL_GL_RECORD(glGenFramebuffers); GenNames(n, framebuffers); }
+void glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) { NULL_GL_RECORD(glDeleteFramebuffers); }
+void glBindFramebuffer(GLenum target, GLuint framebuffer) { NULL_GL_RECORD(glBindFramebuffer); }
+void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) { NULL_GL_RECORD(glFramebufferTexture2D); }
+GLenum glCheckFramebufferStatus(GLenum target) { NULL_GL_RECORD(glCheckFramebufferStatus); return GL_FRAMEBUFFER_COMPLETE; }
+void glDrawBuffers(GLsizei n, const GLenum* bufs) { NULL_GL_RECORD(glDrawBuffers); }
+
+// Shaders, compile and link always succeed, programs have no attributes or uniforms
+GLuint glCreateShader(GLenum type) { NULL_GL_RECORD(glCreateShader); return ++nextName; }
+void glDeleteShader(GLuint shader) { NULL_GL_RECORD(glDeleteShader); }
+void glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) { NULL_GL_RECORD(glShaderSource); }
+void glCompileShader(GLuint shader) { NULL_GL_RECORD(glCompileShader); }
+void glGetShaderiv(GLuint shader, GLenum pname, GLint* params) { NULL_GL_RECORD(glGetShaderiv); *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0; }
+void glGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog) { NULL_GL_RECORD(glGetShaderInfoLog); if (bufSize>0) infoLog[0] = 0; }
+GLuint glCreateProgram() { NULL_GL_RECORD(glCreateProgram); return ++nextName; }
+void glDeleteProgram(GLuint program) { NULL_GL_RECORD(glDeleteProgram); }
+void glAttachShader(GLuint program, GLuint shader) { NULL_GL_RECORD(glAttachShader); }
+void glLinkProgram(GLuint program) { NULL_GL_RECORD(glLinkProgram); }
+void glUseProgram(GLuint program) { NULL_GL_RECORD(glUseProgram); }
+void glGetProgramiv(GLuint program, GLenum pname, GLint* params) { NULL_GL_RECORD(glGetProgramiv); *params = pname == GL_LINK_STATUS ? GL_TRUE : 0; }
+void glGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog) { NULL_GL_RECORD(glGetProgramInfoLog); if (bufSize>0) infoLog[0] = 0; }
+void glGetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) { NULL_GL_RECORD(glGetActiveAttrib); }
+void glGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) { NULL_GL_RECORD(glGetActiveUniform); }
+GLint glGetAttribLocation(GLuint program, const GLchar* name) { NULL_GL_RECORD(glGetAttribLocation); return -1; }
+GLint glGetUniformLocation(GLuint program, const GLchar* name) { NULL_GL_RECORD(glGetUniformLocation); return -1; }
+void glUniform1f(GLint location, GLfloat v0) { NULL_GL_RECORD(glUniform1f); }
+void glUniform1i(GLint location, GLint v0) { NULL_GL_RECORD(glUniform1i); }
+void glUniform2f(GLint location, GLfloat v0, GLfloat v1) { NULL_GL_RECORD(glUniform2f); }
+void glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) { NULL_GL_RECORD(glUniform3f); }
+void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) { NULL_GL_RECORD(glUniform4f); }
+void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) { NULL_GL_RECORD(glUniformMatrix4fv); }
+
+// Queries, results are available immediately and measure no time
+void glGenQueries(GLsizei n, GLuint* ids) { NULL_GL_RECORD(glGenQueries); GenNames(n, ids); }
+void glDeleteQueries(GLsizei n, const GLuint* ids) { NULL_GL_RECORD(glDeleteQueries); }
+void glBeginQuery(GLenum target, GLuint id) { NULL_GL_RECORD(glBeginQuery); }
+void glEndQuery(GLenum target) { NULL_GL_RECORD(glEndQuery); }
+void glGetQueryObjectiv(GLuint id, GLenum pname, GLint* params) { NULL_GL_RECORD(glGetQueryObjectiv); *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0; }
+void glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) { NULL_GL_RECORD(glGetQueryObjectui64v); *params = 0; }
+
+}
@@ -0,0 +1,40 @@
+//
+//  NullGL.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace Pocket {
+    // GL implementation for headless builds, no driver or GPU is needed.
+    // Every GL entry point used by the engine is a no-op which is counted,
+    // draw calls and uploaded bytes are tallied for tests and benchmarks.
+    class NullGL {
+    public:
+        struct Counters {
+            size_t calls;
+            size_t drawCalls;
+            size_t indicesDrawn;
+            size_t bufferBytesUploaded;
+            size_t textureBytesUploaded;
+        };
+        
+        static const Counters& GetCounters();
+        
+        // Number of calls made to the GL function with the given name, ie "glDrawElements".
+        static size_t CallCount(const std::string& function);
+        
+        // When recording, the name of every GL call is appended to RecordedCalls().
+        static void SetRecording(bool recording);
+        static const std::vector<const char*>& RecordedCalls();
+        
+        // Clears counters and recorded calls.
+        static void Reset();
+    };
+}
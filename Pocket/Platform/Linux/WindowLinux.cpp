@@ -0,0 +1,67 @@
+//
+//  WindowLinux.cpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "WindowLinux.hpp"
+#include "OpenGL.hpp"
+#include <cstdlib>
+#include <thread>
+
+using namespace Pocket;
+
+static int EnvironmentInt(const char* name, int defaultValue) {
+    const char* value = std::getenv(name);
+    return value ? std::atoi(value) : defaultValue;
+}
+
+WindowLinux::WindowLinux() : frame(0) {
+    FrameLimit = EnvironmentInt("POCKET_HEADLESS_FRAMES", 0);
+    FrameRate = EnvironmentInt("POCKET_HEADLESS_FPS", 60);
+}
+
+void WindowLinux::Create(int width, int height, bool fullScreen) {
+    context->ScreenSize = Vector2((float)width, (float)height);
+    inputDevice().Initialize(3);
+    frame = 0;
+}
+
+void WindowLinux::Destroy() { }
+
+bool WindowLinux::Update() {
+    return FrameLimit <= 0 || frame < FrameLimit;
+}
+
+void WindowLinux::PreRender() {
+    const Vector2& screenSize = context->ScreenSize;
+    glViewport(0, 0, (GLsizei)screenSize.x, (GLsizei)screenSize.y);
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void WindowLinux::PostRender() {
+    frame++;
+}
+
+void WindowLinux::Begin() {
+    nextFrameTime = std::chrono::steady_clock::now();
+    while (!Step()) {
+        if (FrameRate<=0) continue;
+        nextFrameTime += std::chrono::microseconds(1000000 / FrameRate);
+        auto now = std::chrono::steady_clock::now();
+        if (nextFrameTime>now) {
+            std::this_thread::sleep_until(nextFrameTime);
+        } else {
+            nextFrameTime = now;
+        }
+    }
+}
+
+int WindowLinux::Frame() const { return frame; }
+
+InputDevice& WindowLinux::inputDevice() {
+    return context->InputDevice();
+}
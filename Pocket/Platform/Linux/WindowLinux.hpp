@@ -0,0 +1,43 @@
+//
+//  WindowLinux.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "Window.hpp"
+#include "InputDevice.hpp"
+#include <chrono>
+
+namespace Pocket {
+    // Headless window, runs the main loop without a display or GL context.
+    // Used for build servers and game servers, GL calls go to NullGL.
+    class WindowLinux : public Pocket::Window {
+    public:
+        WindowLinux();
+        
+        void Create(int width, int height, bool fullScreen);
+        void Destroy();
+        bool Update();
+        void PreRender();
+        void PostRender();
+        void Begin();
+        
+        // Number of frames to run before the loop exits, 0 runs until the game exits.
+        // Defaults to the POCKET_HEADLESS_FRAMES environment variable.
+        int FrameLimit;
+        
+        // Frames per second the loop is paced at, 0 runs frames back to back.
+        // Defaults to the POCKET_HEADLESS_FPS environment variable, or 60.
+        int FrameRate;
+        
+        int Frame() const;
+        
+    private:
+        int frame;
+        std::chrono::steady_clock::time_point nextFrameTime;
+        InputDevice& inputDevice();
+    };
+}
@@ -17,8 +17,6 @@
 using namespace Pocket;
 
 BigButtonManager::BigButtonManager() : device(0), interface(0) {
-    thread.Code.Bind(this, &BigButtonManager::PollLoop);
-    
     for (int i=0; i<4; i++) {
         controller[i].timeSinceButtonClick = 0;
         controller[i].buttonsChanged = false;
@@ -122,7 +120,7 @@ if (ret != kIOReturnSuccess)
     device = usbDevice;
     interface = usbInterface;
     
-    thread.Start();
+    thread = std::thread(&BigButtonManager::PollLoop, this);
     
     return true;
 }
@@ -137,7 +135,9 @@ void BigButtonManager::Destroy() {
         (*usbDevice)->USBDeviceClose(usbDevice);
     }
     
-    thread.Stop();
+    if (thread.joinable()) {
+        thread.detach();
+    }
 }
 
 void callback(void *refcon, IOReturn result, void *arg0) {
@@ -190,22 +190,22 @@ void BigButtonManager::Controller::Update(BigButtonManager* manager, float dt) {
 
     //std::cout<<"Update"<<std::endl;
     bool hasChange = false;
-    Thread::Lock();
+    manager->mutex.lock();
     if (buttonsChanged) {
         hasChange = true;
         timeSinceButtonClick = 0;
         buttonsChanged = false;
         currentDowns = downs;
     }
-    Thread::Unlock();
+    manager->mutex.unlock();
     if (!hasChange) {
         if (timeSinceButtonClick<0.15f) {
             timeSinceButtonClick+=dt;
             return;
         } else {
-            Thread::Lock();
+            manager->mutex.lock();
             downs.clear();
-            Thread::Unlock();
+            manager->mutex.unlock();
             previousDowns = currentDowns;
             currentDowns.clear();
             timeSinceButtonClick = 0;
@@ -229,7 +229,7 @@ void BigButtonManager::Controller::Update(BigButtonManager* manager, float dt) {
     previousDowns = currentDowns;
 }
 
-void BigButtonManager::PollLoop(Thread* thread) {
+void BigButtonManager::PollLoop() {
 
     IOUSBInterfaceInterface300** usbInterface = (IOUSBInterfaceInterface300**)interface;
     IOUSBInterfaceInterface300* inter = *usbInterface;
@@ -277,7 +277,7 @@ void BigButtonManager::UpdateButtonStates() {
     char inputData3 = inputData[3];
     char inputData4 = inputData[4];
     
-    Thread::Lock();
+    mutex.lock();
     
     controller[playerIndex].buttonsChanged = true;
     
@@ -295,7 +295,7 @@ void BigButtonManager::UpdateButtonStates() {
     SetButtonDown(playerIndex, BigButtonButton::BigButton, (inputData4 & 0x08) == 0x08);
     SetButtonDown(playerIndex, BigButtonButton::Xbox, (inputData4 & 0x04) == 0x04);
    
-    Thread::Unlock();
+    mutex.unlock();
 }
 
 void BigButtonManager::SetButtonDown(int playerIndex, BigButtonButton button, bool isDown) {
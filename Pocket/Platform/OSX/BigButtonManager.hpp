@@ -10,7 +10,8 @@
 #include "Event.hpp"
 #include <set>
 #include <map>
-#include "Thread.hpp"
+#include <thread>
+#include <mutex>
 #include "Timer.hpp"
 
 namespace Pocket {
@@ -90,10 +91,11 @@ namespace Pocket {
         void* interface;
       
         char inputData[5];
-        Thread thread;
+        std::thread thread;
+        std::mutex mutex;
         Controller controller[4];
       
-        void PollLoop(Thread* thread);
+        void PollLoop();
         void UpdateButtonStates();
         void SetButtonDown(int playerIndex, BigButtonButton button, bool isDown);
     };
@@ -8,56 +8,232 @@
 
 #include "Clipper.hpp"
 #include "OpenGL.hpp"
+#include <cmath>
+#include <algorithm>
 
 using namespace Pocket;
 
-Clipper::Clipper() { stackCount = 0; UseDepth = false; }
+Clipper::Clipper() : stencilDepth(0), scissorApplied(false), viewProjection(Matrix4x4::IDENTITY) { UseDepth = false; }
 
 Clipper::~Clipper() {}
 
+// Stencil values count the stencil regions a pixel is inside, so a region only needs clearing
+// when the outermost one is pushed, and popping decrements back to the parent's value.
 void Clipper::PushBegin() {
     
-    if (stackCount==0) {
-        glEnable(GL_STENCIL_TEST);
+    if (scissorApplied) {
+        glDisable(GL_SCISSOR_TEST); // push and pop shapes must touch the same pixels
+        scissorApplied = false;
     }
     
-    stackCount++;
+    if (stencilDepth==0) {
+        glEnable(GL_STENCIL_TEST);
+        glClear(GL_STENCIL_BUFFER_BIT);
+    }
     
-    glClear(GL_STENCIL_BUFFER_BIT);
     glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
     glDepthMask(GL_FALSE);
-    glStencilFunc(GL_ALWAYS, stackCount, stackCount);
-    glStencilOp(GL_INCR, GL_INCR, GL_INCR);
-        
+    glStencilFunc(GL_EQUAL, stencilDepth, 0xFF);
+    glStencilOp(GL_KEEP, GL_INCR, GL_INCR);
+    
+    Region region;
+    region.isRect = false;
+    region.hasScissor = !regions.empty() && regions.back().hasScissor;
+    if (region.hasScissor) {
+        region.scissor = regions.back().scissor;
+    }
+    regions.push_back(region);
+    stencilDepth++;
 }
 
 void Clipper::PushEnd() {
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glDepthMask(UseDepth ? GL_TRUE : GL_FALSE);
-    glStencilFunc(GL_EQUAL, stackCount, stackCount);
+    glStencilFunc(GL_EQUAL, stencilDepth, 0xFF);
     glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 }
 
 void Clipper::PopBegin() {
-    if (stackCount == 0) return;
+    if (regions.empty() || regions.back().isRect) return;
     
-    stackCount--;
+    if (scissorApplied) {
+        glDisable(GL_SCISSOR_TEST);
+        scissorApplied = false;
+    }
     
     glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
     glDepthMask(GL_FALSE);
-    glStencilFunc(GL_ALWAYS, stackCount, stackCount);
-    glStencilOp(GL_DECR, GL_DECR, GL_DECR);
+    glStencilFunc(GL_EQUAL, stencilDepth, 0xFF);
+    glStencilOp(GL_KEEP, GL_DECR, GL_DECR);
+    
+    regions.pop_back();
+    stencilDepth--;
 }
 
-
 void Clipper::PopEnd() {
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glDepthMask(UseDepth ? GL_TRUE : GL_FALSE);
     
-    if (stackCount==0) {
+    if (stencilDepth==0) {
         glDisable(GL_STENCIL_TEST);
+    } else {
+        glStencilFunc(GL_EQUAL, stencilDepth, 0xFF);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
     }
 }
 
+void Clipper::SetView(const Matrix4x4& viewProjection, const Rect& viewport) {
+    this->viewProjection = viewProjection;
+    this->viewport = viewport;
+}
+
+// Projects corners to window pixels, bounds is set to min x, min y, max x, max y.
+// Returns false when a corner is behind the camera.
+bool Clipper::ScreenBounds(const Matrix4x4& worldViewProjection, const Vector3* corners, int count, Vector2* points, float* bounds) const {
+    bounds[0] = bounds[1] = 1e30f;
+    bounds[2] = bounds[3] = -1e30f;
+    for(int i=0; i<count; ++i) {
+        const Vector3& p = corners[i];
+        float w = worldViewProjection[3][0] * p.x + worldViewProjection[3][1] * p.y + worldViewProjection[3][2] * p.z + worldViewProjection[3][3];
+        if (w<=0.00001f) return false;
+        float x = (worldViewProjection[0][0] * p.x + worldViewProjection[0][1] * p.y + worldViewProjection[0][2] * p.z + worldViewProjection[0][3]) / w;
+        float y = (worldViewProjection[1][0] * p.x + worldViewProjection[1][1] * p.y + worldViewProjection[1][2] * p.z + worldViewProjection[1][3]) / w;
+        Vector2& point = points[i];
+        point.x = viewport.x + (x * 0.5f + 0.5f) * viewport.width;
+        point.y = viewport.y + (y * 0.5f + 0.5f) * viewport.height;
+        bounds[0] = std::min(bounds[0], point.x);
+        bounds[1] = std::min(bounds[1], point.y);
+        bounds[2] = std::max(bounds[2], point.x);
+        bounds[3] = std::max(bounds[3], point.y);
+    }
+    return true;
+}
+
+bool Clipper::PushRect(const Matrix4x4& world, const Vector3& min, const Vector3& max) {
+    if (viewport.width<=0 || viewport.height<=0) return false; // no view was set
+    const Matrix4x4 worldViewProjection = viewProjection.Multiply(world);
+    const Vector3 corners[4] = {
+        Vector3(min.x, min.y, min.z),
+        Vector3(max.x, min.y, min.z),
+        Vector3(max.x, max.y, min.z),
+        Vector3(min.x, max.y, min.z),
+    };
+    
+    Vector2 points[4];
+    float bounds[4];
+    if (!ScreenBounds(worldViewProjection, corners, 4, points, bounds)) return false;
+    
+    // every corner must lie on the edges of the bounds, otherwise the rectangle is rotated or in perspective
+    const float tolerance = 0.01f;
+    for(int i=0; i<4; ++i) {
+        bool onX = std::abs(points[i].x - bounds[0])<=tolerance || std::abs(points[i].x - bounds[2])<=tolerance;
+        bool onY = std::abs(points[i].y - bounds[1])<=tolerance || std::abs(points[i].y - bounds[3])<=tolerance;
+        if (!onX || !onY) return false;
+    }
+    
+    // pixels are covered when their centers are inside
+    Region region;
+    region.isRect = true;
+    region.hasScissor = true;
+    region.scissor.x0 = (int)std::floor(bounds[0] + 0.5f);
+    region.scissor.y0 = (int)std::floor(bounds[1] + 0.5f);
+    region.scissor.x1 = (int)std::floor(bounds[2] + 0.5f);
+    region.scissor.y1 = (int)std::floor(bounds[3] + 0.5f);
+    if (!regions.empty() && regions.back().hasScissor) {
+        const Scissor& parent = regions.back().scissor;
+        region.scissor.x0 = std::max(region.scissor.x0, parent.x0);
+        region.scissor.y0 = std::max(region.scissor.y0, parent.y0);
+        region.scissor.x1 = std::min(region.scissor.x1, parent.x1);
+        region.scissor.y1 = std::min(region.scissor.y1, parent.y1);
+    }
+    regions.push_back(region);
+    return true;
+}
+
+void Clipper::PopRect() {
+    if (regions.empty() || !regions.back().isRect) return;
+    regions.pop_back();
+}
+
+bool Clipper::Empty() const {
+    return regions.empty();
+}
+
+bool Clipper::TopIsRect() const {
+    return !regions.empty() && regions.back().isRect;
+}
 
+bool Clipper::NeedsCheck() const {
+    return scissorApplied || (!regions.empty() && regions.back().hasScissor);
+}
 
+Clipper::Visibility Clipper::Check(const Matrix4x4& world, const BoundingBox& localBox) const {
+    const bool hasScissor = !regions.empty() && regions.back().hasScissor;
+    const bool scissorMatches = hasScissor ? scissorApplied && appliedScissor == regions.back().scissor : !scissorApplied;
+    
+    const Vector3 halfExtents = localBox.extends * 0.5f;
+    const Vector3 min = localBox.center - halfExtents;
+    const Vector3 max = localBox.center + halfExtents;
+    const Vector3 corners[8] = {
+        Vector3(min.x, min.y, min.z), Vector3(max.x, min.y, min.z),
+        Vector3(max.x, max.y, min.z), Vector3(min.x, max.y, min.z),
+        Vector3(min.x, min.y, max.z), Vector3(max.x, min.y, max.z),
+        Vector3(max.x, max.y, max.z), Vector3(min.x, max.y, max.z),
+    };
+    Vector2 points[8];
+    float bounds[4];
+    if (!ScreenBounds(viewProjection.Multiply(world), corners, 8, points, bounds)) {
+        return scissorMatches ? Visibility::Visible : Visibility::NeedsScissor;
+    }
+    
+    if (hasScissor) {
+        const Scissor& scissor = regions.back().scissor;
+        if (bounds[2]<=scissor.x0 || bounds[0]>=scissor.x1 ||
+            bounds[3]<=scissor.y0 || bounds[1]>=scissor.y1) {
+            return Visibility::Outside;
+        }
+        if (scissorMatches) return Visibility::Visible;
+        bool inside = bounds[0]>=scissor.x0 && bounds[2]<=scissor.x1 && bounds[1]>=scissor.y0 && bounds[3]<=scissor.y1;
+        if (!inside) return Visibility::NeedsScissor;
+    } else if (scissorMatches) {
+        return Visibility::Visible;
+    }
+    
+    // objects inside the region are drawn the same under a stale scissor rectangle that contains them
+    if (scissorApplied) {
+        bool insideApplied = bounds[0]>=appliedScissor.x0 && bounds[2]<=appliedScissor.x1 &&
+                             bounds[1]>=appliedScissor.y0 && bounds[3]<=appliedScissor.y1;
+        if (!insideApplied) return Visibility::NeedsScissor;
+    }
+    return Visibility::Visible;
+}
+
+void Clipper::ApplyScissor() {
+    const bool hasScissor = !regions.empty() && regions.back().hasScissor;
+    if (!hasScissor) {
+        if (scissorApplied) {
+            glDisable(GL_SCISSOR_TEST);
+            scissorApplied = false;
+        }
+        return;
+    }
+    const Scissor& scissor = regions.back().scissor;
+    if (!scissorApplied) {
+        glEnable(GL_SCISSOR_TEST);
+        scissorApplied = true;
+    }
+    appliedScissor = scissor;
+    glScissor(scissor.x0, scissor.y0, std::max(scissor.x1 - scissor.x0, 0), std::max(scissor.y1 - scissor.y0, 0));
+}
+
+void Clipper::Reset() {
+    if (scissorApplied) {
+        glDisable(GL_SCISSOR_TEST);
+        scissorApplied = false;
+    }
+    if (stencilDepth>0) {
+        glDisable(GL_STENCIL_TEST);
+        stencilDepth = 0;
+    }
+    regions.clear();
+}
@@ -5,21 +5,83 @@
 //  Created by Jeppe Nielsen on 10/13/13.
 //  Copyright (c) 2013 Jeppe Nielsen. All rights reserved.
 //
+#pragma once
+#include <vector>
+#include "Matrix4x4.hpp"
+#include "BoundingBox.hpp"
+#include "Rect.hpp"
+
 namespace Pocket {
+    // Clip regions are pushed and popped while drawing, nested regions are clipped by their parents.
+    // Regions covering an axis aligned rectangle on screen use the scissor test and draw nothing,
+    // other shapes are drawn into the stencil buffer between Begin and End.
     class Clipper {
     public:
         Clipper();
         ~Clipper();
         
+        // Stencil regions, the shape is drawn between Begin and End with color and depth writes off.
         void PushBegin();
         void PushEnd();
         void PopBegin();
         void PopEnd();
         
+        // View used to find the screen rectangles of rectangle regions and objects.
+        void SetView(const Matrix4x4& viewProjection, const Rect& viewport);
+        
+        // Pushes the local xy rectangle from min to max, returns false when it is not axis aligned on screen.
+        // Nothing is drawn, the scissor rectangle is applied when an object needs it.
+        bool PushRect(const Matrix4x4& world, const Vector3& min, const Vector3& max);
+        void PopRect();
+        
+        bool Empty() const;
+        bool TopIsRect() const;
+        
+        enum class Visibility {
+            // Entirely clipped, skip it.
+            Outside,
+            // Drawn correctly with the current gl state.
+            Visible,
+            // Flush, then ApplyScissor before drawing it.
+            NeedsScissor,
+        };
+        
+        // Objects only have to be checked when inside a rectangle region, or while a scissor rectangle is still applied.
+        bool NeedsCheck() const;
+        Visibility Check(const Matrix4x4& world, const BoundingBox& localBox) const;
+        void ApplyScissor();
+        
+        // Turns off the scissor and stencil tests and forgets unbalanced pushes.
+        void Reset();
+        
         bool UseDepth;
         
     private:
-        int stackCount;
+        // Window pixels from x0,y0 up to x1,y1.
+        struct Scissor {
+            int x0;
+            int y0;
+            int x1;
+            int y1;
+            bool operator==(const Scissor& other) const {
+                return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1;
+            }
+        };
+        
+        struct Region {
+            bool isRect;
+            // Intersection of this and all parent rectangle regions.
+            bool hasScissor;
+            Scissor scissor;
+        };
+        
+        bool ScreenBounds(const Matrix4x4& worldViewProjection, const Vector3* corners, int count, Vector2* points, float* bounds) const;
         
+        std::vector<Region> regions;
+        int stencilDepth;
+        bool scissorApplied;
+        Scissor appliedScissor;
+        Matrix4x4 viewProjection;
+        Rect viewport;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,84 @@
+//
+//  GpuTimer.cpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "GpuTimer.hpp"
+
+using namespace Pocket;
+
+#if defined(OPENGL_DESKTOP) && defined(GL_TIME_ELAPSED)
+#define GPU_TIMER_QUERIES
+#endif
+
+GpuTimer::GpuTimer() : current(0), created(false), measuring(false), elapsed(-1.0) {
+    for(int i=0; i<QueryCount; ++i) {
+        queries[i] = 0;
+        pending[i] = false;
+    }
+}
+
+GpuTimer::~GpuTimer() {
+#ifdef GPU_TIMER_QUERIES
+    if (created) {
+        glDeleteQueries(QueryCount, queries);
+    }
+#endif
+}
+
+bool GpuTimer::IsSupported() {
+#ifdef GPU_TIMER_QUERIES
+    return true;
+#else
+    return false;
+#endif
+}
+
+void GpuTimer::Begin() {
+#ifdef GPU_TIMER_QUERIES
+    if (!created) {
+        glGenQueries(QueryCount, queries);
+        created = true;
+    }
+    Poll();
+    // when the gpu is more than QueryCount frames behind this frame is not measured
+    measuring = !pending[current];
+    if (measuring) {
+        glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+    }
+#endif
+}
+
+void GpuTimer::End() {
+#ifdef GPU_TIMER_QUERIES
+    if (!measuring) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[current] = true;
+    current = (current + 1) % QueryCount;
+    measuring = false;
+#endif
+}
+
+double GpuTimer::Elapsed() const {
+    return elapsed;
+}
+
+void GpuTimer::Poll() {
+#ifdef GPU_TIMER_QUERIES
+    // queries finish in the order they were issued
+    for(int i=1; i<=QueryCount; ++i) {
+        int index = (current + i) % QueryCount;
+        if (!pending[index]) continue;
+        GLint available = 0;
+        glGetQueryObjectiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &nanoseconds);
+        elapsed = nanoseconds * 1e-9;
+        pending[index] = false;
+    }
+#endif
+}
@@ -0,0 +1,44 @@
+//
+//  GpuTimer.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "OpenGL.hpp"
+
+namespace Pocket {
+    // Measures the gpu time of the gl calls made between Begin and End, using timer queries.
+    // Results arrive a few frames late, Elapsed returns the latest one that has finished.
+    // Only desktop GL with GL_TIME_ELAPSED (3.3 or ARB_timer_query) supports it, elsewhere nothing is measured.
+    class GpuTimer {
+    public:
+        GpuTimer();
+        ~GpuTimer();
+        
+        GpuTimer(const GpuTimer&) = delete;
+        GpuTimer& operator=(const GpuTimer&) = delete;
+        
+        static bool IsSupported();
+        
+        // Timers of the same GpuTimer or different ones can't overlap.
+        void Begin();
+        void End();
+        
+        // Seconds, or -1 when no measurement has finished yet.
+        double Elapsed() const;
+        
+    private:
+        void Poll();
+        
+        static const int QueryCount = 4;
+        GLuint queries[QueryCount];
+        bool pending[QueryCount];
+        int current;
+        bool created;
+        bool measuring;
+        double elapsed;
+    };
+}
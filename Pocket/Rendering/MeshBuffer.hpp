@@ -0,0 +1,68 @@
+//
+//  MeshBuffer.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "OpenGL.hpp"
+#include "VertexMesh.hpp"
+
+namespace Pocket {
+
+// Vertex and index buffers owned by a single mesh, uploaded once in mesh space
+// and drawn with the world matrix applied by the shader.
+class MeshBuffer {
+public:
+    MeshBuffer() : vertexBuffer(0), indexBuffer(0), vertexCount(0), indexCount(0), version(0) { }
+    
+    ~MeshBuffer() {
+        if (vertexBuffer) glDeleteBuffers(1, &vertexBuffer);
+        if (indexBuffer) glDeleteBuffers(1, &indexBuffer);
+    }
+    
+    MeshBuffer(const MeshBuffer&) = delete;
+    MeshBuffer& operator=(const MeshBuffer&) = delete;
+    
+    template<class Vertex>
+    void Upload(const VertexMesh<Vertex>& mesh) {
+        if (!vertexBuffer) {
+            glGenBuffers(1, &vertexBuffer);
+            glGenBuffers(1, &indexBuffer);
+        }
+        vertexCount = (int)mesh.vertices.size();
+        indexCount = (int)mesh.triangles.size();
+        
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertexCount, vertexCount ? &mesh.vertices[0] : 0, GL_STATIC_DRAW);
+        
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLshort) * indexCount, indexCount ? &mesh.triangles[0] : 0, GL_STATIC_DRAW);
+    }
+    
+    void Bind() {
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    }
+    
+    void Draw() {
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, 0);
+    }
+    
+    int VertexCount() const { return vertexCount; }
+    int IndexCount() const { return indexCount; }
+    
+private:
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+    int vertexCount;
+    int indexCount;
+    
+public:
+    // Mesh version the buffers were last uploaded from.
+    unsigned version;
+};
+
+}
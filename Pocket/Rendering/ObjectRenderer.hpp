@@ -27,22 +27,80 @@ struct VisibleObject {
     TextureComponent* texture;
     Orderable* orderable;
     float distanceToCamera;
+    // Offset of the vertices transformed by IObjectRenderer::PrepareObject, or NotPrepared.
+    uint32_t preparedVertex;
+    
+    static const uint32_t NotPrepared = 0xFFFFFFFF;
+    
+    // Static objects draw from their own mesh buffer, unless their texture coordinates
+    // are remapped into a TexturePage, then they are batched like dynamic objects.
+    bool DrawsStatic() const {
+        return material->Static() && !(texture && texture->Page());
+    }
+};
+
+// Why a batch was drawn before the next object could be added to it.
+enum class FlushReason {
+    Shader,
+    Texture,
+    BlendMode,
+    Clip,
+    // A static object drew from its own buffer.
+    Static,
+    // The batch buffers were full.
+    Capacity,
+    // End of the queue, or of a run of objects with the same vertex type.
+    End,
+    Count
 };
 
 struct RenderInfo {
+    RenderInfo() { Clear(); }
+    
     int drawCalls;
     int verticesRendered;
     int objectsRendered;
+    // Batched vertices and indices streamed to the gpu, static buffers are not counted.
+    size_t bytesUploaded;
+    int flushes[(int)FlushReason::Count];
+    
+    void Clear() {
+        drawCalls = 0;
+        verticesRendered = 0;
+        objectsRendered = 0;
+        bytesUploaded = 0;
+        for(int i=0; i<(int)FlushReason::Count; ++i) flushes[i] = 0;
+    }
+    
+    void Add(const RenderInfo& other) {
+        drawCalls += other.drawCalls;
+        verticesRendered += other.verticesRendered;
+        objectsRendered += other.objectsRendered;
+        bytesUploaded += other.bytesUploaded;
+        for(int i=0; i<(int)FlushReason::Count; ++i) flushes[i] += other.flushes[i];
+    }
 };
 
 class IObjectRenderer {
 public:
+    IObjectRenderer() : viewProjection(0), preparedOwner(0), clipper(0) {}
     virtual ~IObjectRenderer() {}
     virtual void Begin(bool isTransparent) = 0;
     virtual void End(RenderInfo& renderInfo) = 0;
     virtual void RenderObject(const VisibleObject& visibleObject) = 0;
     virtual void RenderTransparentObject(const VisibleObject& visibleObject) = 0;
+    
+    // Vertices of dynamic objects can be transformed on worker threads before rendering,
+    // ReservePrepared is called first with the total vertex count, then PrepareObject for each object.
+    virtual void ReservePrepared(size_t vertexCount) = 0;
+    virtual void PrepareObject(const VisibleObject& visibleObject) = 0;
+    
     const float* viewProjection;
+    Matrix4x4 viewProjectionMatrix;
+    // Set by whoever filled the prepared vertices last, renderers are shared between render systems.
+    const void* preparedOwner;
+    // Clip regions can span renderers of several vertex types, so the render system shares one clipper between them.
+    Clipper* clipper;
 };
 
 template<class V>
@@ -51,83 +109,213 @@ private:
     VertexRenderer<V> renderer;
     Shader<V>* currentShader;
     BlendModeType currentBlendMode;
-    TextureComponent* currentTexture;
-    Clipper clipper;
+    Texture* currentTexture;
+    Clipper ownClipper;
     int objectsRendered;
+    std::vector<V> preparedVertices;
+    int staticDrawCalls;
+    int staticVerticesRendered;
+    int flushes[(int)FlushReason::Count];
+    bool batchBound;
     
-public:
-    
-    void Begin(bool isTransparent) override {
-        currentShader = 0;
-        renderer.BeginLoop();
-        currentBlendMode = BlendModeType::Opaque;
-        objectsRendered = 0;
-        clipper.UseDepth = !isTransparent;
-        currentTexture = (TextureComponent*)-1;
+    void Flush(FlushReason reason) {
+        if (renderer.vertexIndex == 0) return;
+        renderer.Render();
+        flushes[(int)reason]++;
     }
     
-    void End(RenderInfo& renderInfo) override {
-        renderer.EndLoop();
-        renderInfo.drawCalls += renderer.drawCalls;
-        renderInfo.verticesRendered += renderer.verticesRendered;
-        renderInfo.objectsRendered += objectsRendered;
+    // Points the current shader at the batch buffers, with vertices already in world space.
+    void BindBatch() {
+        renderer.Bind();
+        currentShader->BindAttributes();
+        currentShader->SetViewProjection(viewProjection);
+        currentShader->SetWorld(Matrix4x4::IDENTITY.GetGlMatrix());
+        batchBound = true;
     }
     
-    void RenderObject(const VisibleObject& visibleObject) override {
+    void Draw(const VisibleObject& visibleObject) {
         if (visibleObject.shader != currentShader) {
-            renderer.Render();
+            Flush(FlushReason::Shader);
             currentShader = static_cast<Shader<V>*>(visibleObject.shader);
             currentShader->Use();
             currentShader->SetViewProjection(viewProjection);
+            batchBound = false;
         }
         
-        if (visibleObject.texture!=currentTexture) {
-            renderer.Render();
-            currentTexture = visibleObject.texture;
-            glBindTexture(GL_TEXTURE_2D, currentTexture ? currentTexture->Texture().GetHandle() : 0);
+        // objects with different texture components share a binding when packed into the same page
+        Texture* texture = visibleObject.texture ? &visibleObject.texture->Texture() : 0;
+        if (texture!=currentTexture) {
+            Flush(FlushReason::Texture);
+            currentTexture = texture;
+            glBindTexture(GL_TEXTURE_2D, currentTexture ? currentTexture->GetHandle() : 0);
         }
         
-        int clip = visibleObject.material->Clip;
-        bool isClipping = clip != 0;
-        
-        if (isClipping) {
-            renderer.Render();
-            if (clip==1) {
-                clipper.PushBegin();
+        if (visibleObject.DrawsStatic()) {
+            RenderStaticObject(visibleObject);
+        } else {
+            if (!batchBound) {
+                BindBatch();
+            }
+            const VertexMesh<V>& mesh = visibleObject.mesh->ConstMesh<V>();
+            if (visibleObject.preparedVertex != VisibleObject::NotPrepared) {
+                currentShader->RenderTransformed(renderer,
+                    &preparedVertices[visibleObject.preparedVertex],
+                    mesh.vertices.size(),
+                    mesh.triangles
+                    );
             } else {
-                clipper.PopBegin();
+                currentShader->RenderObject(renderer,
+                    mesh.vertices,
+                    mesh.triangles,
+                    visibleObject.transform->World
+                    );
+                if (visibleObject.texture && visibleObject.texture->Page()) {
+                    size_t verticesSize = mesh.vertices.size();
+                    currentShader->RemapTextureCoords(&renderer.vertices[renderer.vertexIndex - verticesSize], verticesSize, visibleObject.texture->PageRegion());
+                }
             }
         }
-        
-        const VertexMesh<V>& mesh = visibleObject.mesh->ConstMesh<V>();
-        currentShader->RenderObject(renderer,
-            mesh.vertices,
-            mesh.triangles,
-            visibleObject.transform->World
-            );
         objectsRendered++;
-        
-        if (isClipping) {
-            renderer.Render();
-            if (clip==1) {
-                clipper.PushEnd();
-            } else {
-                clipper.PopEnd();
+    }
+    
+    // Rectangle regions only update the clipper, other shapes are drawn into the stencil buffer.
+    void RenderClipRegion(const VisibleObject& visibleObject, int clip) {
+        if (clip==1) {
+            Vector3 min, max;
+            if (visibleObject.mesh->ConstMesh<V>().IsRectangle(min, max) &&
+                clipper->PushRect(visibleObject.transform->World, min, max)) {
+                return;
+            }
+            Flush(FlushReason::Clip);
+            clipper->PushBegin();
+            Draw(visibleObject);
+            Flush(FlushReason::Clip);
+            clipper->PushEnd();
+        } else {
+            if (clipper->Empty()) return;
+            if (clipper->TopIsRect()) {
+                clipper->PopRect();
+                return;
             }
+            Flush(FlushReason::Clip);
+            clipper->PopBegin();
+            Draw(visibleObject);
+            Flush(FlushReason::Clip);
+            clipper->PopEnd();
+        }
+    }
+    
+    // Objects inside rectangle regions are skipped when outside it, and only flush the batch
+    // when they cross its edges and the scissor rectangle has to change. Returns false when clipped away.
+    bool ApplyClipping(const VisibleObject& visibleObject) {
+        if (!clipper->NeedsCheck()) return true;
+        switch (clipper->Check(visibleObject.transform->World, visibleObject.mesh->LocalBoundingBox())) {
+            case Clipper::Visibility::Outside:
+                return false;
+            case Clipper::Visibility::NeedsScissor:
+                Flush(FlushReason::Clip);
+                clipper->ApplyScissor();
+                return true;
+            default:
+                return true;
+        }
+    }
+    
+    void RenderStaticObject(const VisibleObject& visibleObject) {
+        Flush(FlushReason::Static);
+        batchBound = false;
+        MeshBuffer& buffer = visibleObject.mesh->StaticBuffer<V>();
+        if (buffer.IndexCount() == 0) return;
+        buffer.Bind();
+        currentShader->BindAttributes();
+        const Matrix4x4& world = visibleObject.transform->World;
+        if (currentShader->HasWorld()) {
+            currentShader->SetWorld(world.GetGlMatrix());
+        } else {
+            const Matrix4x4 worldViewProjection = viewProjectionMatrix.Multiply(world);
+            currentShader->SetViewProjection(worldViewProjection.GetGlMatrix());
+        }
+        buffer.Draw();
+        staticDrawCalls++;
+        staticVerticesRendered += buffer.VertexCount();
+    }
+    
+public:
+    
+    ObjectRenderer() {
+        clipper = &ownClipper;
+    }
+    
+    void Begin(bool isTransparent) override {
+        currentShader = 0;
+        renderer.BeginLoop();
+        currentBlendMode = BlendModeType::Opaque;
+        objectsRendered = 0;
+        staticDrawCalls = 0;
+        staticVerticesRendered = 0;
+        for(int i=0; i<(int)FlushReason::Count; ++i) flushes[i] = 0;
+        batchBound = false;
+        clipper->UseDepth = !isTransparent;
+        currentTexture = (Texture*)-1;
+    }
+    
+    void End(RenderInfo& renderInfo) override {
+        Flush(FlushReason::End);
+        renderInfo.drawCalls += renderer.drawCalls + staticDrawCalls;
+        renderInfo.verticesRendered += renderer.verticesRendered + staticVerticesRendered;
+        renderInfo.objectsRendered += objectsRendered;
+        renderInfo.bytesUploaded += renderer.bytesUploaded;
+        // the vertex renderer draws by itself when its buffers are full
+        int flushed = 0;
+        for(int i=0; i<(int)FlushReason::Count; ++i) {
+            renderInfo.flushes[i] += flushes[i];
+            flushed += flushes[i];
+        }
+        renderInfo.flushes[(int)FlushReason::Capacity] += renderer.drawCalls - flushed;
+    }
+    
+    void ReservePrepared(size_t vertexCount) override {
+        if (preparedVertices.size()<vertexCount) {
+            preparedVertices.resize(vertexCount);
+        }
+    }
+    
+    void PrepareObject(const VisibleObject& visibleObject) override {
+        const VertexMesh<V>& mesh = visibleObject.mesh->ConstMesh<V>();
+        Shader<V>* shader = static_cast<Shader<V>*>(visibleObject.shader);
+        V* dest = &preparedVertices[visibleObject.preparedVertex];
+        shader->TransformVertices(mesh.vertices, visibleObject.transform->World, dest);
+        if (visibleObject.texture && visibleObject.texture->Page()) {
+            shader->RemapTextureCoords(dest, mesh.vertices.size(), visibleObject.texture->PageRegion());
+        }
+    }
+    
+    void RenderObject(const VisibleObject& visibleObject) override {
+        int clip = visibleObject.material->Clip;
+        if (clip!=0) {
+            RenderClipRegion(visibleObject, clip);
+        } else if (ApplyClipping(visibleObject)) {
+            Draw(visibleObject);
         }
     }
     
     void RenderTransparentObject(const VisibleObject& visibleObject) override {
+        int clip = visibleObject.material->Clip;
+        if (clip!=0) {
+            RenderClipRegion(visibleObject, clip);
+            return;
+        }
+        if (!ApplyClipping(visibleObject)) return;
         if (visibleObject.material->BlendMode()!=currentBlendMode) {
             currentBlendMode = visibleObject.material->BlendMode();
-            renderer.Render();
+            Flush(FlushReason::BlendMode);
              if (currentBlendMode == BlendModeType::Alpha ) {
                 glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             } else {
                 glBlendFunc (GL_SRC_ALPHA, GL_ONE);
             }
         }
-        RenderObject(visibleObject);
+        Draw(visibleObject);
     }
 };
 
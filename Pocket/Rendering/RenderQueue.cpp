@@ -0,0 +1,98 @@
+//
+//  RenderQueue.cpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "RenderQueue.hpp"
+#include <algorithm>
+#include <cstring>
+
+using namespace Pocket;
+
+static uint64_t QuantizeOrder(int order) {
+    int biased = order + (1 << (RenderQueue::OrderBits - 1));
+    if (biased<0) biased = 0;
+    if (biased>(1 << RenderQueue::OrderBits) - 1) biased = (1 << RenderQueue::OrderBits) - 1;
+    return (uint64_t)biased;
+}
+
+// Depth is the projected z in -1..1.
+static uint64_t QuantizeDepth(float depth, int bits) {
+    float normalized = (depth + 1.0f) * 0.5f;
+    if (!(normalized>0.0f)) normalized = 0.0f;
+    if (normalized>1.0f) normalized = 1.0f;
+    return (uint64_t)(normalized * (float)((1u << bits) - 1));
+}
+
+uint64_t RenderQueue::OpaqueKey(int order, int vertexType, uint32_t shader, uint32_t texture, bool isStatic, float depth) {
+    uint64_t key = QuantizeOrder(order);
+    key = (key << VertexTypeBits) | ((uint64_t)vertexType & ((1u << VertexTypeBits) - 1));
+    key = (key << ShaderBits) | (shader & (MaxShaders - 1));
+    key = (key << TextureBits) | (texture & (MaxTextures - 1));
+    key = (key << StaticBits) | (isStatic ? 1 : 0);
+    key = (key << DepthBits) | QuantizeDepth(depth, DepthBits);
+    return key;
+}
+
+uint64_t RenderQueue::FrontToBackKey(int order, int vertexType, uint32_t shader, uint32_t texture, bool isStatic, float depth) {
+    uint64_t key = QuantizeOrder(order);
+    key = (key << DepthBits) | QuantizeDepth(depth, DepthBits);
+    key = (key << VertexTypeBits) | ((uint64_t)vertexType & ((1u << VertexTypeBits) - 1));
+    key = (key << ShaderBits) | (shader & (MaxShaders - 1));
+    key = (key << TextureBits) | (texture & (MaxTextures - 1));
+    key = (key << StaticBits) | (isStatic ? 1 : 0);
+    return key;
+}
+
+uint64_t RenderQueue::TransparentKey(int order, float depth) {
+    const int depthBits = 24;
+    uint64_t farToNear = ((1u << depthBits) - 1) - QuantizeDepth(depth, depthBits);
+    return (QuantizeOrder(order) << (64 - OrderBits)) | farToNear;
+}
+
+// Least significant digit first, a byte at a time. All histograms are built in one pass,
+// and bytes that are equal for every key are skipped, which is common for the order and type bits.
+void RenderQueue::Sort() {
+    size_t count = items.size();
+    if (count<2) return;
+    if (count<64) {
+        std::stable_sort(items.begin(), items.end(), [] (const Item& a, const Item& b) {
+            return a.key<b.key;
+        });
+        return;
+    }
+    
+    uint32_t histograms[8][256];
+    std::memset(histograms, 0, sizeof(histograms));
+    for(size_t i=0; i<count; ++i) {
+        uint64_t key = items[i].key;
+        for(int pass=0; pass<8; ++pass) {
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+    
+    scratch.resize(count);
+    Item* source = items.data();
+    Item* dest = scratch.data();
+    for(int pass=0; pass<8; ++pass) {
+        uint32_t* histogram = histograms[pass];
+        if (histogram[(source[0].key >> (pass * 8)) & 0xFF] == count) continue;
+        uint32_t offset = 0;
+        for(int bucket=0; bucket<256; ++bucket) {
+            uint32_t bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+        for(size_t i=0; i<count; ++i) {
+            const Item& item = source[i];
+            dest[histogram[(item.key >> (pass * 8)) & 0xFF]++] = item;
+        }
+        std::swap(source, dest);
+    }
+    if (source!=items.data()) {
+        items.swap(scratch);
+    }
+}
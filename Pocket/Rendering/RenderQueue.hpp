@@ -0,0 +1,65 @@
+//
+//  RenderQueue.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Pocket {
+
+// Draw order for a frame: one 64 bit key per visible object, carrying the index of the object it was made for.
+// Keys are radix sorted, equal keys keep the order they were added in.
+class RenderQueue {
+public:
+    struct Item {
+        uint64_t key;
+        uint32_t index;
+    };
+    using Items = std::vector<Item>;
+    
+    static const int OrderBits = 16;
+    static const int VertexTypeBits = 4;
+    static const int ShaderBits = 10;
+    static const int TextureBits = 12;
+    static const int StaticBits = 1;
+    static const int DepthBits = 21;
+    
+    static const uint32_t MaxShaders = 1u << ShaderBits;
+    static const uint32_t MaxTextures = 1u << TextureBits;
+    
+    // Order, vertex type, shader, texture, static meshes last, then front to back.
+    static uint64_t OpaqueKey(int order, int vertexType, uint32_t shader, uint32_t texture, bool isStatic, float depth);
+    
+    // Order, front to back, then vertex type, shader, texture and static meshes last.
+    static uint64_t FrontToBackKey(int order, int vertexType, uint32_t shader, uint32_t texture, bool isStatic, float depth);
+    
+    // Order, then back to front.
+    static uint64_t TransparentKey(int order, float depth);
+    
+    void Add(uint64_t key, uint32_t index) {
+        items.push_back({ key, index });
+    }
+    
+    void Append(const RenderQueue& other) {
+        items.insert(items.end(), other.items.begin(), other.items.end());
+    }
+    
+    void Sort();
+    void Clear() { items.clear(); }
+    bool Empty() const { return items.empty(); }
+    size_t Size() const { return items.size(); }
+    
+    const Items& Sorted() const { return items; }
+    
+private:
+    Items items;
+    Items scratch;
+};
+
+}
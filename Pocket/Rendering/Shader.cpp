@@ -7,8 +7,149 @@
 //
 
 #include "Shader.hpp"
+#include <cstddef>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define POCKET_VERTEX_NEON
+#endif
 
 namespace Pocket {
+
+// The batch kernels load and store whole 4 float lanes over the vertex fields,
+// relying on this layout.
+static_assert(offsetof(Vertex, Position) == 0 && offsetof(Vertex, TextureCoords) == 12 &&
+              offsetof(Vertex, Color) == 20 && offsetof(Vertex, Normal) == 24 &&
+              sizeof(Vertex) == 36, "Vertex layout changed, update TransformVertexBatch");
+
+static inline void TransformVertex(const Matrix4x4& world, const Vertex& source, Vertex& dest) {
+    world.TransformPositionAffine(source.Position, dest.Position);
+    world.TransformVectorAffine(source.Normal, dest.Normal);
+    dest.Color = source.Color;
+    dest.TextureCoords.x = source.TextureCoords.x;
+    dest.TextureCoords.y = source.TextureCoords.y;
+}
+
+// Transforms positions by world and normals by its rotational part, texture coords and colors are copied.
+static void TransformVertexBatch(const Matrix4x4& world, const Vertex* source, Vertex* dest, size_t count) {
+    size_t v = 0;
+#if defined(__SSE2__)
+    const __m128 m00 = _mm_set1_ps(world.m[0][0]), m01 = _mm_set1_ps(world.m[0][1]), m02 = _mm_set1_ps(world.m[0][2]), m03 = _mm_set1_ps(world.m[0][3]);
+    const __m128 m10 = _mm_set1_ps(world.m[1][0]), m11 = _mm_set1_ps(world.m[1][1]), m12 = _mm_set1_ps(world.m[1][2]), m13 = _mm_set1_ps(world.m[1][3]);
+    const __m128 m20 = _mm_set1_ps(world.m[2][0]), m21 = _mm_set1_ps(world.m[2][1]), m22 = _mm_set1_ps(world.m[2][2]), m23 = _mm_set1_ps(world.m[2][3]);
+    // Four vertices per iteration, transposed to x/y/z lanes. Every 16 byte load and store
+    // reaches 4 bytes past the vector it targets, so the last vertex is left to the scalar tail.
+    for(; v + 4<count; v+=4) {
+        const float* s = (const float*)(source + v);
+        __m128 x = _mm_loadu_ps(s);
+        __m128 y = _mm_loadu_ps(s + 9);
+        __m128 z = _mm_loadu_ps(s + 18);
+        __m128 w = _mm_loadu_ps(s + 27);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        __m128 px = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_add_ps(_mm_mul_ps(m02, z), m03));
+        __m128 py = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m12, z), m13));
+        __m128 pz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_add_ps(_mm_mul_ps(m22, z), m23));
+        __m128 pw = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(px, py, pz, pw);
+
+        x = _mm_loadu_ps(s + 6);
+        y = _mm_loadu_ps(s + 15);
+        z = _mm_loadu_ps(s + 24);
+        w = _mm_loadu_ps(s + 33);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        __m128 nx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_mul_ps(m02, z));
+        __m128 ny = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m12, z));
+        __m128 nz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_mul_ps(m22, z));
+        __m128 nw = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+
+        // Normals spill into the next position and positions into the texture coords,
+        // so store normals first, then positions, then the copied fields.
+        float* d = (float*)(dest + v);
+        _mm_storeu_ps(d + 6, nx);
+        _mm_storeu_ps(d + 15, ny);
+        _mm_storeu_ps(d + 24, nz);
+        _mm_storeu_ps(d + 33, nw);
+        _mm_storeu_ps(d, px);
+        _mm_storeu_ps(d + 9, py);
+        _mm_storeu_ps(d + 18, pz);
+        _mm_storeu_ps(d + 27, pw);
+        for(size_t i = 0; i<4; ++i) {
+            dest[v + i].TextureCoords = source[v + i].TextureCoords;
+            dest[v + i].Color = source[v + i].Color;
+        }
+    }
+#elif defined(POCKET_VERTEX_NEON)
+    const float32x4_t c0 = { world.m[0][0], world.m[1][0], world.m[2][0], 0.0f };
+    const float32x4_t c1 = { world.m[0][1], world.m[1][1], world.m[2][1], 0.0f };
+    const float32x4_t c2 = { world.m[0][2], world.m[1][2], world.m[2][2], 0.0f };
+    const float32x4_t c3 = { world.m[0][3], world.m[1][3], world.m[2][3], 0.0f };
+    // Matrix columns are kept in registers, each vertex is a multiply-accumulate per axis.
+    for(; v<count; ++v) {
+        const Vertex& s = source[v];
+        Vertex& d = dest[v];
+        float32x4_t p = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(c3, c0, s.Position.x), c1, s.Position.y), c2, s.Position.z);
+        float32x4_t n = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(c0, s.Normal.x), c1, s.Normal.y), c2, s.Normal.z);
+        vst1_f32(&d.Position.x, vget_low_f32(p));
+        vst1q_lane_f32(&d.Position.z, p, 2);
+        vst1_f32(&d.Normal.x, vget_low_f32(n));
+        vst1q_lane_f32(&d.Normal.z, n, 2);
+        d.TextureCoords = s.TextureCoords;
+        d.Color = s.Color;
+    }
+#endif
+    for(; v<count; ++v) {
+        TransformVertex(world, source[v], dest[v]);
+    }
+}
+
+// Only the overload matching VertexRenderer::Index is compiled.
+#ifndef OPENGL_DESKTOP
+static void RebaseIndices(const short* source, GLushort* dest, size_t count, size_t offset) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i add = _mm_set1_epi16((short)offset);
+    for(; i + 8<=count; i+=8) {
+        _mm_storeu_si128((__m128i*)(dest + i), _mm_add_epi16(_mm_loadu_si128((const __m128i*)(source + i)), add));
+    }
+#elif defined(POCKET_VERTEX_NEON)
+    const uint16x8_t add = vdupq_n_u16((unsigned short)offset);
+    for(; i + 8<=count; i+=8) {
+        vst1q_u16((uint16_t*)(dest + i), vaddq_u16(vld1q_u16((const uint16_t*)(source + i)), add));
+    }
+#endif
+    for(; i<count; ++i) {
+        dest[i] = (GLushort)(offset + (unsigned short)source[i]);
+    }
+}
+#else
+// Mesh indices are 16 bit and widened while rebasing.
+static void RebaseIndices(const short* source, GLuint* dest, size_t count, size_t offset) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i add = _mm_set1_epi32((int)offset);
+    const __m128i zero = _mm_setzero_si128();
+    for(; i + 8<=count; i+=8) {
+        __m128i indices = _mm_loadu_si128((const __m128i*)(source + i));
+        _mm_storeu_si128((__m128i*)(dest + i), _mm_add_epi32(_mm_unpacklo_epi16(indices, zero), add));
+        _mm_storeu_si128((__m128i*)(dest + i + 4), _mm_add_epi32(_mm_unpackhi_epi16(indices, zero), add));
+    }
+#elif defined(POCKET_VERTEX_NEON)
+    const uint32x4_t add = vdupq_n_u32((unsigned int)offset);
+    for(; i + 8<=count; i+=8) {
+        uint16x8_t indices = vld1q_u16((const uint16_t*)(source + i));
+        vst1q_u32((uint32_t*)(dest + i), vaddq_u32(vmovl_u16(vget_low_u16(indices)), add));
+        vst1q_u32((uint32_t*)(dest + i + 4), vaddq_u32(vmovl_u16(vget_high_u16(indices)), add));
+    }
+#endif
+    for(; i<count; ++i) {
+        dest[i] = (GLuint)(offset + (unsigned short)source[i]);
+    }
+}
+#endif
+
 template<>
 void Shader<Pocket::Vertex>::RenderObject(Pocket::VertexRenderer<Pocket::Vertex>& renderer, const typename Pocket::VertexMesh<Pocket::Vertex>::Vertices& vertices, const Pocket::IVertexMesh::Triangles& triangles, const Pocket::Matrix4x4& world) {
     
@@ -18,17 +159,48 @@ void Shader<Pocket::Vertex>::RenderObject(Pocket::VertexRenderer<Pocket::Vertex>
     renderer.Begin(verticesSize, trianglesSize);
 
     size_t index = renderer.vertexIndex;
-    for (size_t v=0; v<verticesSize; ++v) {
-        const Vertex& source = vertices[v];
-        Vertex& dest = renderer.vertices[renderer.vertexIndex++];
-        world.TransformPositionAffine(source.Position, dest.Position);
-        world.TransformVectorAffine(source.Normal, dest.Normal);
-        dest.Color = source.Color;
-        dest.TextureCoords.x = source.TextureCoords.x;
-        dest.TextureCoords.y = source.TextureCoords.y;
+    if (verticesSize>0) {
+        TransformVertexBatch(world, &vertices[0], &renderer.vertices[index], verticesSize);
     }
-    for (size_t v = 0; v<trianglesSize; v++) {
-        renderer.triangles[renderer.triangleIndex++] = (GLshort)(index + triangles[v]);
+    if (trianglesSize>0) {
+        RebaseIndices(&triangles[0], &renderer.triangles[renderer.triangleIndex], trianglesSize, renderer.baseVertex + index);
     }
+    renderer.vertexIndex += verticesSize;
+    renderer.triangleIndex += trianglesSize;
+}
+
+template<>
+void Shader<Pocket::Vertex>::TransformVertices(const typename Pocket::VertexMesh<Pocket::Vertex>::Vertices& vertices, const Pocket::Matrix4x4& world, Pocket::Vertex* dest) {
+    if (vertices.empty()) return;
+    TransformVertexBatch(world, &vertices[0], dest, vertices.size());
+}
+
+template<>
+void Shader<Pocket::Vertex>::RenderTransformed(Pocket::VertexRenderer<Pocket::Vertex>& renderer, const Pocket::Vertex* vertices, size_t verticesSize, const Pocket::IVertexMesh::Triangles& triangles) {
+    
+    size_t trianglesSize = triangles.size();
+    
+    renderer.Begin(verticesSize, trianglesSize);
+    
+    size_t index = renderer.vertexIndex;
+    if (verticesSize>0) {
+        std::copy(vertices, vertices + verticesSize, &renderer.vertices[index]);
+    }
+    if (trianglesSize>0) {
+        RebaseIndices(&triangles[0], &renderer.triangles[renderer.triangleIndex], trianglesSize, renderer.baseVertex + index);
+    }
+    renderer.vertexIndex += verticesSize;
+    renderer.triangleIndex += trianglesSize;
+}
+
+template<>
+void Shader<Pocket::Vertex>::RemapTextureCoords(Pocket::Vertex* vertices, size_t verticesSize, const Box& region) {
+    const float scaleX = region.right - region.left;
+    const float scaleY = region.bottom - region.top;
+    for(size_t i=0; i<verticesSize; ++i) {
+        Vector2& coords = vertices[i].TextureCoords;
+        coords.x = region.left + coords.x * scaleX;
+        coords.y = region.top + coords.y * scaleY;
+    }
+}
 }
-}
\ No newline at end of file
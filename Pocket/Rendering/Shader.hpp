@@ -7,13 +7,14 @@
 //
 
 #pragma once
-#include "OpenGl.hpp"
+#include "OpenGL.hpp"
 #include <vector>
 #include "Vertex.hpp"
 #include "VertexRenderer.hpp"
 #include "VertexMesh.hpp"
 #include "GameObject.hpp"
 #include "Matrix4x4.hpp"
+#include "Box.hpp"
 #include <algorithm>
 
 namespace Pocket {
@@ -21,6 +22,7 @@ namespace Pocket {
 #define SHADER_SOURCE(...) #__VA_ARGS__
 
 static const std::string ViewProjectionUniformName = "ViewProjection";
+static const std::string WorldUniformName = "World";
 
 class IShader {
 public:
@@ -31,7 +33,7 @@ public:
 template<class V>
 class Shader : public IShader {
 public:
-    Shader() : viewProjectionUniform(-1), shaderProgram(0), vertexShader(0), fragmentShader(0) { }
+    Shader() : shaderProgram(0), vertexShader(0), fragmentShader(0), viewProjectionUniform(-1), worldUniform(-1) { }
     ~Shader() { Clear(); }
     
     void Clear() {
@@ -101,25 +103,32 @@ public:
         if (!FindUniforms()) {
             return false;
         }
+        
+        SetWorld(Matrix4x4::IDENTITY.GetGlMatrix());
          
         return true;
     }
     
     std::string name;
     
+    // Attributes are bound separately with BindAttributes, once the vertex buffer to draw from is bound.
     void Use() {
         glUseProgram(shaderProgram);
+       // //std::cout<<"Using shader : " << name<<"  shader program " << shaderProgram<<" attributes:  " << attributes.size()<< std::endl;
+       
+        for (size_t i=0; i<textureUniforms.size(); ++i) {
+            glUniform1i(textureUniforms[i].location, i);
+        }
+    }
+    
+    // Points the vertex attributes at the currently bound vertex buffer.
+    void BindAttributes() {
         for (auto& a : attributes) {
             glVertexAttribPointer(a.glAttribute, a.size, a.type, a.normalized, description.Stride(), (GLvoid*)(size_t)a.offset);
         }
         for (auto& a : attributes) {
             glEnableVertexAttribArray(a.glAttribute);
         }
-       // //std::cout<<"Using shader : " << name<<"  shader program " << shaderProgram<<" attributes:  " << attributes.size()<< std::endl;
-       
-        for (size_t i=0; i<textureUniforms.size(); ++i) {
-            glUniform1i(textureUniforms[i].location, i);
-        }
     }
     
     template<class T>
@@ -226,6 +235,7 @@ private:
     
     bool FindUniforms() {
         viewProjectionUniform = -1;
+        worldUniform = -1;
         GLint numberOfUniforms;
         //std::cout<<"Uniforms : " << std::endl;
         glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORMS, &numberOfUniforms);
@@ -247,6 +257,8 @@ private:
             
             if (uniformName == ViewProjectionUniformName) {
                 viewProjectionUniform = i;
+            } else if (uniformName == WorldUniformName) {
+                worldUniform = i;
             }
         }
         //std::cout<<"End uniforms: " << textureUniforms.size() << std::endl;
@@ -318,14 +330,33 @@ private:
     GLuint vertexShader;
     GLuint fragmentShader;
     int viewProjectionUniform;
+    int worldUniform;
     
 public:
 
     virtual void SetViewProjection(const float* viewProjection) {
         if (viewProjectionUniform == -1) return;
         glUniformMatrix4fv(uniforms[viewProjectionUniform].location, 1, GL_FALSE, viewProjection);
-    }   
+    }
+    
+    bool HasWorld() const { return worldUniform != -1; }
+    
+    // Shaders declaring a World uniform transform positions and normals by it,
+    // batched vertices are already in world space and use identity.
+    void SetWorld(const float* world) {
+        if (worldUniform == -1) return;
+        glUniformMatrix4fv(uniforms[worldUniform].location, 1, GL_FALSE, world);
+    }
 
     virtual void RenderObject(Pocket::VertexRenderer<V>& renderer, const typename Pocket::VertexMesh<V>::Vertices& vertices, const Pocket::IVertexMesh::Triangles& triangles, const Pocket::Matrix4x4& world);
+
+    // Transforms vertices to world space ahead of rendering, safe to call from worker threads.
+    virtual void TransformVertices(const typename Pocket::VertexMesh<V>::Vertices& vertices, const Pocket::Matrix4x4& world, V* dest);
+    
+    // Adds vertices already transformed by TransformVertices to the batch.
+    virtual void RenderTransformed(Pocket::VertexRenderer<V>& renderer, const V* vertices, size_t verticesSize, const Pocket::IVertexMesh::Triangles& triangles);
+    
+    // Maps texture coordinates from 0..1 into region, for images packed into a TexturePage.
+    virtual void RemapTextureCoords(V* vertices, size_t verticesSize, const Box& region);
 };
 }
@@ -68,12 +68,13 @@ void ShaderCollection::Initialize() {
 				attribute vec4 Color;                      
 				attribute vec3 Normal;                     
 				uniform mat4 ViewProjection;               
+				uniform mat4 World;                        
 				varying vec4 vColor;                       
 				varying vec3 vNormal;                      
 				void main() {                              
 				   vColor = Color;                         
-				   vNormal = Normal;                       
-					gl_Position = Position * ViewProjection;
+				   vNormal = (vec4(Normal, 0.0) * World).xyz;
+					gl_Position = Position * World * ViewProjection;
 				}                                          
 			)
             ,
@@ -101,14 +102,15 @@ void ShaderCollection::Initialize() {
 				attribute vec4 Color;                      
 				attribute vec3 Normal;                     
 				uniform mat4 ViewProjection;               
+				uniform mat4 World;                        
 				varying vec2 vTexCoords;                   
 				varying vec4 vColor;                       
 				varying vec3 vNormal;                      
 				void main() {                              
 					vTexCoords = TexCoords;                 
 				   vColor = Color;                         
-				   vNormal = Normal;                       
-					gl_Position = Position * ViewProjection;
+				   vNormal = (vec4(Normal, 0.0) * World).xyz;
+					gl_Position = Position * World * ViewProjection;
 				}                                          
 			)
             ,
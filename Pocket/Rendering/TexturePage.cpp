@@ -0,0 +1,77 @@
+//
+//  TexturePage.cpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "TexturePage.hpp"
+#include "OpenGL.hpp"
+#include <cstring>
+
+using namespace Pocket;
+
+TexturePage::TexturePage(int width, int height) : pageWidth(width), pageHeight(height) {
+    Clear();
+}
+
+void TexturePage::Clear() {
+    rowX = 0;
+    rowY = 0;
+    rowHeight = 0;
+}
+
+void TexturePage::CreateTexture() {
+    width = pageWidth;
+    height = pageHeight;
+    
+    ASSERT_GL(glGenTextures(1, &texture));
+    ASSERT_GL(glBindTexture(GL_TEXTURE_2D, texture));
+    ASSERT_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    ASSERT_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    ASSERT_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    ASSERT_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    ASSERT_GL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0));
+}
+
+bool TexturePage::Add(const unsigned char* pixels, int width, int height, Box& region) {
+    const int paddedWidth = width + 2;
+    const int paddedHeight = height + 2;
+    if (width<=0 || height<=0 || paddedWidth>pageWidth || paddedHeight>pageHeight) return false;
+    
+    if (rowX + paddedWidth>pageWidth) {
+        rowX = 0;
+        rowY += rowHeight;
+        rowHeight = 0;
+    }
+    if (rowY + paddedHeight>pageHeight) return false;
+    
+    padded.resize(paddedWidth * paddedHeight * 4);
+    for(int y=0; y<paddedHeight; ++y) {
+        int sourceY = y == 0 ? 0 : (y == paddedHeight - 1 ? height - 1 : y - 1);
+        const unsigned char* source = &pixels[sourceY * width * 4];
+        unsigned char* dest = &padded[y * paddedWidth * 4];
+        std::memcpy(dest, source, 4);
+        std::memcpy(dest + 4, source, width * 4);
+        std::memcpy(dest + (paddedWidth - 1) * 4, source + (width - 1) * 4, 4);
+    }
+    
+    if (!texture) {
+        CreateTexture();
+    }
+    ASSERT_GL(glBindTexture(GL_TEXTURE_2D, texture));
+    ASSERT_GL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+    ASSERT_GL(glTexSubImage2D(GL_TEXTURE_2D, 0, rowX, rowY, paddedWidth, paddedHeight, GL_RGBA, GL_UNSIGNED_BYTE, &padded[0]));
+    
+    region.left = (rowX + 1) / (float)pageWidth;
+    region.top = (rowY + 1) / (float)pageHeight;
+    region.right = (rowX + 1 + width) / (float)pageWidth;
+    region.bottom = (rowY + 1 + height) / (float)pageHeight;
+    
+    rowX += paddedWidth;
+    if (paddedHeight>rowHeight) {
+        rowHeight = paddedHeight;
+    }
+    return true;
+}
@@ -0,0 +1,39 @@
+//
+//  TexturePage.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include <vector>
+#include "Texture.hpp"
+#include "Box.hpp"
+
+namespace Pocket {
+    // A large texture holding many small images, packed in rows.
+    // Objects textured from the same page share one texture binding, so they can be drawn in one batch.
+    // Each image gets a one pixel border copied from its edges, so linear filtering does not bleed between images.
+    class TexturePage : public Texture {
+    public:
+        TexturePage(int width = 2048, int height = 2048);
+        
+        // Copies rgba pixels into a free area, region is set to its texture coordinates within the page.
+        // Returns false when the image does not fit.
+        bool Add(const unsigned char* pixels, int width, int height, Box& region);
+        
+        // Forgets all packed images, the texture itself is kept.
+        void Clear();
+        
+    private:
+        void CreateTexture();
+        
+        int pageWidth;
+        int pageHeight;
+        int rowX;
+        int rowY;
+        int rowHeight;
+        std::vector<unsigned char> padded;
+    };
+}
@@ -0,0 +1,203 @@
+//
+//  TriangleTree.cpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "TriangleTree.hpp"
+#include "VertexMesh.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace Pocket;
+
+// Hits further away are ignored, as in VertexMesh::IntersectsRay.
+static const float MaxDistance = 10000000.0f;
+
+static float Axis(const Vector3& v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+static bool IsCloser(float distance, size_t index, float nearest, size_t nearestIndex, bool found) {
+    return distance<nearest || (found && distance == nearest && index<nearestIndex);
+}
+
+TriangleTree::TriangleTree() : version(0) { }
+
+void TriangleTree::Build(IVertexMesh& mesh) {
+    nodes.clear();
+    triangles.clear();
+    const size_t count = mesh.triangles.size() / 3;
+    if (count == 0) return;
+
+    std::vector<Triangle> source(count);
+    std::vector<Vector3> centers(count);
+    std::vector<int> order(count);
+    for (size_t i=0; i<count; ++i) {
+        const Vector3& tri0 = mesh.GetPosition(mesh.triangles[i * 3]);
+        const Vector3& tri1 = mesh.GetPosition(mesh.triangles[i * 3 + 1]);
+        const Vector3& tri2 = mesh.GetPosition(mesh.triangles[i * 3 + 2]);
+        Triangle& triangle = source[i];
+        triangle.corner = tri0;
+        triangle.edge1 = tri1 - tri0;
+        triangle.edge2 = tri2 - tri0;
+        triangle.index = i * 3;
+        centers[i] = (tri0 + tri1 + tri2) * (1.0f / 3.0f);
+        order[i] = (int)i;
+    }
+
+    struct Range {
+        int node;
+        int first;
+        int count;
+    };
+    std::vector<Range> ranges;
+    ranges.push_back({ 0, 0, (int)count });
+    nodes.reserve(count * 2 / MaxTrianglesInLeaf + 1);
+    triangles.reserve(count);
+    nodes.resize(1);
+    // Nodes are enlarged a little, so rounding never misses a triangle lying on the side of a node.
+    float padding = -1.0f;
+
+    while (!ranges.empty()) {
+        const Range range = ranges.back();
+        ranges.pop_back();
+
+        Vector3 min = source[order[range.first]].corner;
+        Vector3 max = min;
+        Vector3 centerMin = centers[order[range.first]];
+        Vector3 centerMax = centerMin;
+        for (int i = range.first, end = range.first + range.count; i<end; ++i) {
+            const Triangle& triangle = source[order[i]];
+            const Vector3 corners[3] = { triangle.corner, triangle.corner + triangle.edge1, triangle.corner + triangle.edge2 };
+            for (int c=0; c<3; ++c) {
+                min = Vector3(std::min(min.x, corners[c].x), std::min(min.y, corners[c].y), std::min(min.z, corners[c].z));
+                max = Vector3(std::max(max.x, corners[c].x), std::max(max.y, corners[c].y), std::max(max.z, corners[c].z));
+            }
+            const Vector3& center = centers[order[i]];
+            centerMin = Vector3(std::min(centerMin.x, center.x), std::min(centerMin.y, center.y), std::min(centerMin.z, center.z));
+            centerMax = Vector3(std::max(centerMax.x, center.x), std::max(centerMax.y, center.y), std::max(centerMax.z, center.z));
+        }
+        if (padding<0.0f) {
+            const Vector3 size = max - min;
+            padding = std::max(size.x, std::max(size.y, size.z)) * 0.0001f;
+        }
+
+        Node& node = nodes[range.node];
+        node.min[0] = min.x - padding;
+        node.min[1] = min.y - padding;
+        node.min[2] = min.z - padding;
+        node.max[0] = max.x + padding;
+        node.max[1] = max.y + padding;
+        node.max[2] = max.z + padding;
+        node.axis = 0;
+
+        if (range.count<=MaxTrianglesInLeaf) {
+            node.first = (int)triangles.size();
+            node.count = range.count;
+            for (int i = range.first, end = range.first + range.count; i<end; ++i) {
+                triangles.push_back(source[order[i]]);
+            }
+            continue;
+        }
+
+        // Split at the median center along the axis where the centers spread the most.
+        const Vector3 spread = centerMax - centerMin;
+        const int axis = spread.x>=spread.y && spread.x>=spread.z ? 0 : (spread.y>=spread.z ? 1 : 2);
+        const int half = range.count / 2;
+        std::nth_element(order.begin() + range.first, order.begin() + range.first + half, order.begin() + range.first + range.count,
+            [&centers, axis] (int a, int b) { return Axis(centers[a], axis)<Axis(centers[b], axis); });
+
+        const int children = (int)nodes.size();
+        node.first = children;
+        node.count = 0;
+        node.axis = axis;
+        nodes.resize(nodes.size() + 2);
+        ranges.push_back({ children, range.first, half });
+        ranges.push_back({ children + 1, range.first + half, range.count - half });
+    }
+}
+
+void TriangleTree::LineTest::Set(const Ray& ray) {
+    position = ray.position;
+    // Directions along an axis are replaced by a large number instead of infinity, which would give nan for points on the node.
+    inverse[0] = fabsf(ray.direction.x)>1e-20f ? 1.0f / ray.direction.x : 1e20f;
+    inverse[1] = fabsf(ray.direction.y)>1e-20f ? 1.0f / ray.direction.y : 1e20f;
+    inverse[2] = fabsf(ray.direction.z)>1e-20f ? 1.0f / ray.direction.z : 1e20f;
+}
+
+// Triangles behind the position of the ray are hit as well, so only the far side of the line is limited.
+bool TriangleTree::LineTest::Intersect(const Node& node, float maxDistance) const {
+    float x1 = (node.min[0] - position.x) * inverse[0];
+    float x2 = (node.max[0] - position.x) * inverse[0];
+    float y1 = (node.min[1] - position.y) * inverse[1];
+    float y2 = (node.max[1] - position.y) * inverse[1];
+    float z1 = (node.min[2] - position.z) * inverse[2];
+    float z2 = (node.max[2] - position.z) * inverse[2];
+    float enter = std::max(std::min(x1, x2), std::max(std::min(y1, y2), std::min(z1, z2)));
+    float leave = std::min(std::max(x1, x2), std::min(std::max(y1, y2), std::max(z1, z2)));
+    return enter<=leave && enter<=maxDistance;
+}
+
+// Same as IVertexMesh::RayIntersectsTriangle, with the edges found when building.
+bool TriangleTree::Intersect(const Ray& ray, const Triangle& triangle, float& distance, float& u, float& v) {
+    Vector3 pvec = ray.direction.Cross(triangle.edge2);
+    float det = triangle.edge1.Dot(pvec);
+    if (det < 0.0001f) return false;
+
+    Vector3 tvec = ray.position - triangle.corner;
+    u = tvec.Dot(pvec);
+    if (u < 0.0f || u > det) return false;
+
+    Vector3 qvec = tvec.Cross(triangle.edge1);
+    v = ray.direction.Dot(qvec);
+    if (v < 0.0f || u + v > det) return false;
+
+    distance = triangle.edge2.Dot(qvec);
+    float invDet = 1.0f / det;
+    distance *= invDet;
+    u *= invDet;
+    v *= invDet;
+    return true;
+}
+
+bool TriangleTree::IntersectsRay(const Ray& ray, TriangleHit& hit) const {
+    if (nodes.empty()) return false;
+    LineTest line;
+    line.Set(ray);
+    float nearest = MaxDistance;
+    bool found = false;
+
+    int stack[MaxStack];
+    int count = 0;
+    stack[count++] = 0;
+    while (count>0) {
+        const Node& node = nodes[stack[--count]];
+        if (!line.Intersect(node, nearest)) continue;
+        if (node.count>0) {
+            for (int i = node.first, end = node.first + node.count; i<end; ++i) {
+                const Triangle& triangle = triangles[i];
+                float distance, u, v;
+                if (!Intersect(ray, triangle, distance, u, v)) continue;
+                if (!IsCloser(distance, triangle.index, nearest, hit.triangleIndex, found)) continue;
+                nearest = distance;
+                hit.distance = distance;
+                hit.u = u;
+                hit.v = v;
+                hit.triangleIndex = triangle.index;
+                found = true;
+            }
+            continue;
+        }
+        // the near child is visited first
+        const bool backwards = Axis(ray.direction, node.axis)<0.0f;
+        stack[count++] = node.first + (backwards ? 0 : 1);
+        stack[count++] = node.first + (backwards ? 1 : 0);
+    }
+    if (found) {
+        hit.normal = Vector3(0,0,0);
+    }
+    return found;
+}
@@ -0,0 +1,77 @@
+//
+//  TriangleTree.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "Ray.hpp"
+#include <vector>
+
+namespace Pocket {
+    class IVertexMesh;
+
+    // Nearest triangle hit by a ray.
+    struct TriangleHit {
+        float distance;
+        float u;
+        float v;
+        // Index of the first corner in the triangle list.
+        size_t triangleIndex;
+        // Zero unless set by a MeshIntersector.
+        Vector3 normal;
+    };
+
+    // Bounding volume hierarchy over the triangles of a mesh, for picking meshes with many triangles.
+    // Hits are the same as IVertexMesh::IntersectsRay, the nearest triangle along the line of the ray
+    // with the lowest index among equally near ones.
+    class TriangleTree {
+    public:
+        TriangleTree();
+
+        void Build(IVertexMesh& mesh);
+
+        size_t Triangles() const { return triangles.size(); }
+
+        bool IntersectsRay(const Ray& ray, TriangleHit& hit) const;
+
+        // Version of the mesh the tree was built from, see Mesh::Version.
+        unsigned version;
+
+    private:
+        static const int MaxTrianglesInLeaf = 4;
+        static const int MaxStack = 64;
+
+        struct Node {
+            float min[3];
+            float max[3];
+            // Leaves hold count triangles from first, other nodes have their two children at first.
+            int first;
+            int count;
+            // Axis the children were split along.
+            int axis;
+        };
+
+        struct Triangle {
+            Vector3 corner;
+            Vector3 edge1;
+            Vector3 edge2;
+            size_t index;
+        };
+
+        // Ray with the reciprocal of its direction, for testing nodes.
+        struct LineTest {
+            void Set(const Ray& ray);
+            bool Intersect(const Node& node, float maxDistance) const;
+            Vector3 position;
+            float inverse[3];
+        };
+
+        static bool Intersect(const Ray& ray, const Triangle& triangle, float& distance, float& u, float& v);
+
+        std::vector<Node> nodes;
+        std::vector<Triangle> triangles;
+    };
+}
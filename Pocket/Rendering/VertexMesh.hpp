@@ -126,6 +126,35 @@ public:
         box.extends = (max - min);
     }
     
+    // True for flat meshes whose triangles cover the xy rectangle spanned by their vertices,
+    // like sprites and nine patches. min and max are set to the corners of the rectangle.
+    bool IsRectangle(Vector3& min, Vector3& max) const {
+        size_t size = vertices.size();
+        if (size<4 || triangles.size()<6) return false;
+        min = vertices[0].Position;
+        max = min;
+        for (size_t i=1; i<size; i++) {
+            const Vector3& position = vertices[i].Position;
+            if (position.x<min.x) min.x = position.x;
+            if (position.y<min.y) min.y = position.y;
+            if (position.z<min.z) min.z = position.z;
+            if (position.x>max.x) max.x = position.x;
+            if (position.y>max.y) max.y = position.y;
+            if (position.z>max.z) max.z = position.z;
+        }
+        float rectangleArea = (max.x - min.x) * (max.y - min.y);
+        if (rectangleArea<=0.0f || (max.z - min.z)>0.0001f) return false;
+        
+        float area = 0.0f;
+        for (size_t i=0; i+2<triangles.size(); i+=3) {
+            const Vector3& a = vertices[triangles[i]].Position;
+            const Vector3& b = vertices[triangles[i+1]].Position;
+            const Vector3& c = vertices[triangles[i+2]].Position;
+            area += fabsf((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) * 0.5f;
+        }
+        return fabsf(area - rectangleArea)<=rectangleArea * 0.0001f;
+    }
+    
     void AddTexturedQuad(int textureWidth, int textureHeight, const Box& textureCoords, const Matrix3x3& transform )
     {
         Vector2 size = textureCoords.Size() * Vector2(textureWidth, textureHeight) * 0.5f;
@@ -7,7 +7,7 @@
 //
 
 #pragma once
-#include "OpenGl.hpp"
+#include "OpenGL.hpp"
 
 namespace Pocket {
 
@@ -16,21 +16,38 @@ public:
     virtual ~IVertexRenderer() {}
 };
 
+// Batches are collected on the cpu and streamed into ring buffers on the gpu.
+// Each flush fills the next sub-range with glBufferSubData, and the buffers are
+// only orphaned when the ring wraps, so the driver keeps the regions still in use.
 template<class Vertex>
 class VertexRenderer : public IVertexRenderer {
 public:
-    const static unsigned int MAX_VERTICES = 30000;
+#ifdef OPENGL_DESKTOP
+    // Desktop GL always supports 32 bit indices, so indices can address the whole ring
+    // of RING_VERTICES, a single batch still holds at most MAX_VERTICES.
+    typedef GLuint Index;
+    const static GLenum IndexType = GL_UNSIGNED_INT;
+    const static unsigned int MAX_VERTICES = 65536;
+    const static unsigned int RING_SEGMENTS = 3;
+#else
+    typedef GLushort Index;
+    const static GLenum IndexType = GL_UNSIGNED_SHORT;
+    const static unsigned int MAX_VERTICES = 32768;
+    const static unsigned int RING_SEGMENTS = 2;
+#endif
     const static unsigned int MAX_TRIANGLES = (MAX_VERTICES / 4) * 6;
+    const static unsigned int RING_VERTICES = MAX_VERTICES * RING_SEGMENTS;
+    const static unsigned int RING_TRIANGLES = MAX_TRIANGLES * RING_SEGMENTS;
 
-    VertexRenderer() {
+    VertexRenderer() : vertexIndex(0), triangleIndex(0), baseVertex(0), baseTriangle(0), drawCalls(0), verticesRendered(0), bytesUploaded(0), bufferOrphans(0) {
         glGenBuffers(1, &vertexBuffer);
         glGenBuffers(1, &indexBuffer);
         
         glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * MAX_VERTICES, 0, GL_DYNAMIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * RING_VERTICES, 0, GL_STREAM_DRAW);
         
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLshort) * MAX_TRIANGLES, 0, GL_DYNAMIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Index) * RING_TRIANGLES, 0, GL_STREAM_DRAW);
     }
 
     ~VertexRenderer() {
@@ -42,44 +59,62 @@ public:
     
     void Begin(const size_t &vertexCount, const size_t &trianglesCount) {
         if (
-        ((vertexCount + vertexIndex)>=MAX_VERTICES) ||
-        ((trianglesCount + triangleIndex)>=MAX_TRIANGLES)
+        ((vertexCount + vertexIndex)>MAX_VERTICES) ||
+        ((trianglesCount + triangleIndex)>MAX_TRIANGLES) ||
+        ((vertexCount + vertexIndex + baseVertex)>RING_VERTICES) ||
+        ((trianglesCount + triangleIndex + baseTriangle)>RING_TRIANGLES)
         )
         {
             Render();
+            if ((vertexCount + baseVertex)>RING_VERTICES ||
+                (trianglesCount + baseTriangle)>RING_TRIANGLES) {
+                Orphan();
+            }
         }
     }
     
+    // Batch local counts, indices written to triangles must be offset by baseVertex + vertexIndex.
     size_t vertexIndex;
     size_t triangleIndex;
     
+    // Ring position the current batch will be uploaded to.
+    size_t baseVertex;
+    size_t baseTriangle;
+    
     Vertex vertices[MAX_VERTICES];
-    GLshort triangles[MAX_TRIANGLES];
+    Index triangles[MAX_TRIANGLES];
 
     void Render() {
         if (vertexIndex==0) return;
         
         glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertexIndex, vertices, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(Vertex) * baseVertex, sizeof(Vertex) * vertexIndex, vertices);
         
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLshort) * triangleIndex, triangles, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Index) * baseTriangle, sizeof(Index) * triangleIndex, triangles);
+        
+        glDrawElements(GL_TRIANGLES, (int)triangleIndex, IndexType, (GLvoid*)(sizeof(Index) * baseTriangle));
         
-		glDrawElements(GL_TRIANGLES, (int)triangleIndex, GL_UNSIGNED_SHORT, 0);
-
-		
-		
         drawCalls++;
         verticesRendered += vertexIndex;
+        bytesUploaded += sizeof(Vertex) * vertexIndex + sizeof(Index) * triangleIndex;
+        baseVertex += vertexIndex;
+        baseTriangle += triangleIndex;
         vertexIndex = 0;
         triangleIndex = 0;
     }
     
+    void Bind() {
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    }
+    
     void BeginLoop() {
         vertexIndex = 0;
         triangleIndex = 0;
         drawCalls=0;
         verticesRendered = 0;
+        bytesUploaded = 0;
     }
     
     void EndLoop() {
@@ -88,10 +123,24 @@ public:
 
     int drawCalls;
     int verticesRendered;
+    size_t bytesUploaded;
+    // Times the ring wrapped and the buffers were respecified.
+    int bufferOrphans;
 
 private:
+    // Gives the driver fresh storage for the ring, regions still read by the gpu stay with the old storage.
+    void Orphan() {
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * RING_VERTICES, 0, GL_STREAM_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Index) * RING_TRIANGLES, 0, GL_STREAM_DRAW);
+        baseVertex = 0;
+        baseTriangle = 0;
+        bufferOrphans++;
+    }
+
     GLuint vertexBuffer;
     GLuint indexBuffer;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,271 @@
+//
+//  JobSystem.cpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "JobSystem.hpp"
+
+using namespace Pocket;
+
+namespace {
+    struct ThreadSlot {
+        const JobSystem* system;
+        int index;
+    };
+    thread_local ThreadSlot currentSlot = { 0, 0 };
+}
+
+JobHandle::JobHandle() : counter(std::make_shared<Counter>()) {
+    counter->pending = 0;
+}
+
+bool JobHandle::IsDone() const {
+    return counter->pending.load() == 0;
+}
+
+static int DefaultThreadCount() {
+#ifdef EMSCRIPTEN
+    return 0;
+#else
+    int hardwareThreads = (int)std::thread::hardware_concurrency();
+    return hardwareThreads>2 ? hardwareThreads - 1 : 1;
+#endif
+}
+
+static const int MaxBackgroundThreads = 2;
+
+JobSystem::JobSystem() : JobSystem(DefaultThreadCount()) { }
+
+JobSystem::JobSystem(int threadCount) : threadCount(0), queuedJobs(0), stopping(false), idleBackgroundThreads(0), stoppingBackground(false) {
+    queues.emplace_back(new Queue());
+    SetThreadCount(threadCount);
+}
+
+JobSystem::~JobSystem() {
+    StopBackgroundThreads();
+    StopThreads();
+}
+
+JobSystem& JobSystem::Default() {
+    static JobSystem jobSystem;
+    return jobSystem;
+}
+
+void JobSystem::SetThreadCount(int count) {
+    if (count<0) count = 0;
+    if (count == threadCount && (int)threads.size() == count) return;
+    StopThreads();
+    threadCount = count;
+    while ((int)queues.size()<threadCount + 1) {
+        queues.emplace_back(new Queue());
+    }
+    StartThreads();
+}
+
+int JobSystem::ThreadCount() const { return threadCount; }
+
+JobHandle JobSystem::Schedule(const Job& job) {
+    JobHandle handle;
+    Schedule(job, handle);
+    return handle;
+}
+
+JobHandle JobSystem::Schedule(const Job& job, const Job& continuation) {
+    return Schedule([this, job, continuation] () {
+        job();
+        RunOnMainThread(continuation);
+    });
+}
+
+void JobSystem::Schedule(const Job& job, const JobHandle& handle) {
+    if (threadCount == 0) {
+        job();
+        return;
+    }
+    std::shared_ptr<JobHandle::Counter> counter = handle.counter;
+    counter->pending++;
+    Push([job, counter] () {
+        job();
+        counter->pending--;
+    });
+}
+
+JobHandle JobSystem::ScheduleBackground(const Job& job) {
+    JobHandle handle;
+    if (threadCount == 0) {
+        job();
+        return handle;
+    }
+    std::shared_ptr<JobHandle::Counter> counter = handle.counter;
+    counter->pending++;
+    {
+        std::lock_guard<std::mutex> lock(backgroundMutex);
+        backgroundJobs.push_back([job, counter] () {
+            job();
+            counter->pending--;
+        });
+        if (idleBackgroundThreads == 0 && (int)backgroundThreads.size()<MaxBackgroundThreads) {
+            backgroundThreads.emplace_back(&JobSystem::BackgroundLoop, this);
+        }
+    }
+    backgroundAvailable.notify_one();
+    return handle;
+}
+
+JobHandle JobSystem::ScheduleParallelFor(int count, int batchSize, const RangeJob& job) {
+    JobHandle handle;
+    if (batchSize<1) batchSize = 1;
+    for(int begin = 0; begin<count; begin+=batchSize) {
+        int end = begin + batchSize < count ? begin + batchSize : count;
+        Schedule([job, begin, end] () {
+            job(begin, end);
+        }, handle);
+    }
+    return handle;
+}
+
+void JobSystem::ParallelFor(int count, int batchSize, const RangeJob& job) {
+    Wait(ScheduleParallelFor(count, batchSize, job));
+}
+
+void JobSystem::Wait(const JobHandle& handle) {
+    int index = CurrentIndex();
+    while (!handle.IsDone()) {
+        if (!TryExecute(index)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::RunOnMainThread(const Job& continuation) {
+    std::lock_guard<std::mutex> lock(continuationMutex);
+    continuations.push_back(continuation);
+}
+
+void JobSystem::Update() {
+    {
+        std::lock_guard<std::mutex> lock(continuationMutex);
+        if (continuations.empty()) return;
+        runningContinuations.swap(continuations);
+    }
+    for(auto& continuation : runningContinuations) {
+        continuation();
+    }
+    runningContinuations.clear();
+}
+
+void JobSystem::StartThreads() {
+    stopping = false;
+    for(int i=0; i<threadCount; ++i) {
+        threads.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+    }
+}
+
+void JobSystem::StopThreads() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for(auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+    while (TryExecute(0)) { }
+}
+
+void JobSystem::WorkerLoop(int index) {
+    currentSlot = { this, index };
+    while (true) {
+        if (TryExecute(index)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        workAvailable.wait(lock, [this] () {
+            return stopping || queuedJobs.load()>0;
+        });
+        if (stopping) break;
+    }
+}
+
+void JobSystem::Push(Job&& job) {
+    Queue& queue = *queues[CurrentIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    queuedJobs++;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    workAvailable.notify_one();
+}
+
+bool JobSystem::TryExecute(int index) {
+    Job job;
+    if (!TryPop(index, job)) return false;
+    job();
+    return true;
+}
+
+bool JobSystem::TryPop(int index, Job& job) {
+    {
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            queuedJobs--;
+            return true;
+        }
+    }
+    int count = (int)queues.size();
+    for(int i=1; i<count; ++i) {
+        Queue& victim = *queues[(index + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            queuedJobs--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::BackgroundLoop() {
+    std::unique_lock<std::mutex> lock(backgroundMutex);
+    while (true) {
+        if (!backgroundJobs.empty()) {
+            Job job = std::move(backgroundJobs.front());
+            backgroundJobs.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+            continue;
+        }
+        if (stoppingBackground) break;
+        idleBackgroundThreads++;
+        backgroundAvailable.wait(lock, [this] () {
+            return stoppingBackground || !backgroundJobs.empty();
+        });
+        idleBackgroundThreads--;
+    }
+}
+
+void JobSystem::StopBackgroundThreads() {
+    {
+        std::lock_guard<std::mutex> lock(backgroundMutex);
+        stoppingBackground = true;
+    }
+    backgroundAvailable.notify_all();
+    for(auto& thread : backgroundThreads) {
+        thread.join();
+    }
+    backgroundThreads.clear();
+}
+
+int JobSystem::CurrentIndex() const {
+    return currentSlot.system == this ? currentSlot.index : 0;
+}
@@ -0,0 +1,105 @@
+//
+//  JobSystem.hpp
+//  PocketEngine
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+namespace Pocket {
+    class JobSystem;
+
+    // Tracks completion of one or more scheduled jobs.
+    class JobHandle {
+    public:
+        JobHandle();
+        bool IsDone() const;
+    private:
+        struct Counter {
+            std::atomic<int> pending;
+        };
+        std::shared_ptr<Counter> counter;
+        friend class JobSystem;
+    };
+
+    // Engine wide pool of worker threads. Each worker owns a deque of jobs,
+    // it pops its own jobs from the back and steals from the front of other workers
+    // deques when it runs dry. Threads waiting on a handle help out executing jobs.
+    // Continuations are queued for the main thread and run from Update().
+    // Long or blocking jobs go to ScheduleBackground, they run on separate threads
+    // which Wait never helps with, so frame work is not stuck behind them.
+    class JobSystem {
+    public:
+        using Job = std::function<void()>;
+        using RangeJob = std::function<void(int begin, int end)>;
+
+        JobSystem();
+        JobSystem(int threadCount);
+        ~JobSystem();
+
+        static JobSystem& Default();
+
+        void SetThreadCount(int count);
+        int ThreadCount() const;
+
+        JobHandle Schedule(const Job& job);
+        JobHandle Schedule(const Job& job, const Job& continuation);
+        void Schedule(const Job& job, const JobHandle& handle);
+
+        JobHandle ScheduleBackground(const Job& job);
+
+        JobHandle ScheduleParallelFor(int count, int batchSize, const RangeJob& job);
+        void ParallelFor(int count, int batchSize, const RangeJob& job);
+
+        void Wait(const JobHandle& handle);
+
+        void RunOnMainThread(const Job& continuation);
+        void Update();
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        void StartThreads();
+        void StopThreads();
+        void WorkerLoop(int index);
+        void Push(Job&& job);
+        bool TryExecute(int index);
+        bool TryPop(int index, Job& job);
+        int CurrentIndex() const;
+        void BackgroundLoop();
+        void StopBackgroundThreads();
+
+        int threadCount;
+        std::vector<std::thread> threads;
+        std::vector<std::unique_ptr<Queue>> queues;
+
+        std::mutex sleepMutex;
+        std::condition_variable workAvailable;
+        std::atomic<int> queuedJobs;
+        bool stopping;
+
+        std::mutex continuationMutex;
+        std::vector<Job> continuations;
+        std::vector<Job> runningContinuations;
+
+        std::mutex backgroundMutex;
+        std::condition_variable backgroundAvailable;
+        std::deque<Job> backgroundJobs;
+        std::vector<std::thread> backgroundThreads;
+        int idleBackgroundThreads;
+        bool stoppingBackground;
+    };
+}
@@ -40,11 +40,14 @@ $(LOCAL_PATH)/$(POCKET)/Platform/Android \
 $(LOCAL_PATH)/$(POCKET)/PngLib \
 $(LOCAL_PATH)/$(POCKET)/Profiler \
 $(LOCAL_PATH)/$(POCKET)/Rendering \
+$(LOCAL_PATH)/$(POCKET)/Threads \
 $(LOCAL_PATH)/$(POCKET)/TinyXml \
 $(LOCAL_PATH)/$(POCKET)/Serialization/Json \
 /Users/Jeppe/Downloads/android-ndk-r10e/sources/cxx-stl/gnu-libstdc++/4.8/include/bits \
 
 LOCAL_SRC_FILES := \
+$(POCKET)/ComponentSystem/Archetype.cpp \
+$(POCKET)/ComponentSystem/CommandBuffer.cpp \
 $(POCKET)/ComponentSystem/GameComponent.cpp \
 $(POCKET)/ComponentSystem/GameComponentType.cpp \
 $(POCKET)/ComponentSystem/GameFactory.cpp \
@@ -52,6 +55,7 @@ $(POCKET)/ComponentSystem/GameObject.cpp \
 $(POCKET)/ComponentSystem/GameSystem.cpp \
 $(POCKET)/ComponentSystem/GameWorld.cpp \
 $(POCKET)/ComponentSystem/SerializedProperty.cpp \
+$(POCKET)/ComponentSystem/SystemScheduler.cpp \
 \
 $(POCKET)/Core/Engine.cpp \
 $(POCKET)/Core/GameManager.cpp \
@@ -63,6 +67,7 @@ $(POCKET)/Core/Window.cpp \
 \
 $(POCKET)/Data/BezierCurve1.cpp \
 $(POCKET)/Data/BezierCurve3.cpp \
+$(POCKET)/Data/DynamicTree.cpp \
 $(POCKET)/Data/ICellItem.cpp \
 $(POCKET)/Data/IPointable.cpp \
 $(POCKET)/Data/Octree.cpp \
@@ -161,6 +166,7 @@ $(POCKET)/Math/Interpolator.cpp \
 $(POCKET)/Math/MathHelper.cpp \
 $(POCKET)/Math/Matrix3x3.cpp \
 $(POCKET)/Math/Matrix4x4.cpp \
+$(POCKET)/Math/OcclusionBuffer.cpp \
 $(POCKET)/Math/Plane.cpp \
 $(POCKET)/Math/Point.cpp \
 $(POCKET)/Math/Point3.cpp \
@@ -184,13 +190,19 @@ $(POCKET)/Profiler/Profiler.cpp \
 \
 $(POCKET)/Rendering/Clipper.cpp \
 $(POCKET)/Rendering/Colour.cpp \
+$(POCKET)/Rendering/GpuTimer.cpp \
+$(POCKET)/Rendering/RenderQueue.cpp \
 $(POCKET)/Rendering/Shader.cpp \
 $(POCKET)/Rendering/ShaderCollection.cpp \
 $(POCKET)/Rendering/Texture.cpp \
 $(POCKET)/Rendering/TextureAtlas.cpp \
 $(POCKET)/Rendering/TexturePacker.cpp \
+$(POCKET)/Rendering/TexturePage.cpp \
+$(POCKET)/Rendering/TriangleTree.cpp \
 $(POCKET)/Rendering/Vertex.cpp \
 \
+$(POCKET)/Threads/JobSystem.cpp \
+\
 $(POCKET)/TinyXml/tinystr.cpp \
 $(POCKET)/TinyXml/tinyxml.cpp \
 $(POCKET)/TinyXml/tinyxmlerror.cpp \
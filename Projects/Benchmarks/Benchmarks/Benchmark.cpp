@@ -0,0 +1,87 @@
+//
+//  Benchmark.cpp
+//  Benchmarks
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "Benchmark.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+Benchmark::~Benchmark() {}
+
+static long long Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template<typename T>
+static T Percentile(std::vector<T> values, int percentile) {
+    std::sort(values.begin(), values.end());
+    size_t index = (values.size() * percentile) / 100;
+    if (index>=values.size()) index = values.size() - 1;
+    return values[index];
+}
+
+static std::string Escape(const std::string& text) {
+    std::string escaped;
+    for(auto c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void Benchmark::Run(const Options& options, std::ostream& output) {
+    entries.clear();
+    RunBenchmarks();
+
+    int samples = options.samples>0 ? options.samples : 1;
+
+    for(auto& entry : entries) {
+        if (!options.filter.empty() && entry.name.find(options.filter) == std::string::npos) continue;
+
+        std::vector<long long> times;
+        std::vector<size_t> allocations;
+        std::vector<size_t> allocatedBytes;
+
+        // first run warms up caches and lazily created statics, it is not recorded
+        for(int i=-1; i<samples; ++i) {
+            current = { 0, 0, 0 };
+            entry.benchmark();
+            if (i<0) continue;
+            times.push_back(current.nanoseconds);
+            allocations.push_back(current.allocations);
+            allocatedBytes.push_back(current.allocatedBytes);
+        }
+
+        output << "{\"name\":\"" << Escape(entry.name) << "\""
+               << ",\"operations\":" << entry.operations
+               << ",\"samples\":" << samples
+               << ",\"min_ns\":" << Percentile(times, 0)
+               << ",\"median_ns\":" << Percentile(times, 50)
+               << ",\"p99_ns\":" << Percentile(times, 99)
+               << ",\"allocations\":" << Percentile(allocations, 50)
+               << ",\"allocated_bytes\":" << Percentile(allocatedBytes, 50)
+               << "}" << std::endl;
+    }
+}
+
+void Benchmark::AddBenchmark(const std::string &name, size_t operations, Method benchmark) {
+    entries.push_back({name, operations, benchmark});
+}
+
+void Benchmark::Begin() {
+    beginAllocations = AllocationCounter::Allocations();
+    beginAllocatedBytes = AllocationCounter::AllocatedBytes();
+    beginTime = Now();
+}
+
+void Benchmark::End() {
+    long long endTime = Now();
+    current.nanoseconds += endTime - beginTime;
+    current.allocations += AllocationCounter::Allocations() - beginAllocations;
+    current.allocatedBytes += AllocationCounter::AllocatedBytes() - beginAllocatedBytes;
+}
@@ -0,0 +1,64 @@
+//
+//  Benchmark.hpp
+//  Benchmarks
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+// Runs each added benchmark a number of samples, only the code between Begin() and End() is measured.
+// Results are written as one json object per line:
+// {"name":..., "operations":..., "samples":..., "min_ns":..., "median_ns":..., "p99_ns":..., "allocations":..., "allocated_bytes":...}
+class Benchmark {
+public:
+    struct Options {
+        Options() : samples(15) {}
+        std::string filter;
+        int samples;
+    };
+
+    virtual ~Benchmark();
+    void Run(const Options& options, std::ostream& output);
+protected:
+    using Method = std::function<void()>;
+
+    void AddBenchmark(const std::string& name, size_t operations, Method benchmark);
+
+    void Begin();
+    void End();
+
+    virtual void RunBenchmarks() = 0;
+private:
+    struct Entry {
+        std::string name;
+        size_t operations;
+        Method benchmark;
+    };
+
+    using Entries = std::vector<Entry>;
+    Entries entries;
+
+    struct Sample {
+        long long nanoseconds;
+        size_t allocations;
+        size_t allocatedBytes;
+    };
+
+    Sample current;
+    long long beginTime;
+    size_t beginAllocations;
+    size_t beginAllocatedBytes;
+};
+
+// Counts calls to the global operator new, see AllocationCounter.cpp
+struct AllocationCounter {
+    static size_t Allocations();
+    static size_t AllocatedBytes();
+};
@@ -0,0 +1,184 @@
+//
+//  ComponentSystemBenchmarks.cpp
+//  Benchmarks
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "ComponentSystemBenchmarks.hpp"
+#include "GameWorld.hpp"
+#include "GameSystem.hpp"
+#include <sstream>
+
+using namespace Pocket;
+
+namespace {
+    struct Position {
+        float x;
+        float y;
+        TYPE_FIELDS_BEGIN
+        TYPE_FIELD(x)
+        TYPE_FIELD(y)
+        TYPE_FIELDS_END
+    };
+
+    struct Velocity {
+        float x;
+        float y;
+        TYPE_FIELDS_BEGIN
+        TYPE_FIELD(x)
+        TYPE_FIELD(y)
+        TYPE_FIELDS_END
+    };
+
+    struct Health {
+        int value;
+        TYPE_FIELDS_BEGIN
+        TYPE_FIELD(value)
+        TYPE_FIELDS_END
+    };
+
+    struct MovementSystem : public GameSystem<Position, Velocity> {
+        void Update(float dt) override {
+            ForEach([dt] (Position& position, Velocity& velocity) {
+                position.x += velocity.x * dt;
+                position.y += velocity.y * dt;
+            });
+        }
+    };
+
+    struct HealthSystem : public GameSystem<Health> {
+        void Update(float dt) override {
+            ForEach([] (Health& health) {
+                health.value++;
+            });
+        }
+    };
+
+    struct PositionSystem : public GameSystem<Position> { };
+
+    GameObject* CreateObjects(GameObject* root, int count) {
+        for(int i=0; i<count; ++i) {
+            GameObject* object = root->CreateObject();
+            object->AddComponent<Position>()->x = (float)i;
+            object->AddComponent<Velocity>()->x = 1.0f;
+            if (i % 2 == 0) {
+                object->AddComponent<Health>();
+            }
+        }
+        return root;
+    }
+}
+
+void ComponentSystemBenchmarks::RunBenchmarks() {
+
+    const int Count = 10000;
+
+    AddBenchmark("GameObject create x 10000", Count, [this, Count] () {
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        root->CreateSystem<MovementSystem>();
+        world.Update(0);
+        Begin();
+        CreateObjects(root, Count);
+        world.Update(0);
+        End();
+    });
+
+    AddBenchmark("GameObject remove x 10000", Count, [this, Count] () {
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        root->CreateSystem<MovementSystem>();
+        root->CreateSystem<HealthSystem>();
+        CreateObjects(root, Count);
+        world.Update(0);
+        ObjectCollection children = root->Children();
+        Begin();
+        for(auto child : children) {
+            child->Remove();
+        }
+        world.Update(0);
+        End();
+    });
+
+    AddBenchmark("GameObject CreateChildClone x 1000 (10 children)", 1000, [this] () {
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        root->CreateSystem<MovementSystem>();
+        GameObject* source = root->CreateObject();
+        source->AddComponent<Position>();
+        CreateObjects(source, 10);
+        world.Update(0);
+        Begin();
+        for(int i=0; i<1000; ++i) {
+            root->CreateChildClone(source);
+        }
+        world.Update(0);
+        End();
+    });
+
+    AddBenchmark("GameSystem add/remove x 100 (10000 objects)", 100, [this, Count] () {
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        root->CreateSystem<MovementSystem>();
+        CreateObjects(root, Count);
+        world.Update(0);
+        Begin();
+        for(int i=0; i<100; ++i) {
+            root->CreateSystem<PositionSystem>();
+            world.Update(0);
+            root->RemoveSystem<PositionSystem>();
+            world.Update(0);
+        }
+        End();
+    });
+
+    AddBenchmark("GameWorld Update x 100 (10000 objects, 2 systems)", 100, [this, Count] () {
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        root->CreateSystem<MovementSystem>();
+        root->CreateSystem<HealthSystem>();
+        CreateObjects(root, Count);
+        world.Update(0);
+        Begin();
+        for(int i=0; i<100; ++i) {
+            world.Update(0.016f);
+        }
+        End();
+    });
+
+    AddBenchmark("GameObject ToJson (10000 objects)", Count, [this, Count] () {
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        root->CreateSystem<MovementSystem>();
+        root->CreateSystem<HealthSystem>();
+        CreateObjects(root, Count);
+        world.Update(0);
+        std::stringstream stream;
+        Begin();
+        root->ToJson(stream);
+        End();
+    });
+
+    AddBenchmark("GameWorld CreateRootFromJson (10000 objects)", Count, [this, Count] () {
+        std::stringstream stream;
+        {
+            GameWorld world;
+            GameObject* root = world.CreateRoot();
+            root->CreateSystem<MovementSystem>();
+            root->CreateSystem<HealthSystem>();
+            CreateObjects(root, Count);
+            world.Update(0);
+            root->ToJson(stream);
+        }
+        GameWorld world;
+        Begin();
+        world.CreateRootFromJson(stream, [] (GameObject* root) {
+            root->CreateSystem<MovementSystem>();
+            root->CreateSystem<HealthSystem>();
+        });
+        world.Update(0);
+        End();
+    });
+}
@@ -0,0 +1,15 @@
+//
+//  ComponentSystemBenchmarks.hpp
+//  Benchmarks
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#pragma once
+#include "Benchmark.hpp"
+
+class ComponentSystemBenchmarks : public Benchmark {
+protected:
+    void RunBenchmarks() override;
+};
@@ -0,0 +1,73 @@
+//
+//  EngineBenchmarks.cpp
+//  Benchmarks
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "EngineBenchmarks.hpp"
+#include "Engine.hpp"
+#include "GameWorld.hpp"
+#include "GameSystem.hpp"
+#include <cstdlib>
+
+using namespace Pocket;
+
+namespace {
+    struct Velocity {
+        float x;
+        float y;
+    };
+
+    struct Position {
+        float x;
+        float y;
+    };
+
+    struct MovementSystem : public GameSystem<Position, Velocity> {
+        void Update(float dt) override {
+            ForEach([dt] (Position& position, Velocity& velocity) {
+                position.x += velocity.x * dt;
+                position.y += velocity.y * dt;
+            });
+        }
+    };
+
+    struct Simulation : public GameState<Simulation> {
+        GameWorld world;
+
+        void Initialize() override {
+            GameObject* root = world.CreateRoot();
+            root->CreateSystem<MovementSystem>();
+            for(int i=0; i<10000; ++i) {
+                GameObject* object = root->CreateObject();
+                object->AddComponent<Position>();
+                object->AddComponent<Velocity>()->x = 1.0f;
+            }
+        }
+
+        void Update(float dt) override {
+            world.Update(dt);
+        }
+
+        void Render() override {
+            world.Render();
+        }
+    };
+}
+
+void EngineBenchmarks::RunBenchmarks() {
+
+    // Full Engine main loop on the headless platform window, unthrottled.
+    AddBenchmark("Engine headless loop x 100 frames (10000 objects)", 100, [this] () {
+        setenv("POCKET_HEADLESS_FRAMES", "100", 1);
+        setenv("POCKET_HEADLESS_FPS", "0", 1);
+        Begin();
+        {
+            Engine engine;
+            engine.Start<Simulation>();
+        }
+        End();
+    });
+}
@@ -0,0 +1,15 @@
+//
+//  HeadlessStubs.cpp
+//  Benchmarks
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+// The editor callback lives in Logic/Editor, which the benchmarks do not build.
+
+#include "TypeInfo.hpp"
+
+using namespace Pocket;
+
+TypeEditorTitle::Callback TypeEditorTitle::Title = 0;
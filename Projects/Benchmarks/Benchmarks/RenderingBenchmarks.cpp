@@ -0,0 +1,230 @@
+//
+//  RenderingBenchmarks.cpp
+//  Benchmarks
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "RenderingBenchmarks.hpp"
+#include "Shader.hpp"
+#include "RenderSystem.hpp"
+#include "RenderQueue.hpp"
+#include "Engine.hpp"
+#include "GameWorld.hpp"
+#include "OpenGL.hpp"
+#include <memory>
+
+using namespace Pocket;
+
+static GameObject* CreateCubeScene(GameWorld& world, int count, bool isStatic) {
+    GameObject* root = world.CreateRoot();
+    root->CreateSystem<RenderSystem>();
+    GameObject* camera = root->CreateObject();
+    camera->AddComponent<Transform>()->Position = Vector3(0, 0, 150);
+    camera->AddComponent<Camera>();
+    int size = (int)std::sqrt((float)count);
+    for(int i=0; i<count; ++i) {
+        GameObject* cube = root->CreateObject();
+        cube->AddComponent<Transform>()->Position = Vector3((float)(i % size) * 2.0f - size, (float)(i / size) * 2.0f - size, 0);
+        cube->AddComponent<Mesh>()->GetMesh<Vertex>().AddCube(0, 0.5f);
+        cube->AddComponent<Renderable>()->Static = isStatic;
+    }
+    return camera;
+}
+
+// Wall in front of the left half of the cube scene.
+static void CreateOccluder(GameWorld& world) {
+    GameObject* wall = world.Roots()[0]->CreateObject();
+    wall->AddComponent<Transform>()->Position = Vector3(0, 0, 100);
+    wall->AddComponent<Mesh>()->GetMesh<Vertex>().AddCube(Vector3(-60, 0, 0), Vector3(60, 120, 1));
+    wall->AddComponent<Occluder>();
+}
+
+// Alpha blended sprites cycling through 8 images and 4 orders, like a gui screen.
+static void CreateSpriteScene(GameWorld& world, int count, TexturePage* page) {
+    GameObject* root = world.CreateRoot();
+    root->CreateSystem<RenderSystem>();
+    GameObject* camera = root->CreateObject();
+    camera->AddComponent<Transform>()->Position = Vector3(0, 0, 150);
+    camera->AddComponent<Camera>();
+    std::vector<GameObject*> images;
+    std::vector<unsigned char> pixels(32 * 32 * 4, 255);
+    for(int i=0; i<8; ++i) {
+        GameObject* image = root->CreateObject();
+        TextureComponent* texture = image->AddComponent<TextureComponent>();
+        if (page) {
+            texture->LoadIntoPage(&pixels[0], 32, 32, *page);
+        } else {
+            texture->Texture().CreateFromBuffer(&pixels[0], 32, 32, GL_RGBA);
+        }
+        images.push_back(image);
+    }
+    int size = (int)std::sqrt((float)count);
+    for(int i=0; i<count; ++i) {
+        GameObject* sprite = root->CreateObject();
+        sprite->AddComponent<Transform>()->Position = Vector3((float)(i % size) * 2.0f - size, (float)(i / size) * 2.0f - size, 0);
+        sprite->AddComponent<Mesh>()->GetMesh<Vertex>().AddPlane(0, 1.5f, Box(0, 0, 1, 1));
+        sprite->AddComponent<Renderable>()->BlendMode = BlendModeType::Alpha;
+        sprite->AddComponent<Orderable>()->Order = i % 4;
+        sprite->AddComponent<TextureComponent>(images[(i * 7) % 8]);
+    }
+}
+
+void RenderingBenchmarks::RunBenchmarks() {
+
+    // CPU batching path: vertices are transformed into the renderer and flushed when full.
+    AddBenchmark("Shader<Vertex>::RenderObject x 10000 cubes", 10000, [this] () {
+        Shader<Vertex> shader;
+        std::unique_ptr<VertexRenderer<Vertex>> renderer(new VertexRenderer<Vertex>());
+        VertexMesh<Vertex> mesh;
+        mesh.AddCube(0, 1);
+        std::vector<Matrix4x4> worlds;
+        for(int i=0; i<10000; ++i) {
+            worlds.push_back(Matrix4x4::CreateTransform(Vector3((float)i, 0, 0), 1, Quaternion(i * 0.01f, Vector3(0, 1, 0))));
+        }
+        Begin();
+        renderer->BeginLoop();
+        for(auto& world : worlds) {
+            shader.RenderObject(*renderer, mesh.vertices, mesh.triangles, world);
+        }
+        renderer->EndLoop();
+        End();
+    });
+
+    AddBenchmark("Shader<Vertex>::RenderObject x 1000 spheres", 1000, [this] () {
+        Shader<Vertex> shader;
+        std::unique_ptr<VertexRenderer<Vertex>> renderer(new VertexRenderer<Vertex>());
+        VertexMesh<Vertex> mesh;
+        mesh.AddGeoSphere(0, 1, 16);
+        Matrix4x4 world = Matrix4x4::CreateTranslation(Vector3(1, 2, 3));
+        Begin();
+        renderer->BeginLoop();
+        for(int i=0; i<1000; ++i) {
+            shader.RenderObject(*renderer, mesh.vertices, mesh.triangles, world);
+        }
+        renderer->EndLoop();
+        End();
+    });
+
+    // Full RenderSystem frames against the null GL, static meshes skip the cpu transform and upload.
+    // The camera moves before the measured frame, so visibility is not served from the cache.
+    AddBenchmark("RenderSystem::Render x 10000 dynamic cubes", 10000, [this] () {
+        Engine engine;
+        GameWorld world;
+        GameObject* camera = CreateCubeScene(world, 10000, false);
+        world.Update(0);
+        world.Render();
+        camera->GetComponent<Transform>()->Position = Vector3(0, 0, 151);
+        Begin();
+        world.Render();
+        End();
+    });
+
+    AddBenchmark("RenderSystem::Render x 10000 static cubes", 10000, [this] () {
+        Engine engine;
+        GameWorld world;
+        GameObject* camera = CreateCubeScene(world, 10000, true);
+        world.Update(0);
+        world.Render();
+        camera->GetComponent<Transform>()->Position = Vector3(0, 0, 151);
+        Begin();
+        world.Render();
+        End();
+    });
+
+    AddBenchmark("RenderSystem::Render x 10000 dynamic cubes, unchanged frame", 10000, [this] () {
+        Engine engine;
+        GameWorld world;
+        CreateCubeScene(world, 10000, false);
+        world.Update(0);
+        world.Render();
+        Begin();
+        world.Render();
+        End();
+    });
+
+    AddBenchmark("RenderSystem::Render x 10000 static cubes, unchanged frame", 10000, [this] () {
+        Engine engine;
+        GameWorld world;
+        CreateCubeScene(world, 10000, true);
+        world.Update(0);
+        world.Render();
+        Begin();
+        world.Render();
+        End();
+    });
+
+    // Front to back ordering with a depth pre pass, the opaque cubes are submitted twice.
+    AddBenchmark("RenderSystem::Render x 10000 dynamic cubes, front to back with depth pre pass", 10000, [this] () {
+        Engine engine;
+        GameWorld world;
+        GameObject* camera = CreateCubeScene(world, 10000, false);
+        camera->GetComponent<Camera>()->DepthPrePass = true;
+        world.Update(0);
+        world.Render();
+        RenderSystem* renderSystem = world.Roots()[0]->CreateSystem<RenderSystem>();
+        renderSystem->SetOpaqueOrder(RenderSystem::OpaqueOrder::FrontToBack);
+        camera->GetComponent<Transform>()->Position = Vector3(0, 0, 151);
+        Begin();
+        world.Render();
+        End();
+    });
+
+    // Half the cubes are behind an occluder, culled on the cpu when occlusion culling is on.
+    for(bool occlusionCulling : { false, true }) {
+        std::string name = "RenderSystem::Render x 10000 dynamic cubes, half behind an occluder";
+        if (occlusionCulling) name += ", occlusion culling";
+        AddBenchmark(name, 10000, [this, occlusionCulling] () {
+            Engine engine;
+            GameWorld world;
+            GameObject* camera = CreateCubeScene(world, 10000, false);
+            CreateOccluder(world);
+            world.Roots()[0]->CreateSystem<RenderSystem>()->SetOcclusionCulling(occlusionCulling);
+            world.Update(0);
+            world.Render();
+            camera->GetComponent<Transform>()->Position = Vector3(0, 0, 151);
+            Begin();
+            world.Render();
+            End();
+        });
+    }
+
+    // Sprites packed into one TexturePage share a texture binding and are drawn in a few batches.
+    AddBenchmark("RenderSystem::Render x 4000 sprites, 8 textures", 4000, [this] () {
+        Engine engine;
+        GameWorld world;
+        CreateSpriteScene(world, 4000, 0);
+        world.Update(0);
+        world.Render();
+        RenderSystem* renderSystem = world.Roots()[0]->CreateSystem<RenderSystem>();
+        renderSystem->InvalidateVisibility();
+        Begin();
+        world.Render();
+        End();
+    });
+
+    AddBenchmark("RenderSystem::Render x 4000 sprites, 8 images in one page", 4000, [this] () {
+        Engine engine;
+        GameWorld world;
+        TexturePage page(512, 512);
+        CreateSpriteScene(world, 4000, &page);
+        world.Update(0);
+        world.Render();
+        RenderSystem* renderSystem = world.Roots()[0]->CreateSystem<RenderSystem>();
+        renderSystem->InvalidateVisibility();
+        Begin();
+        world.Render();
+        End();
+    });
+
+    AddBenchmark("RenderQueue::Sort x 20000 opaque keys", 20000, [this] () {
+        RenderQueue queue;
+        for(int i=0; i<20000; ++i) {
+            queue.Add(RenderQueue::OpaqueKey(0, 0, i % 3, (i * 7) % 40, false, ((i * 7919) % 20000) / 10000.0f - 1.0f), (uint32_t)i);
+        }
+        Begin();
+        queue.Sort();
+        End();
+    });
+}
@@ -0,0 +1,169 @@
+//
+//  SpatialBenchmarks.cpp
+//  Benchmarks
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include "SpatialBenchmarks.hpp"
+#include "GameWorld.hpp"
+#include "OctreeSystem.hpp"
+
+using namespace Pocket;
+
+namespace {
+    using Octrees = OctreeSystem<>;
+
+    // Grid of cubes spread over the default octree bounds, or over a larger area than them.
+    Octrees* CreateGrid(GameObject* root, int size, bool dynamicTree = false, float area = 800.0f) {
+        Octrees* octree = root->CreateSystem<Octrees>();
+        if (dynamicTree) {
+            octree->SetSpatialIndex<DynamicTree>();
+        }
+        float spacing = area / size;
+        for(int x=0; x<size; ++x) {
+            for(int y=0; y<size; ++y) {
+                for(int z=0; z<size; ++z) {
+                    GameObject* object = root->CreateObject();
+                    object->AddComponent<Transform>()->Position = Vector3(x, y, z) * spacing - area * 0.5f;
+                    object->AddComponent<Mesh>()->GetMesh<Vertex>().AddCube(0, 1);
+                }
+            }
+        }
+        root->World()->Update(0);
+        octree->UpdateAllNodes();
+        return octree;
+    }
+
+    // Rays from a camera in front of a sphere of radius 1.4 at the origin, like the touches of a frame.
+    void CreatePickRays(int frame, Ray* rays, int count) {
+        for(int i=0; i<count; ++i) {
+            Vector3 target(((frame * 7 + i * 37) % 30) * 0.1f - 1.5f, ((frame * 13 + i * 23) % 30) * 0.1f - 1.5f, 0);
+            rays[i] = Ray(Vector3(0, 0, 40), target - Vector3(0, 0, 40));
+        }
+    }
+
+    BoundingFrustum CreateFrustum(float angle) {
+        Matrix4x4 view = Matrix4x4::CreateRotation(Vector3(0, 1, 0), angle).Multiply(Matrix4x4::CreateTranslation(Vector3(0, 0, 600)));
+        Matrix4x4 viewProjection = Matrix4x4::CreatePerspective(60, 1.33f, 1, 1200).Multiply(view.Invert());
+        BoundingFrustum frustum;
+        frustum.SetFromViewProjection(viewProjection);
+        return frustum;
+    }
+}
+
+void SpatialBenchmarks::RunBenchmarks() {
+
+    for(bool dynamicTree : { false, true }) {
+        std::string name = dynamicTree ? ", dynamic tree" : "";
+
+        AddBenchmark("OctreeSystem frustum query x 100 (8000 objects)" + name, 100, [this, dynamicTree] () {
+            GameWorld world;
+            Octrees* octree = CreateGrid(world.CreateRoot(), 20, dynamicTree);
+            std::vector<BoundingFrustum> frustums;
+            for(int i=0; i<100; ++i) {
+                frustums.push_back(CreateFrustum(i * 0.0628f));
+            }
+            ObjectCollection objects;
+            objects.reserve(8000);
+            Begin();
+            for(auto& frustum : frustums) {
+                objects.clear();
+                octree->GetObjectsInFrustum(frustum, objects);
+            }
+            End();
+        });
+
+        AddBenchmark("OctreeSystem ray query x 1000 (8000 objects)" + name, 1000, [this, dynamicTree] () {
+            GameWorld world;
+            Octrees* octree = CreateGrid(world.CreateRoot(), 20, dynamicTree);
+            ObjectCollection objects;
+            objects.reserve(8000);
+            Begin();
+            for(int i=0; i<1000; ++i) {
+                objects.clear();
+                Vector3 start((i % 20) * 40.0f - 400.0f, ((i / 20) % 20) * 40.0f - 400.0f, -600);
+                octree->GetObjectsAtRay(Ray(start, Vector3(0, 0, 1)), objects);
+            }
+            End();
+        });
+
+        AddBenchmark("OctreeSystem ray query x 1000 in batches of 10 (8000 objects)" + name, 1000, [this, dynamicTree] () {
+            GameWorld world;
+            Octrees* octree = CreateGrid(world.CreateRoot(), 20, dynamicTree);
+            ObjectCollection objects[10];
+            Ray rays[10];
+            Begin();
+            for(int i=0; i<1000; i+=10) {
+                for(int r=0; r<10; ++r) {
+                    objects[r].clear();
+                    int ray = i + r;
+                    rays[r] = Ray(Vector3((ray % 20) * 40.0f - 400.0f, ((ray / 20) % 20) * 40.0f - 400.0f, -600), Vector3(0, 0, 1));
+                }
+                octree->GetObjectsAtRays(rays, 10, objects);
+            }
+            End();
+        });
+
+        AddBenchmark("OctreeSystem move x 8000" + name, 8000, [this, dynamicTree] () {
+            GameWorld world;
+            GameObject* root = world.CreateRoot();
+            Octrees* octree = CreateGrid(root, 20, dynamicTree);
+            ObjectCollection objects;
+            Begin();
+            for(auto child : root->Children()) {
+                Transform* transform = child->GetComponent<Transform>();
+                transform->Position = transform->Position() + Vector3(1, 0, 0);
+            }
+            octree->GetObjectsInFrustum(CreateFrustum(0), objects);
+            End();
+        });
+
+        // Objects spread far outside the world bounds end up in the root of the octree.
+        AddBenchmark("OctreeSystem frustum query x 100 (8000 objects outside the world bounds)" + name, 100, [this, dynamicTree] () {
+            GameWorld world;
+            Octrees* octree = CreateGrid(world.CreateRoot(), 20, dynamicTree, 8000.0f);
+            std::vector<BoundingFrustum> frustums;
+            for(int i=0; i<100; ++i) {
+                frustums.push_back(CreateFrustum(i * 0.0628f));
+            }
+            ObjectCollection objects;
+            objects.reserve(8000);
+            Begin();
+            for(auto& frustum : frustums) {
+                objects.clear();
+                octree->GetObjectsInFrustum(frustum, objects);
+            }
+            End();
+        });
+    }
+
+    // Brute force tests every triangle, Mesh builds a TriangleTree once it is picked again without having changed.
+    for(bool bruteForce : { true, false }) {
+        AddBenchmark(std::string("Mesh::IntersectsRay x 100 frames of 12 rays (sphere of 12288 triangles)") + (bruteForce ? ", brute force" : ""), 1200, [this, bruteForce] () {
+            Mesh mesh;
+            mesh.GetMesh<Vertex>().AddGeoSphere(0, 1.4f, 32);
+            VertexMesh<Vertex> vertexMesh = mesh.ConstMesh<Vertex>();
+            Ray rays[12];
+            TriangleHit hits[12];
+            CreatePickRays(0, rays, 12);
+            for(int i=0; i<2; ++i) {
+                mesh.IntersectsRays(rays, 12, hits);
+            }
+            Begin();
+            for(int frame=0; frame<100; ++frame) {
+                CreatePickRays(frame, rays, 12);
+                for(int i=0; i<12; ++i) {
+                    TriangleHit& hit = hits[i];
+                    if (bruteForce) {
+                        vertexMesh.IntersectsRay(rays[i], &hit.distance, &hit.u, &hit.v, &hit.triangleIndex, &hit.normal);
+                    } else {
+                        mesh.IntersectsRay(rays[i], &hit.distance, &hit.u, &hit.v, &hit.triangleIndex, &hit.normal);
+                    }
+                }
+            }
+            End();
+        });
+    }
+}
@@ -0,0 +1,62 @@
+//
+//  main.cpp
+//  Benchmarks
+//
+//  Created by Jeppe Nielsen on 16/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include "ComponentSystemBenchmarks.hpp"
+#include "SpatialBenchmarks.hpp"
+#include "RenderingBenchmarks.hpp"
+#include "EngineBenchmarks.hpp"
+
+// usage: Benchmarks [--filter <name substring>] [--samples <count>] [--output <file>]
+int main(int argc, const char * argv[]) {
+
+    Benchmark::Options options;
+    std::string outputPath;
+
+    for(int i=1; i<argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1<argc;
+        if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--samples" && hasValue) {
+            options.samples = std::atoi(argv[++i]);
+        } else if (arg == "--output" && hasValue) {
+            outputPath = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--filter <name substring>] [--samples <count>] [--output <file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath);
+        if (!file) {
+            std::cerr << "Unable to open " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = outputPath.empty() ? std::cout : file;
+
+    ComponentSystemBenchmarks componentSystem;
+    componentSystem.Run(options, output);
+
+    SpatialBenchmarks spatial;
+    spatial.Run(options, output);
+
+    RenderingBenchmarks rendering;
+    rendering.Run(options, output);
+
+    EngineBenchmarks engine;
+    engine.Run(options, output);
+
+    return 0;
+}
@@ -29,6 +29,7 @@ $CLANG_PATH -std=c++11 -stdlib=libc++ -DOSX -o PocketEngine.a \
 -I $POCKET_PATH/Data/ \
 -I $POCKET_PATH/Core/ \
 -I $POCKET_PATH/Platform/OSX \
+-I $POCKET_PATH/Threads/ \
 \
 $POCKET_PATH/Math/BoundingBox.cpp \
 $POCKET_PATH/Math/BoundingFrustum.cpp \
@@ -37,6 +38,7 @@ $POCKET_PATH/Math/Interpolator.cpp \
 $POCKET_PATH/Math/MathHelper.cpp \
 $POCKET_PATH/Math/Matrix3x3.cpp \
 $POCKET_PATH/Math/Matrix4x4.cpp \
+$POCKET_PATH/Math/OcclusionBuffer.cpp \
 $POCKET_PATH/Math/Plane.cpp \
 $POCKET_PATH/Math/Point.cpp \
 $POCKET_PATH/Math/Point3.cpp \
@@ -50,6 +52,7 @@ $POCKET_PATH/Math/Vector3.cpp \
 $POCKET_PATH/Data/BezierCurve1.cpp \
 $POCKET_PATH/Data/BezierCurve3.cpp \
 $POCKET_PATH/Data/Bitset.cpp \
+$POCKET_PATH/Data/DynamicTree.cpp \
 $POCKET_PATH/Data/ICellItem.cpp \
 $POCKET_PATH/Data/Octree.cpp \
 $POCKET_PATH/Data/Pointer.cpp \
@@ -65,6 +68,8 @@ $POCKET_PATH/Core/InputManager.cpp \
 $POCKET_PATH/Core/Timer.cpp \
 $POCKET_PATH/Core/Window.cpp \
 \
+$POCKET_PATH/Threads/JobSystem.cpp \
+\
 $POCKET_PATH/Platform/OSX/AppDelegate.mm \
 $POCKET_PATH/Platform/OSX/File.mm \
 $POCKET_PATH/Platform/OSX/FileReader.mm \
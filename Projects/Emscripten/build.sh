@@ -61,7 +61,10 @@ python $EMSCRIPTEN_PATH/emcc -O3 -s FULL_ES2=1 -s ASSERTIONS=1 -o PocketEngine.h
 -I $POCKET_PATH/Rendering/ \
 -I $POCKET_PATH/Serialization/ \
 -I $POCKET_PATH/Social/ \
+-I $POCKET_PATH/Threads/ \
 -I $POCKET_PATH/Web/ \
+$POCKET_PATH/ComponentSystem/Archetype.cpp \
+$POCKET_PATH/ComponentSystem/CommandBuffer.cpp \
 $POCKET_PATH/ComponentSystem/FileWorld.cpp \
 $POCKET_PATH/ComponentSystem/GameIDHelper.cpp \
 $POCKET_PATH/ComponentSystem/GameObject.cpp \
@@ -69,6 +72,7 @@ $POCKET_PATH/ComponentSystem/GameObjectHandle.cpp \
 $POCKET_PATH/ComponentSystem/GameScene.cpp \
 $POCKET_PATH/ComponentSystem/GameSystem.cpp \
 $POCKET_PATH/ComponentSystem/GameWorld.cpp \
+$POCKET_PATH/ComponentSystem/SystemScheduler.cpp \
 $POCKET_PATH/Core/Engine.cpp \
 $POCKET_PATH/Core/EngineContext.cpp \
 $POCKET_PATH/Core/GameState.cpp \
@@ -84,6 +88,7 @@ $POCKET_PATH/Data/FileHelper.cpp \
 $POCKET_PATH/Data/Guid.cpp \
 $POCKET_PATH/Data/ICellItem.cpp \
 $POCKET_PATH/Data/Octree.cpp \
+$POCKET_PATH/Data/DynamicTree.cpp \
 $POCKET_PATH/Data/Pointer.cpp \
 $POCKET_PATH/Data/QuadTree.cpp \
 $POCKET_PATH/Data/StringHelper.cpp \
@@ -185,6 +190,7 @@ $POCKET_PATH/Math/Interpolator.cpp \
 $POCKET_PATH/Math/MathHelper.cpp \
 $POCKET_PATH/Math/Matrix3x3.cpp \
 $POCKET_PATH/Math/Matrix4x4.cpp \
+$POCKET_PATH/Math/OcclusionBuffer.cpp \
 $POCKET_PATH/Math/Plane.cpp \
 $POCKET_PATH/Math/Point.cpp \
 $POCKET_PATH/Math/Point3.cpp \
@@ -204,14 +210,19 @@ $POCKET_PATH/Profiler/Profiler.cpp \
 $POCKET_PATH/Rendering/Clipper.cpp \
 $POCKET_PATH/Rendering/Colour.cpp \
 $POCKET_PATH/Rendering/ImageLoader.cpp \
+$POCKET_PATH/Rendering/RenderQueue.cpp \
 $POCKET_PATH/Rendering/Shader.cpp \
 $POCKET_PATH/Rendering/ShaderCollection.cpp \
 $POCKET_PATH/Rendering/Texture.cpp \
 $POCKET_PATH/Rendering/TextureAtlas.cpp \
+$POCKET_PATH/Rendering/TexturePage.cpp \
+$POCKET_PATH/Rendering/TriangleTree.cpp \
+$POCKET_PATH/Rendering/GpuTimer.cpp \
 $POCKET_PATH/Rendering/Vertex.cpp \
 $POCKET_PATH/Serialization/TypeIndexList.cpp \
 $POCKET_PATH/Social/FacebookClient.cpp \
 $POCKET_PATH/Social/FacebookUser.cpp \
+$POCKET_PATH/Threads/JobSystem.cpp \
 $POCKET_PATH/Web/FileDownloader.cpp \
 $POCKET_PATH/Web/HttpRequest.cpp \
 $POCKET_PATH/Libs/Zip/miniz.c \
@@ -0,0 +1,22 @@
+//
+//  main.cpp
+//  TestComponentSystem
+//
+//  Created by Jeppe Nielsen on 17/10/26.
+//  Copyright © 2026 Jeppe Nielsen. All rights reserved.
+//
+
+// Runs the logic tests headless against the null gl, exits with 1 when a test fails.
+
+#include "LogicTests.hpp"
+#include "TypeInfo.hpp"
+
+using namespace Pocket;
+
+// The editor callback lives in Logic/Editor, which the tests do not build.
+TypeEditorTitle::Callback TypeEditorTitle::Title = 0;
+
+int main(int argc, const char * argv[]) {
+    LogicTests tests;
+    return tests.Run() ? 0 : 1;
+}
@@ -11,14 +11,17 @@
 
 LogicTest::~LogicTest() {}
 
-void LogicTest::Run() {
+bool LogicTest::Run() {
     tests.clear();
     RunTests();
     
+    bool allSucceeded = true;
     for(auto& test : tests) {
         bool succes = test.method();
         std::cout<<test.name << " -> "<<((succes) ? "SUCCES!" : "FAILED!")<<std::endl;
+        allSucceeded &= succes;
     }
+    return allSucceeded;
 }
 
 void LogicTest::AddTest(const std::string &name, TestMethod test) {
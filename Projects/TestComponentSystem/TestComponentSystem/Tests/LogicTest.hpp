@@ -22,7 +22,7 @@ private:
     using Tests = std::vector<Test>;
     Tests tests;
 public:
-    void Run();
+    bool Run();
     virtual ~LogicTest();
 protected:
     void AddTest(const std::string& name, TestMethod test);
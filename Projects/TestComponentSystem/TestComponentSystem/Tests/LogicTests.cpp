@@ -9,9 +9,113 @@
 #include "LogicTests.hpp"
 #include <cstdlib>
 #include "GameSystem.hpp"
+#include "JobSystem.hpp"
+#include "RenderQueue.hpp"
+#include "Octree.hpp"
+#include "DynamicTree.hpp"
+#include "Quaternion.hpp"
+#include "OcclusionBuffer.hpp"
+#include "TriangleTree.hpp"
+#include "VertexMesh.hpp"
+#if defined(__linux__)
+#include "Engine.hpp"
+#include "GameWorld.hpp"
+#include "RenderSystem.hpp"
+#include "Clipper.hpp"
+#include "NullGL.hpp"
+#include "Shader.hpp"
+#include <cstring>
+#endif
+#include <algorithm>
+#include <cmath>
 
 using namespace Pocket;
 
+static float RandomFloat(float min, float max) {
+    return min + (max - min) * (std::rand() / (float)RAND_MAX);
+}
+
+static BoundingBox RandomBox(float range, float maxSize) {
+    Vector3 center(RandomFloat(-range, range), RandomFloat(-range, range), RandomFloat(-range, range));
+    return BoundingBox(center, Vector3(RandomFloat(0.1f, maxSize), RandomFloat(0.1f, maxSize), RandomFloat(0.1f, maxSize)));
+}
+
+static BoundingFrustum RandomFrustum() {
+    Matrix4x4 view = Matrix4x4::CreateTransform(Vector3(RandomFloat(-50, 50), RandomFloat(-50, 50), RandomFloat(-50, 50)), 1,
+                                                Quaternion(RandomFloat(0, 6.28f), Vector3(0, 1, 0))).Invert();
+    BoundingFrustum frustum;
+    frustum.SetFromViewProjection(Matrix4x4::CreatePerspective(RandomFloat(30, 90), 1.5f, 1, 120).Multiply(view));
+    return frustum;
+}
+
+// Compares frustum and ray queries of a spatial index with testing every inserted node.
+template<typename Index>
+static bool MatchesBruteForce(const Index& index, std::vector<SpatialNode>& nodes) {
+    for(int query=0; query<10; ++query) {
+        BoundingFrustum frustum = RandomFrustum();
+        std::vector<SpatialNode*> found;
+        index.template Get<SpatialNode*>(frustum, found);
+        std::vector<SpatialNode*> expected;
+        for(auto& node : nodes) {
+            if (node.IsInserted() && frustum.Intersect(node.box)!=BoundingFrustum::OUTSIDE) expected.push_back(&node);
+        }
+        std::sort(found.begin(), found.end());
+        if (found!=expected) return false;
+    }
+    Ray rays[Ray::MaxBatch];
+    std::vector<SpatialNode*> lists[Ray::MaxBatch];
+    for(int r=0; r<Ray::MaxBatch; ++r) {
+        rays[r] = Ray(Vector3(RandomFloat(-150, 150), RandomFloat(-150, 150), 200), Vector3(RandomFloat(-0.5f, 0.5f), RandomFloat(-0.5f, 0.5f), -1));
+    }
+    index.template Get<SpatialNode*>(rays, Ray::MaxBatch, lists);
+    for(int r=0; r<Ray::MaxBatch; ++r) {
+        std::vector<SpatialNode*> found;
+        index.template Get<SpatialNode*>(rays[r], found);
+        std::vector<SpatialNode*> expected;
+        for(auto& node : nodes) {
+            if (node.IsInserted() && rays[r].Intersect(node.box)) expected.push_back(&node);
+        }
+        std::sort(found.begin(), found.end());
+        std::sort(lists[r].begin(), lists[r].end());
+        if (found!=expected || lists[r]!=expected) return false;
+    }
+    return true;
+}
+
+// Inserts, moves and removes random boxes, part of them outside the bounds of an octree.
+template<typename Index>
+static bool SpatialIndexMatchesBruteForce(Index& index, std::vector<SpatialNode>& nodes) {
+    for(auto& node : nodes) {
+        node.box = RandomBox(150, 8);
+        node.data = &node;
+        index.Insert(node);
+    }
+    if (index.Size()!=nodes.size() || !MatchesBruteForce(index, nodes)) return false;
+    for(int i=0; i<1000; ++i) {
+        SpatialNode& node = nodes[std::rand() % nodes.size()];
+        if (!node.IsInserted()) continue;
+        // mostly small steps, which stay in their cell or fat box
+        if (i % 4 == 0) {
+            node.box = RandomBox(150, 8);
+        } else {
+            node.box.center += Vector3(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1));
+        }
+        index.Move(node);
+    }
+    if (!MatchesBruteForce(index, nodes)) return false;
+    size_t inserted = nodes.size();
+    for(size_t i=0; i<nodes.size(); i+=3) {
+        index.Remove(nodes[i]);
+        --inserted;
+    }
+    if (index.Size()!=inserted || !MatchesBruteForce(index, nodes)) return false;
+    for(size_t i=0; i<nodes.size(); i+=6) {
+        index.Insert(nodes[i]);
+        ++inserted;
+    }
+    return index.Size() == inserted && MatchesBruteForce(index, nodes);
+}
+
 
 void LogicTests::RunTests() {
     
@@ -886,4 +990,773 @@ void LogicTests::RunTests() {
     
 
 
+    AddTest("Archetype storage groups objects by components", [] () {
+        struct Transform { int position; };
+        struct Velocity { int speed; };
+        struct Sprite { };
+        
+        static int chunks;
+        static int objectsVisited;
+        static bool pointersMatch;
+        struct MoveSystem : public GameSystem<Transform, Velocity> {
+            void Update(float dt) override {
+                ForEachChunk([] (int count, GameObject* const* objects, Transform* const* transforms, Velocity* const* velocities) {
+                    chunks++;
+                    for(int i=0; i<count; ++i) {
+                        transforms[i]->position += velocities[i]->speed;
+                        pointersMatch &= objects[i]->GetComponent<Transform>() == transforms[i];
+                        objectsVisited++;
+                    }
+                });
+            }
+        };
+        
+        GameWorld world;
+        world.SetArchetypeStorage(true);
+        GameObject* root = world.CreateRoot();
+        root->CreateSystem<MoveSystem>();
+        
+        std::vector<GameObject*> objects;
+        for(int i=0; i<10; ++i) {
+            GameObject* object = root->CreateChild();
+            object->AddComponent<Transform>()->position = 0;
+            object->AddComponent<Velocity>()->speed = i;
+            if (i%2 == 0) {
+                object->AddComponent<Sprite>();
+            }
+            objects.push_back(object);
+        }
+        objects[3]->Remove();
+        
+        chunks = 0;
+        objectsVisited = 0;
+        pointersMatch = true;
+        world.Update(0);
+        
+        return chunks == 2 &&
+            objectsVisited == 9 &&
+            pointersMatch &&
+            objects[4]->GetComponent<Transform>()->position == 4;
+    });
+
+    AddTest("Archetypes of a system follow new component sets and rebuilds", [] () {
+        struct Transform { int position; };
+        struct Velocity { int speed; };
+        struct Sprite { };
+        struct Label { };
+
+        static int chunks;
+        static int objectsVisited;
+        struct MoveSystem : public GameSystem<Transform, Velocity> {
+            void Update(float dt) override {
+                ForEachChunk([] (int count, GameObject* const* objects, Transform* const* transforms, Velocity* const* velocities) {
+                    chunks++;
+                    objectsVisited += count;
+                });
+            }
+        };
+
+        GameWorld world;
+        world.SetArchetypeStorage(true);
+        GameObject* root = world.CreateRoot();
+        root->CreateSystem<MoveSystem>();
+
+        auto create = [root] (bool sprite) {
+            GameObject* object = root->CreateChild();
+            object->AddComponent<Transform>();
+            object->AddComponent<Velocity>();
+            if (sprite) {
+                object->AddComponent<Sprite>();
+            }
+            return object;
+        };
+        auto countChunks = [&world] () {
+            chunks = 0;
+            objectsVisited = 0;
+            world.Update(0);
+            return chunks;
+        };
+
+        create(false);
+        bool oneChunk = countChunks() == 1 && objectsVisited == 1;
+
+        create(true);
+        create(true);
+        bool newChunk = countChunks() == 2 && objectsVisited == 3;
+
+        // Label is a new component type, which resizes every bitset
+        GameObject* labeled = create(false);
+        labeled->AddComponent<Label>();
+        labeled->RemoveComponent<Label>();
+        world.Update(0);
+        bool resized = countChunks() == 2 && objectsVisited == 4;
+
+        world.SetArchetypeStorage(false);
+        world.SetArchetypeStorage(true);
+        bool rebuilt = countChunks() == 2 && objectsVisited == 4;
+
+        return oneChunk && newChunk && resized && rebuilt;
+    });
+
+    AddTest("GameSystem::ForEach iterates packed components", [] () {
+        struct Transform { int position; };
+        struct Velocity { int speed; };
+        
+        static int visited;
+        static bool orderMatches;
+        struct MoveSystem : public GameSystem<Transform, Velocity> {
+            void Update(float dt) override {
+                ForEach([] (Transform& transform, Velocity& velocity) {
+                    transform.position += velocity.speed;
+                    visited++;
+                });
+                int index = 0;
+                ForEachObject([&index, this] (GameObject* object, Transform& transform, Velocity& velocity) {
+                    orderMatches &= Objects()[index++] == object && object->GetComponent<Transform>() == &transform;
+                });
+            }
+        };
+        
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        root->CreateSystem<MoveSystem>();
+        
+        std::vector<GameObject*> objects;
+        for(int i=0; i<5; ++i) {
+            GameObject* object = root->CreateChild();
+            object->AddComponent<Transform>()->position = 0;
+            object->AddComponent<Velocity>()->speed = i;
+            objects.push_back(object);
+        }
+        world.Update(0);
+        objects[1]->RemoveComponent<Velocity>();
+        objects[3]->Remove();
+        
+        visited = 0;
+        orderMatches = true;
+        world.Update(0);
+        
+        return visited == 3 &&
+            orderMatches &&
+            objects[1]->GetComponent<Transform>()->position == 1 &&
+            objects[4]->GetComponent<Transform>()->position == 8;
+    });
+
+    AddTest("Systems with declared access keep conflict order", [] () {
+        struct Position { int value; };
+        struct Copy { int value; };
+        struct Counter { int value; };
+        
+        struct PositionSystem : public GameSystem<Write<Position>> {
+            void Update(float dt) override {
+                ForEach([] (Position& position) {
+                    position.value++;
+                });
+            }
+        };
+        struct CopySystem : public GameSystem<Read<Position>, Write<Copy>> {
+            void Update(float dt) override {
+                ForEach([] (const Position& position, Copy& copy) {
+                    copy.value = position.value;
+                });
+            }
+        };
+        struct CounterSystem : public GameSystem<Write<Counter>> {
+            void Update(float dt) override {
+                ForEach([] (Counter& counter) {
+                    counter.value++;
+                });
+            }
+        };
+        
+        JobSystem jobs(2);
+        GameWorld world;
+        world.SetJobSystem(&jobs);
+        GameObject* root = world.CreateRoot();
+        root->CreateSystem<PositionSystem>();
+        root->CreateSystem<CopySystem>();
+        root->CreateSystem<CounterSystem>();
+        
+        std::vector<GameObject*> objects;
+        for(int i=0; i<100; ++i) {
+            GameObject* object = root->CreateChild();
+            object->AddComponent<Position>()->value = i;
+            object->AddComponent<Copy>()->value = 0;
+            object->AddComponent<Counter>()->value = 0;
+            objects.push_back(object);
+        }
+        
+        for(int i=0; i<10; ++i) {
+            world.Update(0);
+        }
+        
+        bool allCopied = true;
+        for(int i=0; i<objects.size(); ++i) {
+            allCopied &= objects[i]->GetComponent<Copy>()->value == i + 10;
+            allCopied &= objects[i]->GetComponent<Counter>()->value == 10;
+        }
+        return allCopied;
+    });
+
+    
+    AddTest("JobSystem::ParallelFor visits every index once", [] {
+        JobSystem jobs(3);
+        std::vector<int> visits(1000, 0);
+        jobs.ParallelFor((int)visits.size(), 16, [&visits] (int begin, int end) {
+            for(int i=begin; i<end; ++i) {
+                visits[i]++;
+            }
+        });
+        for(auto count : visits) {
+            if (count!=1) return false;
+        }
+        return true;
+    });
+    
+    AddTest("JobSystem continuation runs on Update", [] {
+        JobSystem jobs(2);
+        int result = 0;
+        bool finished = false;
+        JobHandle handle = jobs.Schedule([&result] () {
+            result = 42;
+        }, [&finished, &result] () {
+            finished = result == 42;
+        });
+        jobs.Wait(handle);
+        if (finished) return false;
+        jobs.Update();
+        return finished;
+    });
+    
+    AddTest("JobSystem::Wait does not run background jobs", [] {
+        JobSystem jobs(1);
+        std::atomic<bool> released(false);
+        std::thread::id backgroundThread;
+        JobHandle background = jobs.ScheduleBackground([&released, &backgroundThread] () {
+            backgroundThread = std::this_thread::get_id();
+            while (!released) {
+                std::this_thread::yield();
+            }
+        });
+        std::vector<int> visits(100, 0);
+        jobs.ParallelFor((int)visits.size(), 1, [&visits] (int begin, int end) {
+            visits[begin]++;
+        });
+        bool frameDone = !background.IsDone();
+        released = true;
+        jobs.Wait(background);
+        for(auto count : visits) {
+            if (count!=1) return false;
+        }
+        return frameDone && backgroundThread != std::this_thread::get_id();
+    });
+
+    
+    AddTest("Bitset::Contains across words", [] {
+        Bitset system;
+        system.Resize(70);
+        system.Set(3, true);
+        system.Set(67, true);
+        Bitset object;
+        object.Resize(300);
+        object.Set(3, true);
+        if (system.Contains(object)) return false;
+        object.Set(67, true);
+        object.Set(299, true);
+        if (!system.Contains(object)) return false;
+        if (object.Contains(system)) return false;
+        Bitset copy = object;
+        copy.Resize(68);
+        return copy[67] && copy.Contains(system) && system.Contains(copy);
+    });
+
+    
+    AddTest("GameSystem metadata follows swap and pop removal", [] {
+        struct Position { int value; };
+        struct PositionSystem : public GameSystem<Position> {
+            void ObjectAdded(GameObject* object) override {
+                SetMetaData(object, object->GetComponent<Position>());
+            }
+            bool IsValid() {
+                for(auto object : Objects()) {
+                    if (GetMetaData(object)!=object->GetComponent<Position>()) return false;
+                }
+                return true;
+            }
+            bool HasMetaData(GameObject* object) {
+                return GetMetaData(object)!=0;
+            }
+        };
+        
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        PositionSystem* system = root->CreateSystem<PositionSystem>();
+        std::vector<GameObject*> objects;
+        for(int i=0; i<20; ++i) {
+            GameObject* object = root->CreateChild();
+            object->AddComponent<Position>()->value = i;
+            objects.push_back(object);
+        }
+        world.Update(0);
+        for(int i=0; i<20; i+=3) {
+            objects[i]->RemoveComponent<Position>();
+        }
+        world.Update(0);
+        if (system->ObjectCount()!=13 || !system->IsValid()) return false;
+        for(int i=0; i<20; i+=3) {
+            if (system->HasMetaData(objects[i])) return false;
+        }
+        for(int i=1; i<20; i+=3) {
+            objects[i]->Remove();
+        }
+        world.Update(0);
+        return system->ObjectCount() == 6 && system->IsValid();
+    });
+
+    
+    AddTest("Batched removal of parents and children", [] {
+        struct Position { int value; };
+        struct PositionSystem : public GameSystem<Position> {
+            int removed = 0;
+            void ObjectRemoved(GameObject* object) override {
+                removed++;
+            }
+        };
+        
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        PositionSystem* system = root->CreateSystem<PositionSystem>();
+        std::vector<GameObject*> parents;
+        for(int i=0; i<10; ++i) {
+            GameObject* parent = root->CreateChild();
+            parent->AddComponent<Position>();
+            for(int j=0; j<5; ++j) {
+                parent->CreateChild()->AddComponent<Position>();
+            }
+            parents.push_back(parent);
+        }
+        world.Update(0);
+        if (system->ObjectCount()!=60) return false;
+        for(auto parent : parents) {
+            parent->Remove();
+        }
+        world.Update(0);
+        return system->ObjectCount() == 0 &&
+               system->removed == 60 &&
+               world.ObjectCount() == 1 &&
+               root->Children().empty();
+    });
+    
+    AddTest("ReplaceComponent through command buffer", [] {
+        struct Position { int value; };
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        GameObject* source = root->CreateChild();
+        source->AddComponent<Position>()->value = 5;
+        GameObject* object = root->CreateChild();
+        object->AddComponent<Position>()->value = 1;
+        world.Update(0);
+        object->ReplaceComponent<Position>(source);
+        world.Update(0);
+        return object->GetComponent<Position>() == source->GetComponent<Position>();
+    });
+
+    
+    AddTest("Event unbind by token, also while invoked", [] {
+        Event<int> event;
+        int sum = 0;
+        EventToken first = event.Bind([&sum] (int value) { sum += value; });
+        EventToken self;
+        self = event.Bind([&event, &self, &sum] (int value) {
+            sum += value * 10;
+            event.Unbind(self);
+        });
+        event.Bind([&sum] (int value) { sum += value * 100; });
+        event(1);
+        if (sum!=111) return false;
+        event(1);
+        if (sum!=212) return false;
+        event.Unbind(first);
+        event(1);
+        return sum == 312;
+    });
+
+    AddTest("RenderQueue sorts by key and keeps equal keys in order", [] {
+        // below 64 items std::stable_sort is used, above the radix sort
+        for(int count : { 40, 5000 }) {
+            RenderQueue queue;
+            std::vector<RenderQueue::Item> expected;
+            for(int i=0; i<count; ++i) {
+                // few distinct keys, spread over the low and high bytes
+                uint64_t key = ((uint64_t)(std::rand() % 4) << 60) | ((uint64_t)(std::rand() % 3) << 21) | (uint64_t)(std::rand() % 5);
+                queue.Add(key, (uint32_t)i);
+                expected.push_back({ key, (uint32_t)i });
+            }
+            std::stable_sort(expected.begin(), expected.end(), [] (const RenderQueue::Item& a, const RenderQueue::Item& b) {
+                return a.key<b.key;
+            });
+            queue.Sort();
+            const RenderQueue::Items& sorted = queue.Sorted();
+            if (sorted.size()!=expected.size()) return false;
+            for(size_t i=0; i<sorted.size(); ++i) {
+                if (sorted[i].key!=expected[i].key || sorted[i].index!=expected[i].index) return false;
+            }
+        }
+        return true;
+    });
+    
+    AddTest("RenderQueue keys order by layer before state and depth", [] {
+        // order wins over everything else
+        if (!(RenderQueue::OpaqueKey(0, 3, 900, 4000, true, 1.0f)<RenderQueue::OpaqueKey(1, 0, 0, 0, false, -1.0f))) return false;
+        if (!(RenderQueue::OpaqueKey(-1, 0, 0, 0, false, 0)<RenderQueue::OpaqueKey(0, 0, 0, 0, false, 0))) return false;
+        // opaque groups by shader before depth, front to back by depth before shader
+        if (!(RenderQueue::OpaqueKey(0, 0, 1, 0, false, 0.9f)<RenderQueue::OpaqueKey(0, 0, 2, 0, false, -0.9f))) return false;
+        if (!(RenderQueue::FrontToBackKey(0, 0, 2, 0, false, -0.9f)<RenderQueue::FrontToBackKey(0, 0, 1, 0, false, 0.9f))) return false;
+        // transparent objects go back to front
+        return RenderQueue::TransparentKey(0, 0.9f)<RenderQueue::TransparentKey(0, -0.9f);
+    });
+
+    AddTest("Octree queries match brute force after insert, move, remove and rebuild", [] {
+        Octree octree(BoundingBox(0, 200));
+        std::vector<SpatialNode> nodes(2000);
+        if (!SpatialIndexMatchesBruteForce(octree, nodes)) return false;
+        octree.Rebuild();
+        if (!MatchesBruteForce(octree, nodes)) return false;
+        size_t size = octree.Size();
+        octree.SetBoundingBox(BoundingBox(Vector3(50, 0, 0), 120));
+        return octree.Size() == size && MatchesBruteForce(octree, nodes);
+    });
+
+    AddTest("DynamicTree queries match brute force after insert, move and remove", [] {
+        DynamicTree tree;
+        std::vector<SpatialNode> nodes(2000);
+        if (!SpatialIndexMatchesBruteForce(tree, nodes)) return false;
+        // balanced within 1.44 log2 of the object count
+        return tree.Height()<=(int)(1.44f * std::log2((float)tree.Size())) + 1;
+    });
+
+    AddTest("BoundingFrustum batch tests of packed boxes match single box tests", [] {
+        PackedBoxes boxes;
+        boxes.Resize(1001);
+        for(size_t i=0; i<boxes.Size(); ++i) {
+            boxes.Set(i, RandomBox(80, 20));
+        }
+        std::vector<BoundingFrustum::Intersection> results(boxes.Size());
+        std::vector<unsigned char> lastPlanes(boxes.Size(), 0);
+        for(int query=0; query<20; ++query) {
+            BoundingFrustum frustum = RandomFrustum();
+            // partial masks, as left by a parent cell, and offsets not a multiple of the simd width
+            int planeMask = query % 2 ? BoundingFrustum::AllPlanes : (std::rand() & BoundingFrustum::AllPlanes);
+            size_t first = query % 5;
+            size_t count = boxes.Size() - first - query % 3;
+            // twice, the second time with the rejecting planes of the first
+            for(int pass=0; pass<2; ++pass) {
+                frustum.Intersect(boxes, first, count, planeMask, &results[first], query % 4 ? &lastPlanes[first] : 0);
+                for(size_t i=first; i<first + count; ++i) {
+                    int mask = planeMask;
+                    BoundingFrustum::Intersection expected = frustum.Intersect(boxes.Get(i), mask);
+                    if (expected == results[i]) continue;
+                    // the remembered plane can be one left out of the mask, the box is then still outside the frustum
+                    if (results[i]!=BoundingFrustum::OUTSIDE || frustum.Intersect(boxes.Get(i))!=BoundingFrustum::OUTSIDE) return false;
+                }
+            }
+            Ray ray(Vector3(RandomFloat(-80, 80), RandomFloat(-80, 80), 100), Vector3(RandomFloat(-0.5f, 0.5f), RandomFloat(-0.5f, 0.5f), -1));
+            for(size_t i=0; i<boxes.Size(); ++i) {
+                if (ray.Intersect(boxes, i)!=ray.Intersect(boxes.Get(i))) return false;
+            }
+        }
+        return true;
+    });
+
+    AddTest("OcclusionBuffer only hides boxes which are behind the occluder", [] {
+        // camera at z 50 looking down -z at a 40 x 40 wall in the z 0 plane
+        const Vector3 camera(0, 0, 50);
+        const Matrix4x4 viewProjection = Matrix4x4::CreatePerspective(60, 1, 1, 200).Multiply(Matrix4x4::CreateTranslation(-camera));
+        const Vector3 wall[] = { Vector3(-20, -20, 0), Vector3(20, -20, 0), Vector3(20, 20, 0), Vector3(-20, 20, 0) };
+        const short indices[] = { 0, 1, 2, 0, 2, 3 };
+        OcclusionBuffer occlusion;
+        occlusion.Begin(128, 128, viewProjection);
+        occlusion.AddTriangles(Matrix4x4::IDENTITY, wall, 4, indices, 6);
+        for(int tile=0; tile<occlusion.TileCount(); ++tile) {
+            occlusion.RasterizeTile(tile);
+        }
+        // the box is hidden when the line of sight to every corner passes through the wall
+        auto isHidden = [&camera] (const BoundingBox& box) {
+            for(int corner=0; corner<8; ++corner) {
+                Vector3 position = box.center + Vector3(corner & 1 ? 0.5f : -0.5f, corner & 2 ? 0.5f : -0.5f, corner & 4 ? 0.5f : -0.5f) * box.extends;
+                if (position.z>=0) return false;
+                float t = camera.z / (camera.z - position.z);
+                Vector3 atWall = camera + (position - camera) * t;
+                if (atWall.x<-20 || atWall.x>20 || atWall.y<-20 || atWall.y>20) return false;
+            }
+            return true;
+        };
+        int occluded = 0;
+        for(int i=0; i<5000; ++i) {
+            BoundingBox box(Vector3(RandomFloat(-40, 40), RandomFloat(-40, 40), RandomFloat(-120, 40)),
+                            Vector3(RandomFloat(0.1f, 10), RandomFloat(0.1f, 10), RandomFloat(0.1f, 10)));
+            if (!occlusion.IsOccluded(box)) continue;
+            if (!isHidden(box)) return false;
+            occluded++;
+        }
+        // a box well behind the middle of the wall is culled
+        return occluded>0 && occlusion.IsOccluded(BoundingBox(Vector3(0, 0, -30), 5));
+    });
+
+    AddTest("TriangleTree hits match VertexMesh::IntersectsRay", [] {
+        VertexMesh<Vertex> mesh;
+        mesh.AddGeoSphere(0, 10, 12);
+        for(int i=0; i<20; ++i) {
+            mesh.AddCube(Vector3(RandomFloat(-15, 15), RandomFloat(-15, 15), RandomFloat(-15, 15)), RandomFloat(0.5f, 4));
+        }
+        TriangleTree tree;
+        tree.Build(mesh);
+        if (tree.Triangles()!=mesh.triangles.size() / 3) return false;
+        int hits = 0;
+        for(int i=0; i<2000; ++i) {
+            Vector3 position(RandomFloat(-30, 30), RandomFloat(-30, 30), RandomFloat(-30, 30));
+            // half the rays start inside the mesh bounds
+            if (i % 2) position *= 0.3f;
+            Ray ray(position, Vector3(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1)));
+            float distance = 0, u = 0, v = 0;
+            size_t triangleIndex = 0;
+            bool expected = mesh.IntersectsRay(ray, &distance, &u, &v, &triangleIndex, 0);
+            TriangleHit hit;
+            if (tree.IntersectsRay(ray, hit)!=expected) return false;
+            if (!expected) continue;
+            // hits are along the whole line, so distances can be negative
+            if (hit.triangleIndex!=triangleIndex || std::fabs(hit.distance - distance)>0.0001f * (1 + std::fabs(distance)) ||
+                std::fabs(hit.u - u)>0.0001f || std::fabs(hit.v - v)>0.0001f) return false;
+            hits++;
+        }
+        return hits>500;
+    });
+
+
+#if defined(__linux__)
+    // Rendering tests need the null gl of the linux platform, there is no gl context otherwise.
+    // Projects/TestComponentSystem/build.sh builds them on linux.
+    AddTest("RenderSystem rebuilds cached visible sets only when the scene or camera changes", [] {
+        Engine engine;
+        GameWorld world;
+        GameObject* root = world.CreateRoot();
+        RenderSystem* renderSystem = root->CreateSystem<RenderSystem>();
+        GameObject* camera = root->CreateObject();
+        camera->AddComponent<Transform>()->Position = Vector3(0, 0, 50);
+        camera->AddComponent<Camera>();
+        std::vector<GameObject*> cubes;
+        for(int i=0; i<20; ++i) {
+            GameObject* cube = root->CreateObject();
+            cube->AddComponent<Transform>()->Position = Vector3((i % 5) * 3.0f - 6, (i / 5) * 3.0f - 6, 0);
+            cube->AddComponent<Mesh>()->GetMesh<Vertex>().AddCube(0, 0.5f);
+            cube->AddComponent<Renderable>()->Static = (i % 2) == 0;
+            cubes.push_back(cube);
+        }
+        size_t indices = 0;
+        auto render = [&] (bool rebuilt, int visible) {
+            world.Update(0);
+            NullGL::Reset();
+            world.Render();
+            indices = NullGL::GetCounters().indicesDrawn;
+            const RenderSystem::CameraStats* stats = renderSystem->GetCameraStats(camera);
+            return stats && stats->rebuilt == rebuilt && stats->visible == visible;
+        };
+        
+        if (!render(true, 20)) return false;
+        size_t allIndices = indices;
+        // nothing changed, the cached set draws the same
+        if (!render(false, 20) || indices != allIndices) return false;
+        
+        cubes[0]->GetComponent<Transform>()->Position = Vector3(0, 0, 500);
+        if (!render(true, 19) || indices >= allIndices) return false;
+        if (!render(false, 19)) return false;
+        
+        cubes[1]->GetComponent<Renderable>()->BlendMode = BlendModeType::Alpha;
+        if (!render(true, 19)) return false;
+        if (renderSystem->GetCameraStats(camera)->passes[RenderSystem::CameraStats::Transparent].objectsRendered != 1) return false;
+        
+        // clipping decides whether the depth pre-pass can be used
+        cubes[1]->GetComponent<Renderable>()->Clip = 1;
+        if (!render(true, 19)) return false;
+        cubes[1]->GetComponent<Renderable>()->Clip = 0;
+        if (!render(true, 19)) return false;
+        
+        cubes[2]->RemoveComponent<Renderable>();
+        if (!render(true, 18)) return false;
+        cubes[2]->AddComponent<Renderable>();
+        if (!render(true, 19)) return false;
+        
+        // every cube is behind the camera
+        camera->GetComponent<Transform>()->Position = Vector3(0, 0, -50);
+        if (!render(true, 0) || indices != 0) return false;
+        camera->GetComponent<Transform>()->Position = Vector3(0, 0, 50);
+        if (!render(true, 19)) return false;
+        
+        renderSystem->InvalidateVisibility();
+        return render(true, 19) && render(false, 19);
+    });
+    
+    AddTest("Clipper uses scissor for axis aligned regions and stencil otherwise", [] {
+        NullGL::Reset();
+        Clipper clipper;
+        // clip space maps straight to a 100 x 100 viewport
+        clipper.SetView(Matrix4x4::IDENTITY, Rect(0, 0, 100, 100));
+        const Matrix4x4 world = Matrix4x4::IDENTITY;
+        auto check = [&] (const Vector3& center, float size) {
+            return clipper.Check(world, BoundingBox(center, Vector3(size, size, size)));
+        };
+        
+        // pixels 25 to 75, nothing is drawn for the region
+        if (!clipper.PushRect(world, Vector3(-0.5f, -0.5f, 0), Vector3(0.5f, 0.5f, 0))) return false;
+        if (!clipper.NeedsCheck() || NullGL::GetCounters().calls != 0) return false;
+        if (check(0, 0.2f) != Clipper::Visibility::Visible) return false;
+        if (check(Vector3(0.9f, 0.9f, 0), 0.1f) != Clipper::Visibility::Outside) return false;
+        if (check(Vector3(0.5f, 0, 0), 0.2f) != Clipper::Visibility::NeedsScissor) return false;
+        clipper.ApplyScissor();
+        if (NullGL::CallCount("glScissor") != 1 || NullGL::CallCount("glEnable") != 1) return false;
+        // the applied scissor already clips objects crossing the edge
+        if (check(Vector3(0.5f, 0, 0), 0.2f) != Clipper::Visibility::Visible) return false;
+        
+        // nested region is intersected with its parent, pixels 50 to 75
+        if (!clipper.PushRect(world, Vector3(0, 0, 0), Vector3(1, 1, 0))) return false;
+        // inside the stale parent scissor, which clips it the same
+        if (check(Vector3(0.25f, 0.25f, 0), 0.1f) != Clipper::Visibility::Visible) return false;
+        if (check(Vector3(0, 0.25f, 0), 0.2f) != Clipper::Visibility::NeedsScissor) return false;
+        clipper.ApplyScissor();
+        if (NullGL::CallCount("glScissor") != 2) return false;
+        clipper.PopRect();
+        if (check(0, 0.2f) != Clipper::Visibility::NeedsScissor) return false;
+        clipper.ApplyScissor();
+        clipper.PopRect();
+        if (!clipper.Empty() || !clipper.NeedsCheck()) return false;
+        // unclipped objects crossing the stale scissor turn it off
+        if (check(0, 0.2f) != Clipper::Visibility::Visible) return false;
+        if (check(Vector3(0.5f, 0, 0), 0.2f) != Clipper::Visibility::NeedsScissor) return false;
+        clipper.ApplyScissor();
+        if (NullGL::CallCount("glDisable") != 1 || clipper.NeedsCheck()) return false;
+        if (NullGL::CallCount("glStencilFunc") != 0 || NullGL::CallCount("glClear") != 0) return false;
+        
+        // rotated regions need the stencil
+        const Matrix4x4 rotated = Matrix4x4::CreateTransform(0, 1, Quaternion(0.5f, Vector3(0, 0, 1)));
+        if (clipper.PushRect(rotated, Vector3(-0.5f, -0.5f, 0), Vector3(0.5f, 0.5f, 0)) || !clipper.Empty()) return false;
+        
+        // nested stencil regions only clear the stencil for the outermost push
+        NullGL::Reset();
+        clipper.PushBegin();
+        clipper.PushEnd();
+        clipper.PushBegin();
+        clipper.PushEnd();
+        if (NullGL::CallCount("glClear") != 1 || NullGL::CallCount("glEnable") != 1) return false;
+        if (clipper.TopIsRect() || NullGL::CallCount("glScissor") != 0) return false;
+        clipper.PopBegin();
+        clipper.PopEnd();
+        if (NullGL::CallCount("glDisable") != 0) return false;
+        clipper.PopBegin();
+        clipper.PopEnd();
+        if (NullGL::CallCount("glDisable") != 1 || !clipper.Empty()) return false;
+        
+        // reset turns off tests left on by unbalanced pushes
+        NullGL::Reset();
+        clipper.PushBegin();
+        clipper.PushEnd();
+        clipper.Reset();
+        return NullGL::CallCount("glDisable") == 1 && clipper.Empty();
+    });
+    
+    AddTest("Shader<Vertex>::TransformVertices matches the scalar transform for every batch tail", [] {
+        Shader<Vertex> shader;
+        const Matrix4x4 world = Matrix4x4::CreateTransform(Vector3(3, -7, 11), Vector3(2, 0.5f, 1.5f),
+                                                           Quaternion(0.7f, Vector3(1, 2, 3).Normalized()));
+        auto close = [] (const Vector3& a, const Vector3& b) {
+            const Vector3 d = a - b;
+            const float tolerance = 1e-4f * (1.0f + b.Length());
+            return std::abs(d.x)<=tolerance && std::abs(d.y)<=tolerance && std::abs(d.z)<=tolerance;
+        };
+        for(int count = 0; count<40; ++count) {
+            VertexMesh<Vertex>::Vertices source(count);
+            for(auto& vertex : source) {
+                vertex.Position = Vector3(RandomFloat(-100, 100), RandomFloat(-100, 100), RandomFloat(-100, 100));
+                vertex.TextureCoords = Vector2(RandomFloat(0, 1), RandomFloat(0, 1));
+                vertex.Color = Colour((Colour::Component)(std::rand() % 256), (Colour::Component)(std::rand() % 256),
+                                      (Colour::Component)(std::rand() % 256), (Colour::Component)(std::rand() % 256));
+                vertex.Normal = Vector3(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1));
+            }
+            // one vertex past the destination must not be written
+            std::vector<Vertex> dest(count + 1);
+            std::memset(&dest[0], 0xcd, dest.size() * sizeof(Vertex));
+            Vertex sentinel = dest[count];
+            shader.TransformVertices(source, world, &dest[0]);
+            if (std::memcmp(&dest[count], &sentinel, sizeof(Vertex)) != 0) return false;
+            for(int i=0; i<count; ++i) {
+                if (!close(dest[i].Position, world.TransformPositionAffine(source[i].Position))) return false;
+                if (!close(dest[i].Normal, world.TransformVectorAffine(source[i].Normal))) return false;
+                if (std::memcmp(&dest[i].TextureCoords, &source[i].TextureCoords, sizeof(Vector2)) != 0) return false;
+                if (std::memcmp(&dest[i].Color, &source[i].Color, sizeof(Colour)) != 0) return false;
+            }
+        }
+        return true;
+    });
+    
+    AddTest("Concurrent Transform and Mesh writers move objects in a shared octree", [] {
+        struct Moved { };
+        struct Resized { };
+        struct MoveSystem : public GameSystem<Write<Transform>> {
+            void Update(float dt) override {
+                ForEachObject([] (GameObject* object, Transform& transform) {
+                    transform.Position = transform.Position() + Vector3(1, 0, 0);
+                    object->AddComponent<Moved>();
+                });
+            }
+        };
+        struct ResizeSystem : public GameSystem<Write<Mesh>> {
+            void Update(float dt) override {
+                ForEachObject([] (GameObject* object, Mesh& mesh) {
+                    mesh.GetMesh<Vertex>().vertices[0].Position.y -= 0.01f;
+                    object->AddComponent<Resized>();
+                });
+            }
+        };
+        struct MarkedSystem : public GameSystem<Moved, Resized> { };
+        using Octree = OctreeSystem<>;
+        
+        JobSystem jobs(4);
+        GameWorld world;
+        world.SetJobSystem(&jobs);
+        GameObject* root = world.CreateRoot();
+        Octree* octree = root->CreateSystem<Octree>();
+        root->CreateSystem<MoveSystem>();
+        root->CreateSystem<ResizeSystem>();
+        MarkedSystem* marked = root->CreateSystem<MarkedSystem>();
+        
+        std::vector<GameObject*> objects;
+        for(int i=0; i<2000; ++i) {
+            GameObject* object = root->CreateChild();
+            object->AddComponent<Transform>()->Position = Vector3(RandomFloat(-100, 100), RandomFloat(-100, 100), RandomFloat(-100, 100));
+            object->AddComponent<Mesh>()->GetMesh<Vertex>().AddCube(0, 0.5f);
+            objects.push_back(object);
+        }
+        world.Update(0);
+        octree->UpdateAllNodes();
+        
+        for(int frame=0; frame<10; ++frame) {
+            unsigned version = octree->Version();
+            world.Update(0);
+            // both writes dirty the same node, it is queued once
+            std::vector<void*> queued(octree->octreeObjectsUpdateList.begin(), octree->octreeObjectsUpdateList.end());
+            std::sort(queued.begin(), queued.end());
+            if (std::unique(queued.begin(), queued.end()) != queued.end()) return false;
+            if ((int)queued.size() != (int)objects.size() || octree->Version() == version) return false;
+            
+            ObjectCollection hits;
+            for(auto object : objects) {
+                const Vector3& position = object->GetComponent<Transform>()->Position;
+                hits.clear();
+                octree->GetObjectsAtRay(Ray(position + Vector3(0, 0, 200), Vector3(0, 0, -1)), hits);
+                if (std::find(hits.begin(), hits.end(), object) == hits.end()) return false;
+            }
+        }
+        // markers added by both systems are applied after the concurrent update
+        return marked->ObjectCount() == (int)objects.size();
+    });
+#endif
 }
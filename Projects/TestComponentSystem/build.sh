@@ -0,0 +1,108 @@
+#!/bin/sh
+
+#  Pocket Engine logic tests, command line build for Linux against the null gl
+#
+#  Copyright (c) 2026 Jeppe Nielsen. All rights reserved.
+#
+#  usage: ./build.sh && ./PocketLogicTests
+
+POCKET_PATH="../../Pocket"
+
+gcc -O2 -c $POCKET_PATH/Libs/Zip/miniz.c -o miniz.o
+
+g++ -O2 -std=c++14 -o PocketLogicTests \
+\
+-I $POCKET_PATH/ComponentSystem/ \
+-I $POCKET_PATH/ComponentSystem/Meta/ \
+-I $POCKET_PATH/Core/ \
+-I $POCKET_PATH/Data/ \
+-I $POCKET_PATH/Libs/STBImage/ \
+-I $POCKET_PATH/Libs/Zip/ \
+-I $POCKET_PATH/Logic/Common/ \
+-I $POCKET_PATH/Logic/Rendering/ \
+-I $POCKET_PATH/Logic/Spatial/ \
+-I $POCKET_PATH/Math/ \
+-I $POCKET_PATH/OpenGL/ \
+-I $POCKET_PATH/Platform/Linux/ \
+-I $POCKET_PATH/Rendering/ \
+-I $POCKET_PATH/Serialization/ \
+-I $POCKET_PATH/Threads/ \
+-I TestComponentSystem/Tests/ \
+\
+$POCKET_PATH/ComponentSystem/Archetype.cpp \
+$POCKET_PATH/ComponentSystem/CommandBuffer.cpp \
+$POCKET_PATH/ComponentSystem/GameIDHelper.cpp \
+$POCKET_PATH/ComponentSystem/GameObject.cpp \
+$POCKET_PATH/ComponentSystem/GameObjectHandle.cpp \
+$POCKET_PATH/ComponentSystem/GameScene.cpp \
+$POCKET_PATH/ComponentSystem/GameSystem.cpp \
+$POCKET_PATH/ComponentSystem/GameWorld.cpp \
+$POCKET_PATH/ComponentSystem/SystemScheduler.cpp \
+\
+$POCKET_PATH/Core/Engine.cpp \
+$POCKET_PATH/Core/EngineContext.cpp \
+$POCKET_PATH/Core/GameState.cpp \
+$POCKET_PATH/Core/InputDevice.cpp \
+$POCKET_PATH/Core/InputManager.cpp \
+$POCKET_PATH/Core/Timer.cpp \
+$POCKET_PATH/Core/Window.cpp \
+\
+$POCKET_PATH/Data/Bitset.cpp \
+$POCKET_PATH/Data/FileArchive.cpp \
+$POCKET_PATH/Data/FileHelper.cpp \
+$POCKET_PATH/Data/Guid.cpp \
+$POCKET_PATH/Data/Octree.cpp \
+$POCKET_PATH/Data/DynamicTree.cpp \
+$POCKET_PATH/Data/StringHelper.cpp \
+\
+$POCKET_PATH/Logic/Rendering/Camera.cpp \
+$POCKET_PATH/Logic/Rendering/RenderSystem.cpp \
+$POCKET_PATH/Logic/Rendering/ShaderComponent.cpp \
+$POCKET_PATH/Logic/Rendering/TextureComponent.cpp \
+\
+$POCKET_PATH/Logic/Spatial/Transform.cpp \
+\
+$POCKET_PATH/Math/BoundingBox.cpp \
+$POCKET_PATH/Math/BoundingFrustum.cpp \
+$POCKET_PATH/Math/Box.cpp \
+$POCKET_PATH/Math/MathHelper.cpp \
+$POCKET_PATH/Math/Matrix3x3.cpp \
+$POCKET_PATH/Math/Matrix4x4.cpp \
+$POCKET_PATH/Math/OcclusionBuffer.cpp \
+$POCKET_PATH/Math/Plane.cpp \
+$POCKET_PATH/Math/Quaternion.cpp \
+$POCKET_PATH/Math/Ray.cpp \
+$POCKET_PATH/Math/Rect.cpp \
+$POCKET_PATH/Math/Vector2.cpp \
+$POCKET_PATH/Math/Vector3.cpp \
+\
+$POCKET_PATH/Platform/Linux/AppMenu.cpp \
+$POCKET_PATH/Platform/Linux/File.cpp \
+$POCKET_PATH/Platform/Linux/FileReader.cpp \
+$POCKET_PATH/Platform/Linux/GamePadManager.cpp \
+$POCKET_PATH/Platform/Linux/NullGL.cpp \
+$POCKET_PATH/Platform/Linux/WindowLinux.cpp \
+\
+$POCKET_PATH/Rendering/Clipper.cpp \
+$POCKET_PATH/Rendering/Colour.cpp \
+$POCKET_PATH/Rendering/ImageLoader.cpp \
+$POCKET_PATH/Rendering/RenderQueue.cpp \
+$POCKET_PATH/Rendering/Shader.cpp \
+$POCKET_PATH/Rendering/ShaderCollection.cpp \
+$POCKET_PATH/Rendering/Texture.cpp \
+$POCKET_PATH/Rendering/TexturePage.cpp \
+$POCKET_PATH/Rendering/TriangleTree.cpp \
+$POCKET_PATH/Rendering/GpuTimer.cpp \
+$POCKET_PATH/Rendering/Vertex.cpp \
+\
+$POCKET_PATH/Serialization/TypeIndexList.cpp \
+\
+$POCKET_PATH/Threads/JobSystem.cpp \
+\
+TestComponentSystem/Linux/main.cpp \
+TestComponentSystem/Tests/LogicTest.cpp \
+TestComponentSystem/Tests/LogicTests.cpp \
+\
+miniz.o \
+\
+-lpthread